@@ -4,8 +4,8 @@
 #include "private/infomanager.h"
 #include "private/macros.h"
 
-#define APLUGINSDK_API_VERSION_MAJOR 4
-#define APLUGINSDK_API_VERSION_MINOR 0
+#define APLUGINSDK_API_VERSION_MAJOR 5
+#define APLUGINSDK_API_VERSION_MINOR 2
 #define APLUGINSDK_API_VERSION_PATCH 0
 
 PRIVATE_APLUGINLIBRARY_OPEN_NAMESPACE
@@ -37,9 +37,15 @@ PRIVATE_APLUGINSDK_CLOSE_API_NAMESPACE
 #define A_PLUGIN_RECORD_FEATURE(featureGroup, featureName) \
     PRIVATE_APLUGINSDK_RECORD_FEATURE(featureGroup, featureName)
 
+#define A_PLUGIN_REGISTER_FEATURE_VARIANT(instructionSet, returnType, featureGroup, featureName, ...) \
+    PRIVATE_APLUGINSDK_REGISTER_FEATURE_VARIANT(instructionSet, returnType, featureGroup, featureName, __VA_ARGS__)
+#define A_PLUGIN_RECORD_FEATURE_VARIANT(instructionSet, featureGroup, featureName) \
+    PRIVATE_APLUGINSDK_RECORD_FEATURE_VARIANT(instructionSet, featureGroup, featureName)
+
 #ifdef __cplusplus
 #define A_PLUGIN_REGISTER_CLASS(interfaceName, className) \
         PRIVATE_APLUGINSDK_REGISTER_CLASS(interfaceName, className)
+/* A_PLUGIN_SIGNATURE_TYPE(type, name) is defined in private/signature.h, because hosts need it too */
 #endif
 
 #if !APLUGINSDK_EXCLUDE_IMPLEMENTATION
@@ -11,11 +11,31 @@ PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
 PRIVATE_APLUGINLIBRARY_OPEN_NAMESPACE
     struct APluginInfo;
 
+    /* stable 64 bit hash of a name (FNV-1a), see private/namehash.h */
+#if defined(__cplusplus) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L)
+    typedef uint64_t APluginNameHash;
+#elif defined(_MSC_VER)
+    typedef unsigned __int64 APluginNameHash;
+#elif defined(__GNUC__)
+    __extension__ typedef unsigned long long APluginNameHash;
+#else
+    typedef unsigned long long APluginNameHash;
+#endif
+
     enum APluginLanguage
     {
         CPP, C
     };
 
+    /* instruction set extensions a feature variant requires (see A_PLUGIN_REGISTER_FEATURE_VARIANT), variants which
+     * require higher flags are preferred */
+#define APLUGINSDK_ISA_SSE2 0x01UL
+#define APLUGINSDK_ISA_SSE4_2 0x02UL
+#define APLUGINSDK_ISA_AVX 0x04UL
+#define APLUGINSDK_ISA_AVX2 0x08UL
+#define APLUGINSDK_ISA_AVX512F 0x10UL
+#define APLUGINSDK_ISA_NEON 0x20UL
+
     struct APluginFeatureInfo
     {
         const struct APluginInfo *pluginInfo;
@@ -24,6 +44,12 @@ PRIVATE_APLUGINLIBRARY_OPEN_NAMESPACE
         const char *returnType;
         const char *parameterList;
         void *functionPointer;
+
+        /* since api version 5 */
+        size_t structSize;
+        APluginNameHash featureGroupHash;
+        APluginNameHash featureNameHash;
+        APluginNameHash signatureHash; /* see private/signature.h, 0 if unknown */
     };
 
     struct APluginClassInfo
@@ -33,6 +59,29 @@ PRIVATE_APLUGINLIBRARY_OPEN_NAMESPACE
         const char *className;
         void *createInstance;
         void *deleteInstance;
+
+        /* since api version 5 */
+        size_t structSize;
+        APluginNameHash interfaceNameHash;
+        APluginNameHash classNameHash;
+
+        /* since api version 5.1 (see private/classfactory.h) */
+        size_t instanceSize, instanceAlignment;
+        void *constructAt; /* className*(*)(void *memory) */
+        void *destroyAt; /* void(*)(className *instance) */
+        void *createInstances; /* size_t(*)(size_t count, className **instances) */
+        void *deleteInstances; /* void(*)(className *firstInstance) */
+    };
+
+    /* since api version 5.2 */
+    struct APluginFeatureVariant
+    {
+        const char *featureGroup;
+        const char *featureName;
+        unsigned long instructionSets; /* the APLUGINSDK_ISA_* flags required by functionPointer */
+        void *functionPointer;
+        APluginNameHash featureGroupHash;
+        APluginNameHash featureNameHash;
     };
 
     struct APluginInfo
@@ -55,6 +104,15 @@ PRIVATE_APLUGINLIBRARY_OPEN_NAMESPACE
         size_t(*getClassCount)();
         const struct APluginClassInfo*(*getClassInfo)(size_t index);
         const struct APluginClassInfo* const*(*getClassInfos)();
+
+        /* since api version 5 */
+        size_t structSize;
+        const struct APluginFeatureInfo*(*findFeature)(const char *featureGroup, const char *featureName);
+        const struct APluginClassInfo*(*findClass)(const char *interfaceName, const char *className);
+
+        /* since api version 5.2 */
+        size_t(*getFeatureVariantCount)();
+        const struct APluginFeatureVariant* const*(*getFeatureVariants)();
     };
 PRIVATE_APLUGINLIBRARY_CLOSE_NAMESPACE
 
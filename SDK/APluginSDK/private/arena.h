@@ -0,0 +1,44 @@
+#ifndef APLUGINSDK_ARENA_H
+#define APLUGINSDK_ARENA_H
+
+#include "../plugininfos.h"
+
+#ifdef __cplusplus
+#   define PRIVATE_APLUGINSDK_ARENA_NO_EXPORT APLUGINSDK_NO_EXPORT
+#else
+#   define PRIVATE_APLUGINSDK_ARENA_NO_EXPORT
+#endif
+
+PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
+
+    /* Bump allocator for the metadata of a plugin: allocations are taken from blocks one after another and are only
+     * freed all at once. The first block is provided by the owner (e.g. a static buffer), further blocks are allocated
+     * with twice the capacity of the previous one. Every allocation is aligned for pointers, size_t and 64 bit hashes. */
+    struct PRIVATE_APLUGINSDK_ARENA_NO_EXPORT private_APluginSDK_ArenaBlock {
+        struct private_APluginSDK_ArenaBlock *next;
+        size_t capacity, size; /* in bytes after the header */
+    };
+    struct PRIVATE_APLUGINSDK_ARENA_NO_EXPORT private_APluginSDK_Arena {
+        struct private_APluginSDK_ArenaBlock *blocks; /* the current block first */
+        struct private_APluginSDK_ArenaBlock *initialBlock; /* not freed */
+        void *last; /* the last allocation (may grow in place) */
+    };
+    union PRIVATE_APLUGINSDK_ARENA_NO_EXPORT private_APluginSDK_ArenaAlignment {
+        void *pointer;
+        size_t size;
+        double floatingPoint;
+        APLUGINLIBRARY_NAMESPACE APluginNameHash hash;
+        struct private_APluginSDK_ArenaBlock block;
+    };
+
+    static void private_APluginSDK_initArena(struct private_APluginSDK_Arena *arena, void *initialBlock, size_t size);
+    static void* private_APluginSDK_arenaAllocate(struct private_APluginSDK_Arena *arena, size_t size);
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+    static void* private_APluginSDK_arenaGrow(struct private_APluginSDK_Arena *arena, void *pointer, size_t oldSize,
+                                              size_t newSize);
+#endif
+    static void private_APluginSDK_releaseArena(struct private_APluginSDK_Arena *arena);
+
+PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
+
+#endif /* APLUGINSDK_ARENA_H */
@@ -0,0 +1,45 @@
+#ifndef APLUGINSDK_ATOMIC_H
+#define APLUGINSDK_ATOMIC_H
+
+#include "types.h"
+
+/* Sequentially consistent atomic operations on size_t values and a yield for spinning threads. Compilers without
+ * atomics fall back to plain operations, then loading and unloading of the same plugin has to be serialized. */
+#if defined(__GNUC__) || defined(__clang__)
+#   define PRIVATE_APLUGINSDK_ATOMIC_LOAD(pointer) __atomic_load_n(pointer, __ATOMIC_SEQ_CST)
+#   define PRIVATE_APLUGINSDK_ATOMIC_STORE(pointer, value) __atomic_store_n(pointer, value, __ATOMIC_SEQ_CST)
+#   define PRIVATE_APLUGINSDK_ATOMIC_COMPARE_EXCHANGE(pointer, expected, desired)                                      \
+        __sync_bool_compare_and_swap(pointer, expected, desired)
+#elif defined(_MSC_VER)
+#   include <intrin.h>
+#   ifdef _WIN64
+#       define PRIVATE_APLUGINSDK_ATOMIC_COMPARE_EXCHANGE(pointer, expected, desired)                                  \
+            (_InterlockedCompareExchange64((volatile __int64*) (pointer), (__int64) (desired), (__int64) (expected))   \
+                == (__int64) (expected))
+#       define PRIVATE_APLUGINSDK_ATOMIC_STORE(pointer, value)                                                         \
+            ((void) _InterlockedExchange64((volatile __int64*) (pointer), (__int64) (value)))
+#   else
+#       define PRIVATE_APLUGINSDK_ATOMIC_COMPARE_EXCHANGE(pointer, expected, desired)                                  \
+            (_InterlockedCompareExchange((volatile long*) (pointer), (long) (desired), (long) (expected))              \
+                == (long) (expected))
+#       define PRIVATE_APLUGINSDK_ATOMIC_STORE(pointer, value)                                                         \
+            ((void) _InterlockedExchange((volatile long*) (pointer), (long) (value)))
+#   endif
+#   define PRIVATE_APLUGINSDK_ATOMIC_LOAD(pointer) (*(volatile size_t*) (pointer)) /* acquire with /volatile:ms */
+#else
+#   define PRIVATE_APLUGINSDK_ATOMIC_LOAD(pointer) (*(pointer))
+#   define PRIVATE_APLUGINSDK_ATOMIC_STORE(pointer, value) ((void) (*(pointer) = (value)))
+#   define PRIVATE_APLUGINSDK_ATOMIC_COMPARE_EXCHANGE(pointer, expected, desired)                                      \
+        (*(pointer) == (expected) ? (*(pointer) = (desired), true) : false)
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <sched.h>
+#   define PRIVATE_APLUGINSDK_YIELD() ((void) sched_yield())
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#   define PRIVATE_APLUGINSDK_YIELD() _mm_pause()
+#else
+#   define PRIVATE_APLUGINSDK_YIELD() ((void) 0)
+#endif
+
+#endif /* APLUGINSDK_ATOMIC_H */
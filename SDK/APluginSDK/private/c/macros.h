@@ -32,6 +32,15 @@
     private_APluginSDK_registerFeature(#featureGroup, #featureName,                                                   \
         private_APluginSDK_plugin_implemenation_feature_##featureGroup##_##featureName##_returnType,                  \
         private_APluginSDK_plugin_implemenation_feature_##featureGroup##_##featureName##_parameters,                  \
-        (void*) private_APluginSDK_plugin_implemenation_feature_##featureGroup##_##featureName##_function)
+        (void*) private_APluginSDK_plugin_implemenation_feature_##featureGroup##_##featureName##_function, 0)
+
+/* private plugin feature variant macros */
+#define PRIVATE_APLUGINSDK_REGISTER_FEATURE_VARIANT(instructionSet, returnType, featureGroup, featureName, ...)        \
+    PRIVATE_APLUGINSDK_TARGET_##instructionSet APLUGINSDK_NO_EXPORT returnType                                         \
+        private_APluginSDK_plugin_implemenation_feature_##featureGroup##_##featureName##_##instructionSet##_function(__VA_ARGS__)
+
+#define PRIVATE_APLUGINSDK_RECORD_FEATURE_VARIANT(instructionSet, featureGroup, featureName)                           \
+    private_APluginSDK_registerFeatureVariant(#featureGroup, #featureName, APLUGINSDK_ISA_##instructionSet,           \
+        (void*) private_APluginSDK_plugin_implemenation_feature_##featureGroup##_##featureName##_##instructionSet##_function)
 
 #endif /* APLUGINSDK_C_MACROS_H */
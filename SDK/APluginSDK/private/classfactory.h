@@ -0,0 +1,58 @@
+#ifndef APLUGINSDK_CLASSFACTORY_H
+#define APLUGINSDK_CLASSFACTORY_H
+
+#include "../plugininfos.h"
+
+/* The instance functions of a class registered with A_PLUGIN_REGISTER_CLASS (see APluginClassInfo). Besides creating
+ * and deleting instances on the heap of the plugin, the host can construct instances in its own storage (instanceSize
+ * and instanceAlignment bytes) or create count instances with one allocation (deleted with deleteInstances(instances[0])).
+ * The pointers are pointers to the class, the host uses them as pointers to the interface. */
+#ifdef __cplusplus
+#include <new>
+
+PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
+    template<typename T>
+    struct APLUGINSDK_NO_EXPORT private_APluginSDK_ClassFactory
+    {
+#if __cplusplus >= 201103L
+        static const size_t alignment = alignof(T);
+#else
+        struct AlignmentProbe { char offset; T instance; };
+        static const size_t alignment = sizeof(AlignmentProbe) - sizeof(T);
+#endif
+
+        static T* createInstance()
+        {
+            return new T();
+        }
+        static void deleteInstance(T *instance)
+        {
+            delete instance;
+        }
+        static T* constructAt(void *memory)
+        {
+            return new(memory) T();
+        }
+        static void destroyAt(T *instance)
+        {
+            instance->~T();
+        }
+        static size_t createInstances(size_t count, T **instances)
+        {
+            T *array = count == 0 ? NULL : new(std::nothrow) T[count];
+            size_t i;
+            if(array == NULL)
+                return 0;
+            for(i = 0; i < count; ++i)
+                instances[i] = array + i;
+            return count;
+        }
+        static void deleteInstances(T *instances)
+        {
+            delete[] instances;
+        }
+    };
+PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
+#endif
+
+#endif /* APLUGINSDK_CLASSFACTORY_H */
@@ -52,41 +52,141 @@
     static bool private_APluginSDK_implementation_version_pluginVersionSet =                                          \
         PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_setPluginVersion(major, minor, patch)
 
+/* feature and class infos are constant records collected by the linker (no registration code at load time) */
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__ELF__) && !defined(APLUGINSDK_NO_SECTION_REGISTRATION)
+#   define PRIVATE_APLUGINSDK_SECTION_REGISTRATION 1
+#   define PRIVATE_APLUGINSDK_FEATURE_SECTION __attribute__((section("apluginsdk_features"), used))
+#   define PRIVATE_APLUGINSDK_CLASS_SECTION __attribute__((section("apluginsdk_classes"), used))
+#   define PRIVATE_APLUGINSDK_VARIANT_SECTION __attribute__((section("apluginsdk_variants"), used))
+#else
+#   define PRIVATE_APLUGINSDK_SECTION_REGISTRATION 0
+#endif
+
 /* private plugin feature macro */
+#if PRIVATE_APLUGINSDK_SECTION_REGISTRATION
 #define PRIVATE_APLUGINSDK_REGISTER_FEATURE(returnType, featureGroup, featureName, ...)                                \
     PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE                                                                          \
         namespace implementation { namespace features { namespace featureGroup { namespace featureName {               \
             APLUGINSDK_NO_EXPORT returnType featureFunction(__VA_ARGS__);                                              \
-            APLUGINSDK_NO_EXPORT bool pluginFeatureRegistered = private_APluginSDK_registerFeature(#featureGroup,     \
-                #featureName, #returnType, "" #__VA_ARGS__,  reinterpret_cast<void*>(featureFunction));                \
+            static const struct :: APLUGINLIBRARY_NAMESPACE APluginFeatureInfo pluginFeatureInfo = {                   \
+                &:: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_pluginInfo,                                \
+                #featureGroup, #featureName, #returnType, "" #__VA_ARGS__, reinterpret_cast<void*>(featureFunction),   \
+                sizeof(struct :: APLUGINLIBRARY_NAMESPACE APluginFeatureInfo),                                         \
+                :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_hashName(#featureGroup),                    \
+                :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_hashName(#featureName),                     \
+                :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_signatureHash(featureFunction)};             \
+            PRIVATE_APLUGINSDK_FEATURE_SECTION                                                                         \
+            static const struct :: APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const                                  \
+                pluginFeatureRegistered = &pluginFeatureInfo;                                                          \
         }}}}                                                                                                           \
     PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE                                                                         \
     returnType PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE implementation::features::featureGroup::featureName::featureFunction(__VA_ARGS__)
+#else
+#define PRIVATE_APLUGINSDK_REGISTER_FEATURE(returnType, featureGroup, featureName, ...)                                \
+    PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE                                                                          \
+        namespace implementation { namespace features { namespace featureGroup { namespace featureName {               \
+            APLUGINSDK_NO_EXPORT returnType featureFunction(__VA_ARGS__);                                              \
+            APLUGINSDK_NO_EXPORT bool pluginFeatureRegistered =                                                        \
+                :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_registerFeature(#featureGroup,              \
+                    #featureName, #returnType, "" #__VA_ARGS__,  reinterpret_cast<void*>(featureFunction),             \
+                    :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_signatureHash(featureFunction));         \
+        }}}}                                                                                                           \
+    PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE                                                                         \
+    returnType PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE implementation::features::featureGroup::featureName::featureFunction(__VA_ARGS__)
+#endif
 
 #define PRIVATE_APLUGINSDK_RECORD_FEATURE(featureGroup, featureName) \
     { ((void)PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE implementation::features::featureGroup::featureName::pluginFeatureRegistered); } ((void)0)
 
+/* private plugin feature variant macros */
+#if PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+#define PRIVATE_APLUGINSDK_REGISTER_FEATURE_VARIANT(instructionSet, returnType, featureGroup, featureName, ...)        \
+    PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE                                                                          \
+        namespace implementation { namespace features { namespace featureGroup { namespace featureName {               \
+        namespace variant_##instructionSet {                                                                           \
+            PRIVATE_APLUGINSDK_TARGET_##instructionSet                                                                 \
+            APLUGINSDK_NO_EXPORT returnType featureFunction(__VA_ARGS__);                                              \
+            static const struct :: APLUGINLIBRARY_NAMESPACE APluginFeatureVariant pluginFeatureVariant = {             \
+                #featureGroup, #featureName, APLUGINSDK_ISA_##instructionSet,                                          \
+                reinterpret_cast<void*>(featureFunction),                                                              \
+                :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_hashName(#featureGroup),                    \
+                :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_hashName(#featureName)};                    \
+            PRIVATE_APLUGINSDK_VARIANT_SECTION                                                                         \
+            static const struct :: APLUGINLIBRARY_NAMESPACE APluginFeatureVariant* const                               \
+                pluginFeatureVariantRegistered = &pluginFeatureVariant;                                                \
+        }}}}}                                                                                                          \
+    PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE                                                                         \
+    returnType PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE                                                                    \
+        implementation::features::featureGroup::featureName::variant_##instructionSet::featureFunction(__VA_ARGS__)
+#else
+#define PRIVATE_APLUGINSDK_REGISTER_FEATURE_VARIANT(instructionSet, returnType, featureGroup, featureName, ...)        \
+    PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE                                                                          \
+        namespace implementation { namespace features { namespace featureGroup { namespace featureName {               \
+        namespace variant_##instructionSet {                                                                           \
+            PRIVATE_APLUGINSDK_TARGET_##instructionSet                                                                 \
+            APLUGINSDK_NO_EXPORT returnType featureFunction(__VA_ARGS__);                                              \
+            APLUGINSDK_NO_EXPORT bool pluginFeatureVariantRegistered =                                                 \
+                :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_registerFeatureVariant(                     \
+                    #featureGroup, #featureName, APLUGINSDK_ISA_##instructionSet,                                      \
+                    reinterpret_cast<void*>(featureFunction));                                                         \
+        }}}}}                                                                                                          \
+    PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE                                                                         \
+    returnType PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE                                                                    \
+        implementation::features::featureGroup::featureName::variant_##instructionSet::featureFunction(__VA_ARGS__)
+#endif
+
+#define PRIVATE_APLUGINSDK_RECORD_FEATURE_VARIANT(instructionSet, featureGroup, featureName)                           \
+    { ((void)PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE implementation::features::featureGroup::featureName::                \
+        variant_##instructionSet::pluginFeatureVariantRegistered); } ((void)0)
+
 /* private plugin class macros */
+#define PRIVATE_APLUGINSDK_CLASS_INSTANCE_FUNCTIONS(Factory)                                                           \
+    reinterpret_cast<void*>(Factory::constructAt), reinterpret_cast<void*>(Factory::destroyAt),                        \
+    reinterpret_cast<void*>(Factory::createInstances), reinterpret_cast<void*>(Factory::deleteInstances)
+#if PRIVATE_APLUGINSDK_SECTION_REGISTRATION
 #define PRIVATE_APLUGINSDK_REGISTER_CLASS(interfaceName, className)                                                    \
     PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE                                                                          \
         namespace implementation { namespace classes {                                                                 \
             namespace interface_##interfaceName { namespace class_##className {                                        \
-                APLUGINSDK_NO_EXPORT className* createInstance()                                                       \
-                {                                                                                                      \
-                    return new className();                                                                            \
-                }                                                                                                      \
-                APLUGINSDK_NO_EXPORT void deleteInstance(className* ptr)                                               \
-                {                                                                                                      \
-                    delete ptr;                                                                                        \
-                }                                                                                                      \
+                typedef :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE                                                        \
+                    private_APluginSDK_ClassFactory<className> Factory;                                                \
+                static const struct :: APLUGINLIBRARY_NAMESPACE APluginClassInfo pluginClassInfo = {                   \
+                    &:: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_pluginInfo,                            \
+                    #interfaceName, #className,                                                                        \
+                    reinterpret_cast<void*>(Factory::createInstance),                                                  \
+                    reinterpret_cast<void*>(Factory::deleteInstance),                                                  \
+                    sizeof(struct :: APLUGINLIBRARY_NAMESPACE APluginClassInfo),                                       \
+                    :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_hashName(#interfaceName),               \
+                    :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_hashName(#className),                   \
+                    sizeof(className), Factory::alignment, PRIVATE_APLUGINSDK_CLASS_INSTANCE_FUNCTIONS(Factory)};      \
+                PRIVATE_APLUGINSDK_CLASS_SECTION                                                                       \
+                static const struct :: APLUGINLIBRARY_NAMESPACE APluginClassInfo* const                                \
+                    pluginClassRegistered = &pluginClassInfo;                                                          \
             }}                                                                                                         \
         }}                                                                                                             \
     PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE                                                                         \
-    APLUGINSDK_NO_EXPORT bool private_APluginSDK_implementation_classes_##interfaceName##_##className =               \
-        :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_registerClass(#interfaceName, #className,          \
+    typedef bool private_APluginSDK_implementation_classes_##interfaceName##_##className
+#else
+/* private plugin class macros */
+#define PRIVATE_APLUGINSDK_REGISTER_CLASS(interfaceName, className)                                                    \
+    PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE                                                                          \
+        namespace implementation { namespace classes {                                                                 \
+            namespace interface_##interfaceName { namespace class_##className {                                        \
+                typedef :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE                                                        \
+                    private_APluginSDK_ClassFactory<className> Factory;                                                \
+            }}                                                                                                         \
+        }}                                                                                                             \
+    PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE                                                                         \
+    APLUGINSDK_NO_EXPORT bool private_APluginSDK_implementation_classes_##interfaceName##_##className =                \
+        :: PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE private_APluginSDK_registerClass(#interfaceName, #className,           \
             reinterpret_cast<void*>(PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE implementation::classes::                     \
-                interface_##interfaceName::class_##className::createInstance),                                         \
+                interface_##interfaceName::class_##className::Factory::createInstance),                                \
             reinterpret_cast<void*>(PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE implementation::classes::                     \
-                interface_##interfaceName::class_##className::deleteInstance))
+                interface_##interfaceName::class_##className::Factory::deleteInstance),                                \
+            sizeof(className), PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE implementation::classes::                          \
+                interface_##interfaceName::class_##className::Factory::alignment,                                      \
+            PRIVATE_APLUGINSDK_CLASS_INSTANCE_FUNCTIONS(PRIVATE_APLUGINSDK_PRIVATE_NAMESPACE implementation::classes:: \
+                interface_##interfaceName::class_##className::Factory))
+#endif
 
 #endif /* APLUGINSDK_CPP_MACROS_H */
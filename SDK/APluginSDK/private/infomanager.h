@@ -2,21 +2,33 @@
 #define APLUGINSDK_INFOMANAGER_H
 
 #include "../plugininfos.h"
+#include "signature.h"
+#include "classfactory.h"
 
 PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
 
+    APLUGINSDK_NO_EXPORT extern struct APLUGINLIBRARY_NAMESPACE APluginInfo private_APluginSDK_pluginInfo;
+
     APLUGINSDK_NO_EXPORT const struct APLUGINLIBRARY_NAMESPACE APluginInfo* private_APluginSDK_getPluginInfo(void);
 
     APLUGINSDK_NO_EXPORT bool private_APluginSDK_setPluginName(const char *name);
     APLUGINSDK_NO_EXPORT bool private_APluginSDK_setPluginVersion(size_t major, size_t minor, size_t patch);
 
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
     APLUGINSDK_NO_EXPORT bool private_APluginSDK_registerFeature(const char *featureGroup, const char *featureName,
                                                                  const char *returnType, const char *parameterList,
-                                                                 void* functionPtr);
+                                                                 void* functionPtr,
+                                                                 APLUGINLIBRARY_NAMESPACE APluginNameHash signatureHash);
+    APLUGINSDK_NO_EXPORT bool private_APluginSDK_registerFeatureVariant(const char *featureGroup, const char *featureName,
+                                                                        unsigned long instructionSets, void *functionPtr);
     APLUGINSDK_NO_EXPORT bool private_APluginSDK_registerClass(const char *interfaceClassName,
                                                                const char *featureClassName,
                                                                void *createInstance,
-                                                               void *deleteInstance);
+                                                               void *deleteInstance,
+                                                               size_t instanceSize, size_t instanceAlignment,
+                                                               void *constructAt, void *destroyAt,
+                                                               void *createInstances, void *deleteInstances);
+#endif
 
 #if PRIVATE_APLUGINSDK_INTEGRATED_PLUGIN
     APLUGINSDK_NO_EXPORT bool private_APluginSDK_registerInitAPluginFunction(void *functionPtr);
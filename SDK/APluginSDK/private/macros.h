@@ -11,6 +11,26 @@
 #   include "c/macros.h"
 #endif
 
+#ifndef PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+#   define PRIVATE_APLUGINSDK_SECTION_REGISTRATION 0
+#endif
+
+/* feature variants are compiled for their instruction set, so the rest of the plugin doesn't require it */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#   define PRIVATE_APLUGINSDK_TARGET_SSE2 __attribute__((target("sse2")))
+#   define PRIVATE_APLUGINSDK_TARGET_SSE4_2 __attribute__((target("sse4.2")))
+#   define PRIVATE_APLUGINSDK_TARGET_AVX __attribute__((target("avx")))
+#   define PRIVATE_APLUGINSDK_TARGET_AVX2 __attribute__((target("avx2")))
+#   define PRIVATE_APLUGINSDK_TARGET_AVX512F __attribute__((target("avx512f")))
+#else
+#   define PRIVATE_APLUGINSDK_TARGET_SSE2
+#   define PRIVATE_APLUGINSDK_TARGET_SSE4_2
+#   define PRIVATE_APLUGINSDK_TARGET_AVX
+#   define PRIVATE_APLUGINSDK_TARGET_AVX2
+#   define PRIVATE_APLUGINSDK_TARGET_AVX512F
+#endif
+#define PRIVATE_APLUGINSDK_TARGET_NEON
+
 #define PRIVATE_APLUGINSDK_OPEN_EXTERN_C ACUTILS_OPEN_EXTERN_C
 #define PRIVATE_APLUGINSDK_CLOSE_EXTERN_C ACUTILS_CLOSE_EXTERN_C
 
@@ -0,0 +1,26 @@
+#ifndef APLUGINSDK_NAMEHASH_H
+#define APLUGINSDK_NAMEHASH_H
+
+#include "../plugininfos.h"
+
+/* The names of features and classes are hashed with 64 bit FNV-1a. In C++11 the hash is evaluated at compile time, so
+ * the hashes of the registered features and classes are part of their constant infos. The C implementation is in
+ * infomanager.c and hashes the names once on registration. */
+#ifdef __cplusplus
+#   if __cplusplus >= 201103L
+#       define PRIVATE_APLUGINSDK_CONSTEXPR constexpr
+#   else
+#       define PRIVATE_APLUGINSDK_CONSTEXPR inline
+#   endif
+
+PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_hashName(
+            const char *name, APLUGINLIBRARY_NAMESPACE APluginNameHash hash = 0xcbf29ce484222325ULL)
+    {
+        return *name == '\0' ? hash
+            : private_APluginSDK_hashName(name + 1, (hash ^ static_cast<unsigned char>(*name)) * 0x100000001b3ULL);
+    }
+PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
+#endif
+
+#endif /* APLUGINSDK_NAMEHASH_H */
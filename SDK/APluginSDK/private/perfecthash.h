@@ -0,0 +1,33 @@
+#ifndef APLUGINSDK_PERFECTHASH_H
+#define APLUGINSDK_PERFECTHASH_H
+
+#include "../plugininfos.h"
+
+#ifdef __cplusplus
+#   define PRIVATE_APLUGINSDK_PERFECTHASH_NO_EXPORT APLUGINSDK_NO_EXPORT
+#else
+#   define PRIVATE_APLUGINSDK_PERFECTHASH_NO_EXPORT
+#endif
+
+PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
+
+    /* Minimal perfect hash over 64 bit keys (hash and displace): every key is assigned to a bucket and every bucket
+     * has a displacement which maps all of its keys to distinct slots, so a lookup is two hash computations and one
+     * comparison. A table with keyCount 0 maps nothing. */
+    struct PRIVATE_APLUGINSDK_PERFECTHASH_NO_EXPORT private_APluginSDK_PerfectHash {
+        size_t keyCount, bucketCount;
+        size_t *displacements; /* per bucket */
+        size_t *slots; /* index of the key in every slot */
+    };
+
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_combineHashes(
+            APLUGINLIBRARY_NAMESPACE APluginNameHash hash1, APLUGINLIBRARY_NAMESPACE APluginNameHash hash2);
+    static bool private_APluginSDK_buildPerfectHash(struct private_APluginSDK_PerfectHash *table,
+                                                    const APLUGINLIBRARY_NAMESPACE APluginNameHash *keys, size_t keyCount);
+    static size_t private_APluginSDK_lookupPerfectHash(const struct private_APluginSDK_PerfectHash *table,
+                                                       APLUGINLIBRARY_NAMESPACE APluginNameHash key);
+    static void private_APluginSDK_freePerfectHash(struct private_APluginSDK_PerfectHash *table);
+
+PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
+
+#endif /* APLUGINSDK_PERFECTHASH_H */
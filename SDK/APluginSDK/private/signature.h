@@ -0,0 +1,181 @@
+#ifndef APLUGINSDK_SIGNATURE_H
+#define APLUGINSDK_SIGNATURE_H
+
+#include "namehash.h"
+
+/* The signature of a feature is the name hash of a canonical spelling of its decayed return and parameter types, like
+ * "i32(char const*,u64)": integers are spelled by signedness and size (i8 ... u64), char, bool, float, double,
+ * long double and void keep their names, every pointer level appends "*" and qualified pointees append " const",
+ * " volatile" or " const volatile". Top level qualifiers are dropped and all other types are spelled by their name.
+ * C++ computes the signature from the function type (types which are not built in have to be named with
+ * A_PLUGIN_SIGNATURE_TYPE), C normalizes the stringified types on registration (see src/signature.c).
+ * A signature of 0 is unknown (e.g. unnamed types, variadic functions or function pointer parameters). */
+#ifdef __cplusplus
+PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_appendSignature(
+            const char *string, APLUGINLIBRARY_NAMESPACE APluginNameHash hash)
+    {
+        return hash == 0 ? 0 : private_APluginSDK_hashName(string, hash);
+    }
+    PRIVATE_APLUGINSDK_CONSTEXPR const char* private_APluginSDK_integerName(size_t size, bool isSigned)
+    {
+        return size == 1 ? (isSigned ? "i8" : "u8") : size == 2 ? (isSigned ? "i16" : "u16")
+            : size == 4 ? (isSigned ? "i32" : "u32") : size == 8 ? (isSigned ? "i64" : "u64") : (isSigned ? "i128" : "u128");
+    }
+
+    /* appends the spelling of T to the hash (unknown types reset it to 0) */
+    template<typename T>
+    struct private_APluginSDK_SignatureType
+    {
+        static PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash append(APLUGINLIBRARY_NAMESPACE APluginNameHash)
+        {
+            return 0;
+        }
+    };
+
+#define PRIVATE_APLUGINSDK_SIGNATURE_SPELLING(type, spelling)                                                          \
+    struct private_APluginSDK_SignatureType< type >                                                                    \
+    {                                                                                                                  \
+        static PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash append(                           \
+                APLUGINLIBRARY_NAMESPACE APluginNameHash hash)                                                         \
+        {                                                                                                              \
+            return private_APluginSDK_appendSignature(spelling,                                                        \
+                private_APluginSDK_SignatureType<T>::append(hash));                                                    \
+        }                                                                                                              \
+    };
+    template<typename T> PRIVATE_APLUGINSDK_SIGNATURE_SPELLING(T*, "*")
+    template<typename T> PRIVATE_APLUGINSDK_SIGNATURE_SPELLING(T&, "&")
+    template<typename T> PRIVATE_APLUGINSDK_SIGNATURE_SPELLING(T const, " const")
+    template<typename T> PRIVATE_APLUGINSDK_SIGNATURE_SPELLING(T volatile, " volatile")
+    template<typename T> PRIVATE_APLUGINSDK_SIGNATURE_SPELLING(T const volatile, " const volatile")
+#undef PRIVATE_APLUGINSDK_SIGNATURE_SPELLING
+
+#define PRIVATE_APLUGINSDK_SIGNATURE_NAME(type, name)                                                                  \
+    template<>                                                                                                         \
+    struct private_APluginSDK_SignatureType< type >                                                                    \
+    {                                                                                                                  \
+        static PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash append(                           \
+                APLUGINLIBRARY_NAMESPACE APluginNameHash hash)                                                         \
+        {                                                                                                              \
+            return private_APluginSDK_appendSignature(name, hash);                                                     \
+        }                                                                                                              \
+    };
+
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(void, "void")
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(bool, "bool")
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(char, "char")
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(signed char, "i8")
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(unsigned char, "u8")
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(short, private_APluginSDK_integerName(sizeof(short), true))
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(unsigned short, private_APluginSDK_integerName(sizeof(short), false))
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(int, private_APluginSDK_integerName(sizeof(int), true))
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(unsigned int, private_APluginSDK_integerName(sizeof(int), false))
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(long, private_APluginSDK_integerName(sizeof(long), true))
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(unsigned long, private_APluginSDK_integerName(sizeof(long), false))
+#if __cplusplus >= 201103L
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(long long, private_APluginSDK_integerName(sizeof(long long), true))
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(unsigned long long, private_APluginSDK_integerName(sizeof(long long), false))
+#endif
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(float, "float")
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(double, "double")
+    PRIVATE_APLUGINSDK_SIGNATURE_NAME(long double, "long double")
+
+    /* top level qualifiers of (class) return types are not part of the signature */
+    template<typename T> struct private_APluginSDK_SignatureReturn : private_APluginSDK_SignatureType<T> {};
+    template<typename T> struct private_APluginSDK_SignatureReturn<T const> : private_APluginSDK_SignatureType<T> {};
+    template<typename T> struct private_APluginSDK_SignatureReturn<T volatile> : private_APluginSDK_SignatureType<T> {};
+    template<typename T> struct private_APluginSDK_SignatureReturn<T const volatile> : private_APluginSDK_SignatureType<T> {};
+
+    template<typename R>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_beginSignature()
+    {
+        return private_APluginSDK_appendSignature("(", private_APluginSDK_SignatureReturn<R>::append(0xcbf29ce484222325ULL));
+    }
+    template<typename T>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_appendParameter(
+            APLUGINLIBRARY_NAMESPACE APluginNameHash hash)
+    {
+        return private_APluginSDK_SignatureType<T>::append(private_APluginSDK_appendSignature(",", hash));
+    }
+
+    /* signatures of function pointers with up to 8 parameters, everything else is unknown */
+    template<typename F>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(F)
+    {
+        return 0;
+    }
+    template<typename R>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)())
+    {
+        return private_APluginSDK_appendSignature(")", private_APluginSDK_beginSignature<R>());
+    }
+    template<typename R, typename A1>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)(A1))
+    {
+        return private_APluginSDK_appendSignature(")",
+            private_APluginSDK_SignatureType<A1>::append(private_APluginSDK_beginSignature<R>()));
+    }
+    template<typename R, typename A1, typename A2>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)(A1, A2))
+    {
+        return private_APluginSDK_appendSignature(")", private_APluginSDK_appendParameter<A2>(
+            private_APluginSDK_SignatureType<A1>::append(private_APluginSDK_beginSignature<R>())));
+    }
+    template<typename R, typename A1, typename A2, typename A3>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)(A1, A2, A3))
+    {
+        return private_APluginSDK_appendSignature(")", private_APluginSDK_appendParameter<A3>(
+            private_APluginSDK_appendParameter<A2>(
+            private_APluginSDK_SignatureType<A1>::append(private_APluginSDK_beginSignature<R>()))));
+    }
+    template<typename R, typename A1, typename A2, typename A3, typename A4>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)(A1, A2, A3, A4))
+    {
+        return private_APluginSDK_appendSignature(")", private_APluginSDK_appendParameter<A4>(
+            private_APluginSDK_appendParameter<A3>(private_APluginSDK_appendParameter<A2>(
+            private_APluginSDK_SignatureType<A1>::append(private_APluginSDK_beginSignature<R>())))));
+    }
+    template<typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)(A1, A2, A3, A4, A5))
+    {
+        return private_APluginSDK_appendSignature(")", private_APluginSDK_appendParameter<A5>(
+            private_APluginSDK_appendParameter<A4>(private_APluginSDK_appendParameter<A3>(
+            private_APluginSDK_appendParameter<A2>(
+            private_APluginSDK_SignatureType<A1>::append(private_APluginSDK_beginSignature<R>()))))));
+    }
+    template<typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)(A1, A2, A3, A4, A5, A6))
+    {
+        return private_APluginSDK_appendSignature(")", private_APluginSDK_appendParameter<A6>(
+            private_APluginSDK_appendParameter<A5>(private_APluginSDK_appendParameter<A4>(
+            private_APluginSDK_appendParameter<A3>(private_APluginSDK_appendParameter<A2>(
+            private_APluginSDK_SignatureType<A1>::append(private_APluginSDK_beginSignature<R>())))))));
+    }
+    template<typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)(A1, A2, A3, A4, A5, A6, A7))
+    {
+        return private_APluginSDK_appendSignature(")", private_APluginSDK_appendParameter<A7>(
+            private_APluginSDK_appendParameter<A6>(private_APluginSDK_appendParameter<A5>(
+            private_APluginSDK_appendParameter<A4>(private_APluginSDK_appendParameter<A3>(
+            private_APluginSDK_appendParameter<A2>(
+            private_APluginSDK_SignatureType<A1>::append(private_APluginSDK_beginSignature<R>()))))))));
+    }
+    template<typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+    PRIVATE_APLUGINSDK_CONSTEXPR APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureHash(R(*)(A1, A2, A3, A4, A5, A6, A7, A8))
+    {
+        return private_APluginSDK_appendSignature(")", private_APluginSDK_appendParameter<A8>(
+            private_APluginSDK_appendParameter<A7>(private_APluginSDK_appendParameter<A6>(
+            private_APluginSDK_appendParameter<A5>(private_APluginSDK_appendParameter<A4>(
+            private_APluginSDK_appendParameter<A3>(private_APluginSDK_appendParameter<A2>(
+            private_APluginSDK_SignatureType<A1>::append(private_APluginSDK_beginSignature<R>())))))))));
+    }
+PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
+
+/* names a type for the signatures (at global scope, name should be the spelling of the type in C plugins) */
+#define A_PLUGIN_SIGNATURE_TYPE(type, name)                                                                            \
+    PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE PRIVATE_APLUGINSDK_SIGNATURE_NAME(type, #name)                           \
+    PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE                                                                         \
+    typedef APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_signatureTypeHash
+#endif
+
+#endif /* APLUGINSDK_SIGNATURE_H */
@@ -0,0 +1,98 @@
+#include "../arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
+
+    /* the capacity of the first allocated block if the arena has no initial block */
+    static const size_t private_APluginSDK_minArenaBlockCapacity = 256;
+
+    static size_t private_APluginSDK_alignArenaSize(size_t size)
+    {
+        const size_t alignment = sizeof(union private_APluginSDK_ArenaAlignment);
+        return size == 0 ? alignment : (size + alignment - 1) / alignment * alignment;
+    }
+    static char* private_APluginSDK_arenaBlockData(struct private_APluginSDK_ArenaBlock *block)
+    {
+        return (char*) block + sizeof(union private_APluginSDK_ArenaAlignment);
+    }
+
+    /* initialBlock has to be aligned like union private_APluginSDK_ArenaAlignment and may be null. */
+    static void private_APluginSDK_initArena(struct private_APluginSDK_Arena *arena, void *initialBlock, size_t size)
+    {
+        arena->blocks = arena->initialBlock = NULL;
+        arena->last = NULL;
+        if(initialBlock != NULL && size > sizeof(union private_APluginSDK_ArenaAlignment)) {
+            arena->initialBlock = (struct private_APluginSDK_ArenaBlock*) initialBlock;
+            arena->initialBlock->next = NULL;
+            arena->initialBlock->capacity = (size - sizeof(union private_APluginSDK_ArenaAlignment))
+                                            / sizeof(union private_APluginSDK_ArenaAlignment)
+                                            * sizeof(union private_APluginSDK_ArenaAlignment);
+            arena->initialBlock->size = 0;
+            arena->blocks = arena->initialBlock;
+        }
+    }
+    /* Returns null if no block with enough space could be allocated. */
+    static void* private_APluginSDK_arenaAllocate(struct private_APluginSDK_Arena *arena, size_t size)
+    {
+        struct private_APluginSDK_ArenaBlock *block = arena->blocks;
+        size = private_APluginSDK_alignArenaSize(size);
+        if(block == NULL || block->capacity - block->size < size) {
+            size_t capacity = block == NULL ? private_APluginSDK_minArenaBlockCapacity : block->capacity * 2;
+            while(capacity < size)
+                capacity *= 2;
+            block = (struct private_APluginSDK_ArenaBlock*) malloc(sizeof(union private_APluginSDK_ArenaAlignment) + capacity);
+            if(block == NULL)
+                return NULL;
+            block->next = arena->blocks;
+            block->capacity = capacity;
+            block->size = 0;
+            arena->blocks = block;
+        }
+        arena->last = private_APluginSDK_arenaBlockData(block) + block->size;
+        block->size += size;
+        return arena->last;
+    }
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+    /* Grows the last allocation in place if its block has enough space left, otherwise the content is copied to a new
+     * allocation (the old one stays unused until the arena is released). Returns null if nothing could be allocated. */
+    static void* private_APluginSDK_arenaGrow(struct private_APluginSDK_Arena *arena, void *pointer, size_t oldSize,
+                                              size_t newSize)
+    {
+        struct private_APluginSDK_ArenaBlock *block = arena->blocks;
+        void *newPointer;
+        if(pointer == NULL)
+            return private_APluginSDK_arenaAllocate(arena, newSize);
+        oldSize = private_APluginSDK_alignArenaSize(oldSize);
+        newSize = private_APluginSDK_alignArenaSize(newSize);
+        if(newSize <= oldSize)
+            return pointer;
+        if(pointer == arena->last && block->capacity - block->size >= newSize - oldSize) {
+            block->size += newSize - oldSize;
+            return pointer;
+        }
+        newPointer = private_APluginSDK_arenaAllocate(arena, newSize);
+        if(newPointer != NULL)
+            memcpy(newPointer, pointer, oldSize);
+        return newPointer;
+    }
+#endif
+    /* Frees all allocated blocks at once, the initial block is reused. */
+    static void private_APluginSDK_releaseArena(struct private_APluginSDK_Arena *arena)
+    {
+        struct private_APluginSDK_ArenaBlock *next, *block;
+        for(block = arena->blocks; block != NULL; block = next) {
+            next = block->next;
+            if(block != arena->initialBlock)
+                free(block);
+        }
+        arena->blocks = arena->initialBlock;
+        if(arena->initialBlock != NULL) {
+            arena->initialBlock->next = NULL;
+            arena->initialBlock->size = 0;
+        }
+        arena->last = NULL;
+    }
+
+PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
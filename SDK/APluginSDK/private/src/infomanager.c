@@ -5,13 +5,15 @@
 #endif
 
 #include <stdlib.h>
-
-#ifndef ACUTILS_ONE_SOURCE
-#   define ACUTILS_ONE_SOURCE
-#endif
-#include "../../libs/ACUtils/include/ACUtils/adynarray.h"
+#include <string.h>
 
 #include "../privateplugininfos.h"
+#include "../atomic.h"
+#include "arena.c"
+#include "perfecthash.c"
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+#   include "signature.c"
+#endif
 
 #ifdef __cplusplus
 #   define PRIVATE_APLUGINSDK_STRUCT_NO_EXPORT APLUGINSDK_NO_EXPORT
@@ -19,21 +21,87 @@
 #   define PRIVATE_APLUGINSDK_STRUCT_NO_EXPORT
 #endif
 
+/* Size in bytes of the static first block of the metadata arena. Further blocks are allocated on the heap if it is full.
+ * With section registration the feature and class infos are constant and only the plugin name is stored in it. */
+#ifndef APLUGINSDK_ARENA_SIZE
+#   if PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+#       define APLUGINSDK_ARENA_SIZE 128
+#   else
+#       define APLUGINSDK_ARENA_SIZE 4096
+#   endif
+#endif
+
 PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
 
-    A_DYNAMIC_ARRAY_DEFINITION(PRIVATE_APLUGINSDK_STRUCT_NO_EXPORT private_APluginSDK_APluginFeatureInfo_DynArray, struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo*);
-    A_DYNAMIC_ARRAY_DEFINITION(PRIVATE_APLUGINSDK_STRUCT_NO_EXPORT private_APluginSDK_APluginClassInfo_DynArray, struct APLUGINLIBRARY_NAMESPACE APluginClassInfo*);
+    static union private_APluginSDK_ArenaAlignment private_APluginSDK_arenaBlock[
+        (APLUGINSDK_ARENA_SIZE + sizeof(union private_APluginSDK_ArenaAlignment) - 1) / sizeof(union private_APluginSDK_ArenaAlignment)];
+    static char private_APluginSDK_emptyPluginName[1] = {'\0'};
+
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+    /* Feature and class infos are stored by value in chunks of growing capacity (the records of a chunk are contiguous
+     * and never move, so the pointer arrays handed out by getFeatureInfos/getClassInfos stay valid). The records follow
+     * the chunk header, which is a multiple of the pointer alignment. Chunks are allocated in the arena. */
+    struct PRIVATE_APLUGINSDK_STRUCT_NO_EXPORT private_APluginSDK_RecordChunk {
+        struct private_APluginSDK_RecordChunk *next;
+        size_t capacity, size;
+    };
+    static void* private_APluginSDK_allocateRecord(struct private_APluginSDK_Arena *arena,
+                                                   struct private_APluginSDK_RecordChunk **chunks, size_t recordSize)
+    {
+        struct private_APluginSDK_RecordChunk *chunk = *chunks;
+        if(chunk == NULL || chunk->size == chunk->capacity) {
+            size_t capacity = chunk == NULL ? 16 : chunk->capacity * 2;
+            chunk = (struct private_APluginSDK_RecordChunk*) private_APluginSDK_arenaAllocate(
+                    arena, sizeof(struct private_APluginSDK_RecordChunk) + capacity * recordSize);
+            if(chunk == NULL)
+                return NULL;
+            chunk->next = *chunks;
+            chunk->capacity = capacity;
+            chunk->size = 0;
+            *chunks = chunk;
+        }
+        return (char*) (chunk + 1) + recordSize * chunk->size++;
+    }
+
+    /* array of the info pointers handed out by getFeatureInfos/getClassInfos, grown in the arena */
+    struct PRIVATE_APLUGINSDK_STRUCT_NO_EXPORT private_APluginSDK_InfoPointers {
+        void **pointers;
+        size_t size, capacity;
+    };
+    static bool private_APluginSDK_appendInfoPointer(struct private_APluginSDK_Arena *arena,
+                                                     struct private_APluginSDK_InfoPointers *array, void *pointer)
+    {
+        if(array->size == array->capacity) {
+            size_t capacity = array->capacity == 0 ? 16 : array->capacity * 2;
+            void **pointers = (void**) private_APluginSDK_arenaGrow(arena, array->pointers, array->capacity * sizeof(void*),
+                                                                    capacity * sizeof(void*));
+            if(pointers == NULL)
+                return false;
+            array->pointers = pointers;
+            array->capacity = capacity;
+        }
+        array->pointers[array->size++] = pointer;
+        return true;
+    }
+#endif
 
     struct private_APluginSDK_InfoManager;
     static void private_APluginSDK_releaseInfoManager(struct private_APluginSDK_InfoManager*);
     static struct private_APluginSDK_InfoManager* private_APluginSDK_initInfoManager(struct private_APluginSDK_InfoManager*);
     static struct APLUGINLIBRARY_NAMESPACE APluginInfo* private_APluginSDK_constructPluginInfo(void);
     static void private_APluginSDK_destructPluginInfo(struct APLUGINLIBRARY_NAMESPACE APluginInfo*);
+    static void private_APluginSDK_buildLookupTables(void);
+    static void private_APluginSDK_freeLookupTables(void);
 
+    /* All metadata allocated while the plugin is loaded (name, records, pointer arrays) lives in the arena and is freed
+     * at once when the InfoManager is released. */
     struct PRIVATE_APLUGINSDK_STRUCT_NO_EXPORT private_APluginSDK_InfoManager {
         struct APLUGINLIBRARY_NAMESPACE APluginInfo *pluginInfo;
-        struct private_APluginSDK_APluginFeatureInfo_DynArray *featureInfos;
-        struct private_APluginSDK_APluginClassInfo_DynArray *classInfos;
+        struct private_APluginSDK_Arena arena;
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+        struct private_APluginSDK_InfoPointers featureInfos, classInfos, variantInfos;
+        struct private_APluginSDK_RecordChunk *featureRecords, *classRecords, *variantRecords;
+#endif
 
 #ifdef __cplusplus
         private_APluginSDK_InfoManager() {
@@ -47,69 +115,147 @@ PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
 
     static void private_APluginSDK_releaseInfoManager(struct private_APluginSDK_InfoManager *infoManager)
     {
-        size_t i;
-        if(infoManager == NULL)
-            return;
         private_APluginSDK_destructPluginInfo(infoManager->pluginInfo);
-        for(i = 0; i < ADynArray_size(infoManager->featureInfos); ++i)
-            free(ADynArray_get(infoManager->featureInfos, i));
-        ADynArray_destruct(infoManager->featureInfos);
-        for(i = 0; i < ADynArray_size(infoManager->classInfos); ++i)
-            free(ADynArray_get(infoManager->classInfos, i));
-        ADynArray_destruct(infoManager->classInfos);
-    }
-    static void private_APluginSDK_destructInfoManager(struct private_APluginSDK_InfoManager *infoManager)
-    {
-        private_APluginSDK_releaseInfoManager(infoManager);
-        free(infoManager);
+        private_APluginSDK_releaseArena(&infoManager->arena);
     }
     static struct private_APluginSDK_InfoManager* private_APluginSDK_initInfoManager(
             struct private_APluginSDK_InfoManager *infoManager)
     {
-        if(infoManager == NULL)
-            infoManager = (struct private_APluginSDK_InfoManager*) malloc(sizeof(struct private_APluginSDK_InfoManager));
-        if(infoManager != NULL) {
-            infoManager->pluginInfo = private_APluginSDK_constructPluginInfo();
-            infoManager->featureInfos = ADynArray_construct(struct private_APluginSDK_APluginFeatureInfo_DynArray);
-            infoManager->classInfos = ADynArray_construct(struct private_APluginSDK_APluginClassInfo_DynArray);
-            if(infoManager->pluginInfo == NULL
-               || infoManager->featureInfos == NULL
-               || infoManager->classInfos == NULL)
-            {
-                private_APluginSDK_destructInfoManager(infoManager);
-                return NULL;
-            }
-        }
+        private_APluginSDK_initArena(&infoManager->arena, private_APluginSDK_arenaBlock, sizeof(private_APluginSDK_arenaBlock));
+        infoManager->pluginInfo = private_APluginSDK_constructPluginInfo();
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+        infoManager->featureInfos.pointers = infoManager->classInfos.pointers = infoManager->variantInfos.pointers = NULL;
+        infoManager->featureInfos.size = infoManager->featureInfos.capacity = 0;
+        infoManager->classInfos.size = infoManager->classInfos.capacity = 0;
+        infoManager->variantInfos.size = infoManager->variantInfos.capacity = 0;
+        infoManager->featureRecords = infoManager->classRecords = infoManager->variantRecords = NULL;
+#endif
         return infoManager;
     }
-    static struct private_APluginSDK_InfoManager* private_APluginSDK_constructInfoManager(void)
+
+    static struct private_APluginSDK_InfoManager* private_APluginSDK_getInfoManagerInstance(void);
+    static size_t private_APluginSDK_constructPluginInternals(void(*initPlugin)(void));
+    static size_t private_APluginSDK_destructPluginInternals(void(*finiPlugin)(void));
+    static size_t private_APluginSDK_getFeatureCount(void);
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* private_APluginSDK_getFeatureInfo(size_t index);
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const* private_APluginSDK_getFeatureInfos(void);
+    static size_t private_APluginSDK_getClassCount(void);
+    static const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* private_APluginSDK_getClassInfo(size_t index);
+    static const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const* private_APluginSDK_getClassInfos(void);
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* private_APluginSDK_findFeature(const char *featureGroup,
+                                                                                                    const char *featureName);
+    static size_t private_APluginSDK_getFeatureVariantCount(void);
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant* const* private_APluginSDK_getFeatureVariants(void);
+    static const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* private_APluginSDK_findClass(const char *interfaceName,
+                                                                                                const char *className);
+
+    /* The plugin info is initialized statically, so the host can read it and construct the plugin (from any thread)
+     * before the plugin is initialized. Only the name and version are set by the InfoManager. */
+    static struct APrivatePluginInfo private_APluginSDK_privateInfo = {
+        private_APluginSDK_constructPluginInternals, private_APluginSDK_destructPluginInternals
+    };
+    struct APLUGINLIBRARY_NAMESPACE APluginInfo private_APluginSDK_pluginInfo = {
+        &private_APluginSDK_privateInfo,
+        APLUGINSDK_API_VERSION_MAJOR, APLUGINSDK_API_VERSION_MINOR, APLUGINSDK_API_VERSION_PATCH,
+        APLUGINLIBRARY_NAMESPACE APluginSDK_malloc, APLUGINLIBRARY_NAMESPACE APluginSDK_free,
+        PRIVATE_APLUGINSDK_PLUGIN_LANGUAGE, NULL, 0, 0, 0,
+        private_APluginSDK_getFeatureCount, private_APluginSDK_getFeatureInfo, private_APluginSDK_getFeatureInfos,
+        private_APluginSDK_getClassCount, private_APluginSDK_getClassInfo, private_APluginSDK_getClassInfos,
+        sizeof(struct APLUGINLIBRARY_NAMESPACE APluginInfo), private_APluginSDK_findFeature, private_APluginSDK_findClass,
+        private_APluginSDK_getFeatureVariantCount, private_APluginSDK_getFeatureVariants
+    };
+
+#ifndef __cplusplus
+    static APluginNameHash private_APluginSDK_hashName(const char *name)
     {
-        return private_APluginSDK_initInfoManager(NULL);
+        const APluginNameHash prime = ((APluginNameHash) 0x100UL << 32) | 0x1b3UL;
+        APluginNameHash hash = ((APluginNameHash) 0xcbf29ce4UL << 32) | 0x84222325UL;
+        for(; *name != '\0'; ++name)
+            hash = (hash ^ (unsigned char) *name) * prime;
+        return hash;
     }
+#endif
+
+#if PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+    /* bounds of the linker sections with the feature and class infos (null if the plugin has none) */
+    extern const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const private_APluginSDK_featuresBegin[]
+        __asm__("__start_apluginsdk_features") __attribute__((weak, visibility("hidden")));
+    extern const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const private_APluginSDK_featuresEnd[]
+        __asm__("__stop_apluginsdk_features") __attribute__((weak, visibility("hidden")));
+    extern const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const private_APluginSDK_classesBegin[]
+        __asm__("__start_apluginsdk_classes") __attribute__((weak, visibility("hidden")));
+    extern const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const private_APluginSDK_classesEnd[]
+        __asm__("__stop_apluginsdk_classes") __attribute__((weak, visibility("hidden")));
+    extern const struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant* const private_APluginSDK_variantsBegin[]
+        __asm__("__start_apluginsdk_variants") __attribute__((weak, visibility("hidden")));
+    extern const struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant* const private_APluginSDK_variantsEnd[]
+        __asm__("__stop_apluginsdk_variants") __attribute__((weak, visibility("hidden")));
+#endif
 
 #ifndef __cplusplus
-    static struct private_APluginSDK_InfoManager *private_APluginSDK_infoManagerInstance = NULL;
+    static struct private_APluginSDK_InfoManager private_APluginSDK_infoManager;
+    static bool private_APluginSDK_infoManagerInitialized = false;
 #endif
+
+    /* The reference count is changed atomically and the plugin is initialized and finalized behind a latch: only the
+     * thread which takes the count from 0 to 1 initializes the plugin (idle -> busy -> ready) and only the thread which
+     * takes it from 1 to 0 finalizes it (ready -> busy -> idle). Threads which find the latch busy (or the count 0 but
+     * the latch not idle) spin until it is released, so the host can load and unload plugins from several threads. */
+#define PRIVATE_APLUGINSDK_LATCH_IDLE 0
+#define PRIVATE_APLUGINSDK_LATCH_BUSY 1
+#define PRIVATE_APLUGINSDK_LATCH_READY 2
     static size_t private_APluginSDK_pluginRefCount = 0;
+    static size_t private_APluginSDK_pluginLatch = PRIVATE_APLUGINSDK_LATCH_IDLE;
 
     static size_t private_APluginSDK_constructPluginInternals(void(*initPlugin)(void))
     {
-        if(private_APluginSDK_pluginRefCount++ == 0 && initPlugin != NULL)
-            initPlugin();
-        return private_APluginSDK_pluginRefCount;
+        size_t refCount;
+        for(;;) {
+            refCount = PRIVATE_APLUGINSDK_ATOMIC_LOAD(&private_APluginSDK_pluginRefCount);
+            if(refCount != 0) {
+                if(PRIVATE_APLUGINSDK_ATOMIC_COMPARE_EXCHANGE(&private_APluginSDK_pluginRefCount, refCount, refCount + 1))
+                    return refCount + 1;
+            } else if(PRIVATE_APLUGINSDK_ATOMIC_COMPARE_EXCHANGE(&private_APluginSDK_pluginLatch,
+                                                                 PRIVATE_APLUGINSDK_LATCH_IDLE, PRIVATE_APLUGINSDK_LATCH_BUSY)) {
+                (void) private_APluginSDK_getInfoManagerInstance(); /* sets the name and version */
+                if(initPlugin != NULL)
+                    initPlugin();
+                private_APluginSDK_buildLookupTables();
+                PRIVATE_APLUGINSDK_ATOMIC_STORE(&private_APluginSDK_pluginRefCount, 1);
+                PRIVATE_APLUGINSDK_ATOMIC_STORE(&private_APluginSDK_pluginLatch, PRIVATE_APLUGINSDK_LATCH_READY);
+                return 1;
+            } else {
+                PRIVATE_APLUGINSDK_YIELD(); /* initialized or finalized by another thread */
+            }
+        }
     }
     static size_t private_APluginSDK_destructPluginInternals(void(*finiPlugin)(void))
     {
-        if(--private_APluginSDK_pluginRefCount == 0) {
-            if(finiPlugin != NULL)
-                finiPlugin();
+        size_t refCount;
+        do {
+            refCount = PRIVATE_APLUGINSDK_ATOMIC_LOAD(&private_APluginSDK_pluginRefCount);
+            if(refCount == 0)
+                return 0;
+        } while(!PRIVATE_APLUGINSDK_ATOMIC_COMPARE_EXCHANGE(&private_APluginSDK_pluginRefCount, refCount, refCount - 1));
+        if(refCount != 1)
+            return refCount - 1;
+        /* the initializing thread may not have released the latch yet */
+        while(!PRIVATE_APLUGINSDK_ATOMIC_COMPARE_EXCHANGE(&private_APluginSDK_pluginLatch,
+                                                          PRIVATE_APLUGINSDK_LATCH_READY, PRIVATE_APLUGINSDK_LATCH_BUSY))
+            PRIVATE_APLUGINSDK_YIELD();
+        if(finiPlugin != NULL)
+            finiPlugin();
+        private_APluginSDK_freeLookupTables();
 #ifndef __cplusplus
-            private_APluginSDK_destructInfoManager(private_APluginSDK_infoManagerInstance);
-            private_APluginSDK_infoManagerInstance = NULL;
+        private_APluginSDK_releaseInfoManager(&private_APluginSDK_infoManager);
+        private_APluginSDK_infoManagerInitialized = false;
 #endif
-        }
-        return private_APluginSDK_pluginRefCount;
+        PRIVATE_APLUGINSDK_ATOMIC_STORE(&private_APluginSDK_pluginLatch, PRIVATE_APLUGINSDK_LATCH_IDLE);
+        return 0;
     }
+#undef PRIVATE_APLUGINSDK_LATCH_IDLE
+#undef PRIVATE_APLUGINSDK_LATCH_BUSY
+#undef PRIVATE_APLUGINSDK_LATCH_READY
 
     static struct private_APluginSDK_InfoManager* private_APluginSDK_getInfoManagerInstance(void)
     {
@@ -117,9 +263,11 @@ PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
         static struct private_APluginSDK_InfoManager infoManager;
         return &infoManager;
 #else
-        if(private_APluginSDK_infoManagerInstance == NULL)
-            private_APluginSDK_infoManagerInstance = private_APluginSDK_constructInfoManager();
-        return private_APluginSDK_infoManagerInstance;
+        if(!private_APluginSDK_infoManagerInitialized) {
+            private_APluginSDK_initInfoManager(&private_APluginSDK_infoManager);
+            private_APluginSDK_infoManagerInitialized = true;
+        }
+        return &private_APluginSDK_infoManager;
 #endif
     }
 
@@ -141,28 +289,26 @@ PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
 
     const struct APLUGINLIBRARY_NAMESPACE APluginInfo* private_APluginSDK_getPluginInfo(void)
     {
-        struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
-        if(infoManager == NULL)
-            return NULL;
-        return infoManager->pluginInfo;
+        return &private_APluginSDK_pluginInfo;
     }
 
     bool private_APluginSDK_setPluginName(const char *name)
     {
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
         size_t nameLength = strlen(name);
+        char *pluginName;
         if(infoManager == NULL)
             return false;
-        free(infoManager->pluginInfo->pluginName);
         if(nameLength >= 2 && name[0] == '"' && name[nameLength - 1] == '"') {
-            infoManager->pluginInfo->pluginName = (char*) malloc(sizeof(char) * (nameLength - 1));
-            memcpy(infoManager->pluginInfo->pluginName, name + 1, sizeof(char) * (nameLength - 2));
-            infoManager->pluginInfo->pluginName[nameLength - 2] = '\0';
-        } else {
-            infoManager->pluginInfo->pluginName = (char*) malloc(sizeof(char) * nameLength + 1);
-            memcpy(infoManager->pluginInfo->pluginName, name, sizeof(char) * nameLength);
-            infoManager->pluginInfo->pluginName[nameLength] = '\0';
+            name += 1;
+            nameLength -= 2;
         }
+        pluginName = (char*) private_APluginSDK_arenaAllocate(&infoManager->arena, sizeof(char) * (nameLength + 1));
+        if(pluginName == NULL)
+            return false;
+        memcpy(pluginName, name, sizeof(char) * nameLength);
+        pluginName[nameLength] = '\0';
+        infoManager->pluginInfo->pluginName = pluginName;
         return true;
     }
     bool private_APluginSDK_setPluginVersion(size_t major, size_t minor, size_t patch)
@@ -176,14 +322,17 @@ PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
         return true;
     }
 
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
     bool private_APluginSDK_registerFeature(const char* featureGroup, const char* featureName, const char* returnType,
-                                            const char* parameterList, void* functionPtr)
+                                            const char* parameterList, void* functionPtr,
+                                            APLUGINLIBRARY_NAMESPACE APluginNameHash signatureHash)
     {
         struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* info;
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
         if(infoManager == NULL)
             return false;
-        info = (struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo*) malloc(sizeof(struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo));
+        info = (struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo*) private_APluginSDK_allocateRecord(
+                &infoManager->arena, &infoManager->featureRecords, sizeof(struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo));
         if(info != NULL) {
             info->pluginInfo = infoManager->pluginInfo;
             info->featureGroup = featureGroup;
@@ -191,18 +340,45 @@ PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
             info->returnType = returnType;
             info->parameterList = parameterList;
             info->functionPointer = functionPtr;
-            ADynArray_append(infoManager->featureInfos, info);
+            info->structSize = sizeof(struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo);
+            info->featureGroupHash = private_APluginSDK_hashName(featureGroup);
+            info->featureNameHash = private_APluginSDK_hashName(featureName);
+            /* C plugins (and C++ types which aren't named) fall back to the stringified types */
+            info->signatureHash = signatureHash != 0 ? signatureHash : private_APluginSDK_hashSignature(returnType, parameterList);
         }
-        return info != NULL;
+        return info != NULL && private_APluginSDK_appendInfoPointer(&infoManager->arena, &infoManager->featureInfos, info);
+    }
+    bool private_APluginSDK_registerFeatureVariant(const char* featureGroup, const char* featureName,
+                                                   unsigned long instructionSets, void* functionPtr)
+    {
+        struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant* variant;
+        struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
+        if(infoManager == NULL)
+            return false;
+        variant = (struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant*) private_APluginSDK_allocateRecord(
+                &infoManager->arena, &infoManager->variantRecords, sizeof(struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant));
+        if(variant == NULL)
+            return false;
+        variant->featureGroup = featureGroup;
+        variant->featureName = featureName;
+        variant->instructionSets = instructionSets;
+        variant->functionPointer = functionPtr;
+        variant->featureGroupHash = private_APluginSDK_hashName(featureGroup);
+        variant->featureNameHash = private_APluginSDK_hashName(featureName);
+        return private_APluginSDK_appendInfoPointer(&infoManager->arena, &infoManager->variantInfos, variant);
     }
     bool private_APluginSDK_registerClass(const char* interfaceClassName, const char* featureClassName,
-                                          void* createInstance, void* deleteInstance)
+                                          void* createInstance, void* deleteInstance,
+                                          size_t instanceSize, size_t instanceAlignment,
+                                          void* constructAt, void* destroyAt,
+                                          void* createInstances, void* deleteInstances)
     {
         struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* info;
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
         if(infoManager == NULL)
             return false;
-        info = (struct APLUGINLIBRARY_NAMESPACE APluginClassInfo*) malloc(sizeof(struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo));
+        info = (struct APLUGINLIBRARY_NAMESPACE APluginClassInfo*) private_APluginSDK_allocateRecord(
+                &infoManager->arena, &infoManager->classRecords, sizeof(struct APLUGINLIBRARY_NAMESPACE APluginClassInfo));
         if(info == NULL)
             return false;
         info->pluginInfo = infoManager->pluginInfo;
@@ -210,30 +386,79 @@ PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
         info->className = featureClassName;
         info->createInstance = createInstance;
         info->deleteInstance = deleteInstance;
-        ADynArray_append(infoManager->classInfos, info);
-        return true;
+        info->structSize = sizeof(struct APLUGINLIBRARY_NAMESPACE APluginClassInfo);
+        info->interfaceNameHash = private_APluginSDK_hashName(interfaceClassName);
+        info->classNameHash = private_APluginSDK_hashName(featureClassName);
+        info->instanceSize = instanceSize;
+        info->instanceAlignment = instanceAlignment;
+        info->constructAt = constructAt;
+        info->destroyAt = destroyAt;
+        info->createInstances = createInstances;
+        info->deleteInstances = deleteInstances;
+        return private_APluginSDK_appendInfoPointer(&infoManager->arena, &infoManager->classInfos, info);
+    }
+#endif
+
+#if PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+    static size_t private_APluginSDK_getFeatureCount(void)
+    {
+        return (size_t) (private_APluginSDK_featuresEnd - private_APluginSDK_featuresBegin);
+    }
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* private_APluginSDK_getFeatureInfo(size_t index)
+    {
+        if(index >= private_APluginSDK_getFeatureCount())
+            return NULL;
+        return private_APluginSDK_featuresBegin[index];
+    }
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const* private_APluginSDK_getFeatureInfos(void)
+    {
+        return private_APluginSDK_featuresBegin;
+    }
+
+    static size_t private_APluginSDK_getClassCount(void)
+    {
+        return (size_t) (private_APluginSDK_classesEnd - private_APluginSDK_classesBegin);
+    }
+    static const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* private_APluginSDK_getClassInfo(size_t index)
+    {
+        if(index >= private_APluginSDK_getClassCount())
+            return NULL;
+        return private_APluginSDK_classesBegin[index];
+    }
+    static const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const* private_APluginSDK_getClassInfos(void)
+    {
+        return private_APluginSDK_classesBegin;
     }
 
+    static size_t private_APluginSDK_getFeatureVariantCount(void)
+    {
+        return (size_t) (private_APluginSDK_variantsEnd - private_APluginSDK_variantsBegin);
+    }
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant* const* private_APluginSDK_getFeatureVariants(void)
+    {
+        return private_APluginSDK_variantsBegin;
+    }
+#else
     static size_t private_APluginSDK_getFeatureCount(void)
     {
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
         if(infoManager == NULL)
             return 0;
-        return ADynArray_size(infoManager->featureInfos);
+        return infoManager->featureInfos.size;
     }
     static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* private_APluginSDK_getFeatureInfo(size_t index)
     {
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
-        if(infoManager == NULL || index >= ADynArray_size(infoManager->featureInfos))
+        if(infoManager == NULL || index >= infoManager->featureInfos.size)
             return NULL;
-        return ADynArray_get(infoManager->featureInfos, index);
+        return (const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo*) infoManager->featureInfos.pointers[index];
     }
     static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const* private_APluginSDK_getFeatureInfos(void)
     {
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
-        if(infoManager == NULL || infoManager->featureInfos == NULL)
+        if(infoManager == NULL || infoManager->featureInfos.pointers == NULL)
             return NULL;
-        return (const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const*) infoManager->featureInfos->buffer;
+        return (const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const*) infoManager->featureInfos.pointers;
     }
 
     static size_t private_APluginSDK_getClassCount(void)
@@ -241,61 +466,140 @@ PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
         if(infoManager == NULL)
             return 0;
-        return ADynArray_size(infoManager->classInfos);
+        return infoManager->classInfos.size;
     }
     static const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* private_APluginSDK_getClassInfo(size_t index)
     {
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
-        if(infoManager == NULL || index >= ADynArray_size(infoManager->classInfos))
+        if(infoManager == NULL || index >= infoManager->classInfos.size)
             return NULL;
-        return ADynArray_get(infoManager->classInfos, index);
+        return (const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo*) infoManager->classInfos.pointers[index];
     }
     static const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const* private_APluginSDK_getClassInfos(void)
     {
         struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
-        if(infoManager == NULL || infoManager->classInfos == NULL)
+        if(infoManager == NULL || infoManager->classInfos.pointers == NULL)
             return NULL;
-        return (const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const*) infoManager->classInfos->buffer;
+        return (const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const*) infoManager->classInfos.pointers;
     }
 
-    static struct APrivatePluginInfo* private_APluginSDK_constructPrivatePluginInfo(void)
+    static size_t private_APluginSDK_getFeatureVariantCount(void)
     {
-        struct APrivatePluginInfo *info = (struct APrivatePluginInfo*) malloc(sizeof(struct APrivatePluginInfo));
-        info->constructPluginInternals = private_APluginSDK_constructPluginInternals;
-        info->destructPluginInternals = private_APluginSDK_destructPluginInternals;
-        return info;
+        struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
+        if(infoManager == NULL)
+            return 0;
+        return infoManager->variantInfos.size;
+    }
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant* const* private_APluginSDK_getFeatureVariants(void)
+    {
+        struct private_APluginSDK_InfoManager* infoManager = private_APluginSDK_getInfoManagerInstance();
+        if(infoManager == NULL || infoManager->variantInfos.pointers == NULL)
+            return NULL;
+        return (const struct APLUGINLIBRARY_NAMESPACE APluginFeatureVariant* const*) infoManager->variantInfos.pointers;
+    }
+#endif
+
+    /* perfect hash tables over the features and classes registered when the plugin was loaded */
+    static struct private_APluginSDK_PerfectHash private_APluginSDK_featureTable = {0, 0, NULL, NULL};
+    static struct private_APluginSDK_PerfectHash private_APluginSDK_classTable = {0, 0, NULL, NULL};
+
+    static void private_APluginSDK_buildLookupTables(void)
+    {
+        size_t i, featureCount = private_APluginSDK_getFeatureCount(), classCount = private_APluginSDK_getClassCount();
+        const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const* features = private_APluginSDK_getFeatureInfos();
+        const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const* classes = private_APluginSDK_getClassInfos();
+        APLUGINLIBRARY_NAMESPACE APluginNameHash *keys = (APLUGINLIBRARY_NAMESPACE APluginNameHash*)
+            malloc((featureCount > classCount ? featureCount : classCount) * sizeof(APLUGINLIBRARY_NAMESPACE APluginNameHash) + 1);
+        if(keys == NULL)
+            return;
+        for(i = 0; i < featureCount; ++i)
+            keys[i] = private_APluginSDK_combineHashes(features[i]->featureGroupHash, features[i]->featureNameHash);
+        private_APluginSDK_buildPerfectHash(&private_APluginSDK_featureTable, keys, featureCount);
+        for(i = 0; i < classCount; ++i)
+            keys[i] = private_APluginSDK_combineHashes(classes[i]->interfaceNameHash, classes[i]->classNameHash);
+        private_APluginSDK_buildPerfectHash(&private_APluginSDK_classTable, keys, classCount);
+        free(keys);
     }
-    static void private_APluginSDK_destructPrivatePluginInfo(struct APrivatePluginInfo *info)
+    static void private_APluginSDK_freeLookupTables(void)
     {
-        free(info);
+        private_APluginSDK_freePerfectHash(&private_APluginSDK_featureTable);
+        private_APluginSDK_freePerfectHash(&private_APluginSDK_classTable);
+    }
+
+    static bool private_APluginSDK_namesEqual(const char *name1, const char *name2)
+    {
+        return name1 != NULL && name2 != NULL && strcmp(name1, name2) == 0;
+    }
+    static bool private_APluginSDK_featureMatches(const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo *feature,
+                                                  APLUGINLIBRARY_NAMESPACE APluginNameHash groupHash,
+                                                  APLUGINLIBRARY_NAMESPACE APluginNameHash nameHash,
+                                                  const char *featureGroup, const char *featureName)
+    {
+        return feature->featureGroupHash == groupHash && feature->featureNameHash == nameHash
+            && private_APluginSDK_namesEqual(feature->featureGroup, featureGroup)
+            && private_APluginSDK_namesEqual(feature->featureName, featureName);
+    }
+    static bool private_APluginSDK_classMatches(const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo *classInfo,
+                                                APLUGINLIBRARY_NAMESPACE APluginNameHash interfaceHash,
+                                                APLUGINLIBRARY_NAMESPACE APluginNameHash nameHash,
+                                                const char *interfaceName, const char *className)
+    {
+        return classInfo->interfaceNameHash == interfaceHash && classInfo->classNameHash == nameHash
+            && private_APluginSDK_namesEqual(classInfo->interfaceName, interfaceName)
+            && private_APluginSDK_namesEqual(classInfo->className, className);
+    }
+    /* Features recorded after the table was built (or all if it couldn't be built) are searched linearly. */
+    static const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* private_APluginSDK_findFeature(const char *featureGroup,
+                                                                                                  const char *featureName)
+    {
+        APLUGINLIBRARY_NAMESPACE APluginNameHash groupHash, nameHash;
+        const struct APLUGINLIBRARY_NAMESPACE APluginFeatureInfo* const* features = private_APluginSDK_getFeatureInfos();
+        size_t i, featureCount = private_APluginSDK_getFeatureCount();
+        if(featureGroup == NULL || featureName == NULL)
+            return NULL;
+        groupHash = private_APluginSDK_hashName(featureGroup);
+        nameHash = private_APluginSDK_hashName(featureName);
+        i = private_APluginSDK_lookupPerfectHash(&private_APluginSDK_featureTable,
+                                                 private_APluginSDK_combineHashes(groupHash, nameHash));
+        if(i < featureCount && private_APluginSDK_featureMatches(features[i], groupHash, nameHash, featureGroup, featureName))
+            return features[i];
+        for(i = private_APluginSDK_featureTable.keyCount; i < featureCount; ++i) {
+            if(private_APluginSDK_featureMatches(features[i], groupHash, nameHash, featureGroup, featureName))
+                return features[i];
+        }
+        return NULL;
+    }
+    static const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* private_APluginSDK_findClass(const char *interfaceName,
+                                                                                              const char *className)
+    {
+        APLUGINLIBRARY_NAMESPACE APluginNameHash interfaceHash, nameHash;
+        const struct APLUGINLIBRARY_NAMESPACE APluginClassInfo* const* classes = private_APluginSDK_getClassInfos();
+        size_t i, classCount = private_APluginSDK_getClassCount();
+        if(interfaceName == NULL || className == NULL)
+            return NULL;
+        interfaceHash = private_APluginSDK_hashName(interfaceName);
+        nameHash = private_APluginSDK_hashName(className);
+        i = private_APluginSDK_lookupPerfectHash(&private_APluginSDK_classTable,
+                                                 private_APluginSDK_combineHashes(interfaceHash, nameHash));
+        if(i < classCount && private_APluginSDK_classMatches(classes[i], interfaceHash, nameHash, interfaceName, className))
+            return classes[i];
+        for(i = private_APluginSDK_classTable.keyCount; i < classCount; ++i) {
+            if(private_APluginSDK_classMatches(classes[i], interfaceHash, nameHash, interfaceName, className))
+                return classes[i];
+        }
+        return NULL;
     }
 
-static struct APLUGINLIBRARY_NAMESPACE APluginInfo* private_APluginSDK_constructPluginInfo(void)
+    static struct APLUGINLIBRARY_NAMESPACE APluginInfo* private_APluginSDK_constructPluginInfo(void)
     {
-        struct APLUGINLIBRARY_NAMESPACE APluginInfo* info = (struct APLUGINLIBRARY_NAMESPACE APluginInfo*) malloc(sizeof(struct APLUGINLIBRARY_NAMESPACE APluginInfo));
-        info->privateInfo = private_APluginSDK_constructPrivatePluginInfo();
-        info->apiVersionMajor = APLUGINSDK_API_VERSION_MAJOR;
-        info->apiVersionMinor = APLUGINSDK_API_VERSION_MINOR;
-        info->apiVersionPatch = APLUGINSDK_API_VERSION_PATCH;
-        info->allocateMemory = APLUGINLIBRARY_NAMESPACE APluginSDK_malloc;
-        info->freeMemory = APLUGINLIBRARY_NAMESPACE APluginSDK_free;
-        info->pluginLanguage = PRIVATE_APLUGINSDK_PLUGIN_LANGUAGE;
-        info->pluginName = (char*) malloc(sizeof(char));
-        info->pluginName[0] = '\0';
+        struct APLUGINLIBRARY_NAMESPACE APluginInfo* info = &private_APluginSDK_pluginInfo; /* referenced by the constant infos */
+        info->pluginName = private_APluginSDK_emptyPluginName;
         info->pluginVersionMajor = info->pluginVersionMinor = info->pluginVersionPatch = 0;
-        info->getFeatureCount = private_APluginSDK_getFeatureCount;
-        info->getFeatureInfo = private_APluginSDK_getFeatureInfo;
-        info->getFeatureInfos = private_APluginSDK_getFeatureInfos;
-        info->getClassCount = private_APluginSDK_getClassCount;
-        info->getClassInfo = private_APluginSDK_getClassInfo;
-        info->getClassInfos = private_APluginSDK_getClassInfos;
         return info;
     }
     static void private_APluginSDK_destructPluginInfo(struct APLUGINLIBRARY_NAMESPACE APluginInfo* info)
     {
-        private_APluginSDK_destructPrivatePluginInfo(info->privateInfo);
-        free(info->pluginName);
-        free(info);
+        info->pluginName = NULL; /* allocated in the arena */
     }
 
 PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
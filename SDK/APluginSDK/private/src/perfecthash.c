@@ -0,0 +1,148 @@
+#include "../perfecthash.h"
+
+#include <stdlib.h>
+
+PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
+
+    /* the highest displacement tried per bucket before the table is given up (e.g. for duplicate keys) */
+    static const size_t private_APluginSDK_maxDisplacement = 65536;
+
+    struct PRIVATE_APLUGINSDK_PERFECTHASH_NO_EXPORT private_APluginSDK_PerfectHashBucket {
+        size_t index, begin, size;
+    };
+
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_mixHash(APLUGINLIBRARY_NAMESPACE APluginNameHash x)
+    {
+        x ^= x >> 33;
+        x *= ((APLUGINLIBRARY_NAMESPACE APluginNameHash) 0xff51afd7UL << 32) | 0xed558ccdUL;
+        x ^= x >> 33;
+        x *= ((APLUGINLIBRARY_NAMESPACE APluginNameHash) 0xc4ceb9feUL << 32) | 0x1a85ec53UL;
+        x ^= x >> 33;
+        return x;
+    }
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_combineHashes(
+            APLUGINLIBRARY_NAMESPACE APluginNameHash hash1, APLUGINLIBRARY_NAMESPACE APluginNameHash hash2)
+    {
+        return private_APluginSDK_mixHash(hash1) ^ hash2;
+    }
+    static size_t private_APluginSDK_perfectHashBucket(const struct private_APluginSDK_PerfectHash *table,
+                                                       APLUGINLIBRARY_NAMESPACE APluginNameHash key)
+    {
+        return (size_t) (private_APluginSDK_mixHash(key) % table->bucketCount);
+    }
+    static size_t private_APluginSDK_perfectHashSlot(const struct private_APluginSDK_PerfectHash *table,
+                                                     APLUGINLIBRARY_NAMESPACE APluginNameHash key, size_t displacement)
+    {
+        const APLUGINLIBRARY_NAMESPACE APluginNameHash golden = ((APLUGINLIBRARY_NAMESPACE APluginNameHash) 0x9e3779b9UL << 32) | 0x7f4a7c15UL;
+        return (size_t) (private_APluginSDK_mixHash(key + golden * (displacement + 1)) % table->keyCount);
+    }
+    static int private_APluginSDK_compareBucketSizes(const void *bucket1, const void *bucket2)
+    {
+        size_t size1 = ((const struct private_APluginSDK_PerfectHashBucket*) bucket1)->size;
+        size_t size2 = ((const struct private_APluginSDK_PerfectHashBucket*) bucket2)->size;
+        return size1 < size2 ? 1 : (size1 > size2 ? -1 : 0);
+    }
+
+    /* Tries the displacements of bucket until all of its keys fall into free slots and takes these slots. */
+    static bool private_APluginSDK_placePerfectHashBucket(struct private_APluginSDK_PerfectHash *table,
+                                                          const APLUGINLIBRARY_NAMESPACE APluginNameHash *keys,
+                                                          const size_t *members,
+                                                          const struct private_APluginSDK_PerfectHashBucket *bucket,
+                                                          size_t *positions)
+    {
+        size_t displacement, i, j;
+        for(i = 1; i < bucket->size; ++i) {
+            for(j = 0; j < i; ++j) {
+                if(keys[members[bucket->begin + i]] == keys[members[bucket->begin + j]])
+                    return false; /* equal keys can't be separated */
+            }
+        }
+        for(displacement = 0; displacement < private_APluginSDK_maxDisplacement; ++displacement) {
+            for(i = 0; i < bucket->size; ++i) {
+                positions[i] = private_APluginSDK_perfectHashSlot(table, keys[members[bucket->begin + i]], displacement);
+                if(table->slots[positions[i]] != (size_t) -1)
+                    break;
+                for(j = 0; j < i && positions[j] != positions[i]; ++j);
+                if(j < i)
+                    break;
+            }
+            if(i == bucket->size) {
+                for(i = 0; i < bucket->size; ++i)
+                    table->slots[positions[i]] = members[bucket->begin + i];
+                table->displacements[bucket->index] = displacement;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Builds table over keys, the largest buckets are placed first while most slots are free. Returns false (and table
+     * maps nothing) if no table could be built. */
+    static bool private_APluginSDK_buildPerfectHash(struct private_APluginSDK_PerfectHash *table,
+                                                    const APLUGINLIBRARY_NAMESPACE APluginNameHash *keys, size_t keyCount)
+    {
+        struct private_APluginSDK_PerfectHashBucket *buckets;
+        size_t *members, *bucketOfKey, *positions, i, begin;
+        bool success = true;
+        table->keyCount = keyCount;
+        table->bucketCount = keyCount / 2 + 1;
+        table->displacements = (size_t*) calloc(table->bucketCount, sizeof(size_t));
+        table->slots = (size_t*) malloc((keyCount + 1) * sizeof(size_t));
+        buckets = (struct private_APluginSDK_PerfectHashBucket*) calloc(table->bucketCount, sizeof(struct private_APluginSDK_PerfectHashBucket));
+        members = (size_t*) malloc((keyCount + 1) * sizeof(size_t));
+        bucketOfKey = (size_t*) malloc((keyCount + 1) * sizeof(size_t));
+        positions = (size_t*) malloc((keyCount + 1) * sizeof(size_t));
+        if(keyCount == 0 || table->displacements == NULL || table->slots == NULL || buckets == NULL || members == NULL
+           || bucketOfKey == NULL || positions == NULL)
+        {
+            success = false;
+        } else {
+            /* group the keys by bucket (counting sort) */
+            for(i = 0; i < table->bucketCount; ++i)
+                buckets[i].index = i;
+            for(i = 0; i < keyCount; ++i) {
+                bucketOfKey[i] = private_APluginSDK_perfectHashBucket(table, keys[i]);
+                buckets[bucketOfKey[i]].size += 1;
+            }
+            for(i = 0, begin = 0; i < table->bucketCount; ++i) {
+                buckets[i].begin = begin;
+                begin += buckets[i].size;
+                buckets[i].size = 0;
+            }
+            for(i = 0; i < keyCount; ++i) {
+                struct private_APluginSDK_PerfectHashBucket *bucket = buckets + bucketOfKey[i];
+                members[bucket->begin + bucket->size++] = i;
+            }
+            qsort(buckets, table->bucketCount, sizeof(struct private_APluginSDK_PerfectHashBucket),
+                  private_APluginSDK_compareBucketSizes);
+            for(i = 0; i < keyCount; ++i)
+                table->slots[i] = (size_t) -1;
+            for(i = 0; i < table->bucketCount && buckets[i].size > 0 && success; ++i)
+                success = private_APluginSDK_placePerfectHashBucket(table, keys, members, buckets + i, positions);
+        }
+        free(buckets);
+        free(members);
+        free(bucketOfKey);
+        free(positions);
+        if(!success)
+            private_APluginSDK_freePerfectHash(table);
+        return success;
+    }
+    /* Returns the index of the key which could be key or (size_t) -1 if table maps nothing. */
+    static size_t private_APluginSDK_lookupPerfectHash(const struct private_APluginSDK_PerfectHash *table,
+                                                       APLUGINLIBRARY_NAMESPACE APluginNameHash key)
+    {
+        if(table->keyCount == 0)
+            return (size_t) -1;
+        return table->slots[private_APluginSDK_perfectHashSlot(table, key,
+            table->displacements[private_APluginSDK_perfectHashBucket(table, key)])];
+    }
+    static void private_APluginSDK_freePerfectHash(struct private_APluginSDK_PerfectHash *table)
+    {
+        free(table->displacements);
+        free(table->slots);
+        table->keyCount = table->bucketCount = 0;
+        table->displacements = table->slots = NULL;
+    }
+
+PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
@@ -0,0 +1,257 @@
+#include "../signature.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+#   define PRIVATE_APLUGINSDK_SIGNATURE_NO_EXPORT APLUGINSDK_NO_EXPORT
+#else
+#   define PRIVATE_APLUGINSDK_SIGNATURE_NO_EXPORT
+#endif
+
+PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
+
+    /* the most pointer levels of a declaration which are spelled in a signature */
+    #define PRIVATE_APLUGINSDK_SIGNATURE_MAX_LEVELS 16
+    #define PRIVATE_APLUGINSDK_SIGNATURE_CONST 1
+    #define PRIVATE_APLUGINSDK_SIGNATURE_VOLATILE 2
+
+    /* the type specifiers of a declaration (keywords are counted, other types are spelled by their name) */
+    struct PRIVATE_APLUGINSDK_SIGNATURE_NO_EXPORT private_APluginSDK_SignatureSpecifiers {
+        const char *name, *nameEnd;
+        unsigned int signedCount, unsignedCount, shortCount, longCount, intCount;
+        unsigned int charCount, floatCount, doubleCount, voidCount, boolCount;
+    };
+
+#ifndef __cplusplus
+    static const char* private_APluginSDK_integerName(size_t size, bool isSigned)
+    {
+        switch(size) {
+            case 1: return isSigned ? "i8" : "u8";
+            case 2: return isSigned ? "i16" : "u16";
+            case 4: return isSigned ? "i32" : "u32";
+            case 8: return isSigned ? "i64" : "u64";
+            default: return isSigned ? "i128" : "u128";
+        }
+    }
+#endif
+
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_appendSignatureRange(
+            APLUGINLIBRARY_NAMESPACE APluginNameHash hash, const char *begin, const char *end)
+    {
+        const APLUGINLIBRARY_NAMESPACE APluginNameHash prime = ((APLUGINLIBRARY_NAMESPACE APluginNameHash) 0x100UL << 32) | 0x1b3UL;
+        if(hash == 0)
+            return 0;
+        for(; begin != end; ++begin)
+            hash = (hash ^ (unsigned char) *begin) * prime;
+        return hash;
+    }
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_appendSignatureString(
+            APLUGINLIBRARY_NAMESPACE APluginNameHash hash, const char *string)
+    {
+        return private_APluginSDK_appendSignatureRange(hash, string, string + strlen(string));
+    }
+
+    static bool private_APluginSDK_isSignatureSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+    static bool private_APluginSDK_isSignatureWordCharacter(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+    static bool private_APluginSDK_signatureWordEquals(const char *begin, const char *end, const char *word)
+    {
+        size_t length = strlen(word);
+        return (size_t) (end - begin) == length && strncmp(begin, word, length) == 0;
+    }
+
+    /* counts the keyword [begin, end) and returns false if it is no type specifier */
+    static bool private_APluginSDK_countSignatureKeyword(struct private_APluginSDK_SignatureSpecifiers *specifiers,
+                                                         const char *begin, const char *end)
+    {
+        if(private_APluginSDK_signatureWordEquals(begin, end, "signed"))
+            ++specifiers->signedCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "unsigned"))
+            ++specifiers->unsignedCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "short"))
+            ++specifiers->shortCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "long"))
+            ++specifiers->longCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "int"))
+            ++specifiers->intCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "char"))
+            ++specifiers->charCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "float"))
+            ++specifiers->floatCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "double"))
+            ++specifiers->doubleCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "void"))
+            ++specifiers->voidCount;
+        else if(private_APluginSDK_signatureWordEquals(begin, end, "_Bool") || private_APluginSDK_signatureWordEquals(begin, end, "bool"))
+            ++specifiers->boolCount;
+        else
+            return false;
+        return true;
+    }
+
+    /* appends the spelling of a type name, the fixed size integer typedefs are spelled like the integers */
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_appendSignatureName(
+            APLUGINLIBRARY_NAMESPACE APluginNameHash hash, const char *begin, const char *end)
+    {
+        const char *digits = begin;
+        if(private_APluginSDK_signatureWordEquals(begin, end, "size_t"))
+            return private_APluginSDK_appendSignatureString(hash, private_APluginSDK_integerName(sizeof(size_t), false));
+        if(private_APluginSDK_signatureWordEquals(begin, end, "ptrdiff_t"))
+            return private_APluginSDK_appendSignatureString(hash, private_APluginSDK_integerName(sizeof(ptrdiff_t), true));
+        if(private_APluginSDK_signatureWordEquals(begin, end, "intptr_t") || private_APluginSDK_signatureWordEquals(begin, end, "uintptr_t"))
+            return private_APluginSDK_appendSignatureString(hash, private_APluginSDK_integerName(sizeof(void*), *begin == 'i'));
+        if(*digits == 'u')
+            ++digits;
+        if(end - digits > 5 && strncmp(digits, "int", 3) == 0 && strncmp(end - 2, "_t", 2) == 0) {
+            const char *digitsEnd = end - 2;
+            bool allDigits = true;
+            for(digits += 3; digits != digitsEnd && allDigits; ++digits)
+                allDigits = *digits >= '0' && *digits <= '9';
+            if(allDigits) /* int8_t ... uint64_t */
+                return private_APluginSDK_appendSignatureRange(private_APluginSDK_appendSignatureString(hash,
+                    *begin == 'u' ? "u" : "i"), *begin == 'u' ? begin + 4 : begin + 3, digitsEnd);
+        }
+        return private_APluginSDK_appendSignatureRange(hash, begin, end);
+    }
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_appendSignatureSpecifiers(
+            APLUGINLIBRARY_NAMESPACE APluginNameHash hash, const struct private_APluginSDK_SignatureSpecifiers *specifiers)
+    {
+        size_t size;
+        unsigned int keywordCount = specifiers->signedCount + specifiers->unsignedCount + specifiers->shortCount
+            + specifiers->longCount + specifiers->intCount + specifiers->charCount + specifiers->floatCount
+            + specifiers->doubleCount + specifiers->voidCount + specifiers->boolCount;
+        if(specifiers->name != NULL)
+            return keywordCount == 0 ? private_APluginSDK_appendSignatureName(hash, specifiers->name, specifiers->nameEnd) : 0;
+        if(keywordCount == 0)
+            return 0;
+        if(specifiers->voidCount != 0)
+            return keywordCount == 1 ? private_APluginSDK_appendSignatureString(hash, "void") : 0;
+        if(specifiers->boolCount != 0)
+            return keywordCount == 1 ? private_APluginSDK_appendSignatureString(hash, "bool") : 0;
+        if(specifiers->floatCount != 0)
+            return keywordCount == 1 ? private_APluginSDK_appendSignatureString(hash, "float") : 0;
+        if(specifiers->doubleCount != 0)
+            return keywordCount == 1 + specifiers->longCount && specifiers->longCount <= 1 ? private_APluginSDK_appendSignatureString(
+                hash, specifiers->longCount == 1 ? "long double" : "double") : 0;
+        if(specifiers->charCount != 0) {
+            if(keywordCount != 1 + specifiers->signedCount + specifiers->unsignedCount)
+                return 0;
+            if(specifiers->signedCount + specifiers->unsignedCount == 0)
+                return private_APluginSDK_appendSignatureString(hash, "char");
+            return private_APluginSDK_appendSignatureString(hash, specifiers->signedCount != 0 ? "i8" : "u8");
+        }
+        if(specifiers->shortCount != 0)
+            size = sizeof(short);
+        else if(specifiers->longCount >= 2)
+            size = 8; /* long long */
+        else if(specifiers->longCount == 1)
+            size = sizeof(long);
+        else
+            size = sizeof(int);
+        return private_APluginSDK_appendSignatureString(hash, private_APluginSDK_integerName(size, specifiers->unsignedCount == 0));
+    }
+
+    /* appends the spelling of the declaration [begin, end) (a type with an optional name), 0 if it isn't understood */
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_appendSignatureDeclaration(
+            APLUGINLIBRARY_NAMESPACE APluginNameHash hash, const char *begin, const char *end)
+    {
+        struct private_APluginSDK_SignatureSpecifiers specifiers;
+        unsigned char qualifiers[PRIVATE_APLUGINSDK_SIGNATURE_MAX_LEVELS + 1];
+        size_t levels = 0, level;
+        bool named = false;
+        memset(&specifiers, 0, sizeof(specifiers));
+        qualifiers[0] = 0;
+        while(begin != end && hash != 0) {
+            if(private_APluginSDK_isSignatureSpace(*begin)) {
+                ++begin;
+            } else if(*begin == '*' || *begin == '[') { /* arrays decay to pointers */
+                if(*begin == '[')
+                    begin = (const char*) memchr(begin, ']', (size_t) (end - begin));
+                if(begin == NULL || levels == PRIVATE_APLUGINSDK_SIGNATURE_MAX_LEVELS)
+                    return 0;
+                qualifiers[++levels] = 0;
+                ++begin;
+            } else if(private_APluginSDK_isSignatureWordCharacter(*begin)) {
+                const char *word = begin;
+                while(begin != end && private_APluginSDK_isSignatureWordCharacter(*begin))
+                    ++begin;
+                if(private_APluginSDK_signatureWordEquals(word, begin, "const")) {
+                    qualifiers[levels] |= PRIVATE_APLUGINSDK_SIGNATURE_CONST;
+                } else if(private_APluginSDK_signatureWordEquals(word, begin, "volatile")) {
+                    qualifiers[levels] |= PRIVATE_APLUGINSDK_SIGNATURE_VOLATILE;
+                } else if(private_APluginSDK_signatureWordEquals(word, begin, "struct")
+                          || private_APluginSDK_signatureWordEquals(word, begin, "union")
+                          || private_APluginSDK_signatureWordEquals(word, begin, "enum")
+                          || private_APluginSDK_signatureWordEquals(word, begin, "register")
+                          || private_APluginSDK_signatureWordEquals(word, begin, "restrict")) {
+                    continue;
+                } else if(named) {
+                    return 0;
+                } else if(private_APluginSDK_countSignatureKeyword(&specifiers, word, begin)) {
+                    if(specifiers.name != NULL || levels != 0)
+                        return 0;
+                } else if(specifiers.name == NULL && levels == 0 && specifiers.signedCount + specifiers.unsignedCount
+                          + specifiers.shortCount + specifiers.longCount + specifiers.intCount + specifiers.charCount
+                          + specifiers.floatCount + specifiers.doubleCount + specifiers.voidCount + specifiers.boolCount == 0) {
+                    specifiers.name = word;
+                    specifiers.nameEnd = begin;
+                } else {
+                    named = true; /* the parameter name */
+                }
+            } else {
+                return 0; /* e.g. function pointers or variadic parameters */
+            }
+        }
+        hash = private_APluginSDK_appendSignatureSpecifiers(hash, &specifiers);
+        for(level = 0; level < levels; ++level) { /* qualifiers of the declared object itself are dropped */
+            if(qualifiers[level] == (PRIVATE_APLUGINSDK_SIGNATURE_CONST | PRIVATE_APLUGINSDK_SIGNATURE_VOLATILE))
+                hash = private_APluginSDK_appendSignatureString(hash, " const volatile");
+            else if(qualifiers[level] == PRIVATE_APLUGINSDK_SIGNATURE_CONST)
+                hash = private_APluginSDK_appendSignatureString(hash, " const");
+            else if(qualifiers[level] == PRIVATE_APLUGINSDK_SIGNATURE_VOLATILE)
+                hash = private_APluginSDK_appendSignatureString(hash, " volatile");
+            hash = private_APluginSDK_appendSignatureString(hash, "*");
+        }
+        return hash;
+    }
+
+    static APLUGINLIBRARY_NAMESPACE APluginNameHash private_APluginSDK_hashSignature(const char *returnType,
+                                                                                       const char *parameterList)
+    {
+        APLUGINLIBRARY_NAMESPACE APluginNameHash hash = ((APLUGINLIBRARY_NAMESPACE APluginNameHash) 0xcbf29ce4UL << 32) | 0x84222325UL;
+        const char *parameter, *parameterEnd;
+        if(returnType == NULL || parameterList == NULL)
+            return 0;
+        hash = private_APluginSDK_appendSignatureDeclaration(hash, returnType, returnType + strlen(returnType));
+        hash = private_APluginSDK_appendSignatureString(hash, "(");
+        for(parameter = parameterList; private_APluginSDK_isSignatureSpace(*parameter); ++parameter);
+        parameterEnd = parameter + strlen(parameter);
+        while(parameterEnd != parameter && private_APluginSDK_isSignatureSpace(parameterEnd[-1]))
+            --parameterEnd;
+        if(parameter != parameterEnd && !private_APluginSDK_signatureWordEquals(parameter, parameterEnd, "void")) {
+            for(;;) {
+                const char *comma = (const char*) memchr(parameter, ',', (size_t) (parameterEnd - parameter));
+                if(comma == NULL)
+                    comma = parameterEnd;
+                hash = private_APluginSDK_appendSignatureDeclaration(hash, parameter, comma);
+                if(comma == parameterEnd)
+                    break;
+                hash = private_APluginSDK_appendSignatureString(hash, ",");
+                parameter = comma + 1;
+            }
+        }
+        return private_APluginSDK_appendSignatureString(hash, ")");
+    }
+
+    #undef PRIVATE_APLUGINSDK_SIGNATURE_MAX_LEVELS
+    #undef PRIVATE_APLUGINSDK_SIGNATURE_CONST
+    #undef PRIVATE_APLUGINSDK_SIGNATURE_VOLATILE
+    #undef PRIVATE_APLUGINSDK_SIGNATURE_NO_EXPORT
+
+PRIVATE_APLUGINSDK_CLOSE_PRIVATE_NAMESPACE
@@ -3,8 +3,12 @@
 
 #ifdef __cplusplus
 #   include <cstddef>
+#   include <stdint.h>
 #else
 #   include "stddef.h"
+#   if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#       include <stdint.h>
+#   endif
 #endif
 
 #include "../libs/ACUtils/include/ACUtils/types.h"
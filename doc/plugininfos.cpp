@@ -40,6 +40,43 @@
  * The (factory) method to create an instance of the class.
  * @var apl::PluginClassInfo::deleteInstance
  * The method to delete an instance of the class.
+ *
+ * @var apl::PluginClassInfo::instanceSize
+ * The size of an instance of the class (since api version 5.1).
+ * @var apl::PluginClassInfo::instanceAlignment
+ * The alignment of an instance of the class (since api version 5.1).
+ * @var apl::PluginClassInfo::constructAt
+ * The method to construct an instance in given storage (see apl::constructInstance()).
+ * @var apl::PluginClassInfo::destroyAt
+ * The method to destroy an instance without freeing its storage (see apl::destroyInstance()).
+ * @var apl::PluginClassInfo::createInstances
+ * The method to create multiple instances with one allocation (see apl::createInstances()).
+ * @var apl::PluginClassInfo::deleteInstances
+ * The method to delete instances created by createInstances (see apl::deleteInstances()).
+ */
+
+
+/**
+ * @struct apl::PluginFeatureVariant
+ *
+ * @brief For every instruction set specific implementation of a feature, a PluginFeatureVariant is generated (since api
+ * version 5.2).
+ *
+ * @var apl::PluginFeatureVariant::featureGroup
+ * The group of the feature.
+ * @var apl::PluginFeatureVariant::featureName
+ * The name of the feature.
+ *
+ * @var apl::PluginFeatureVariant::instructionSets
+ * The APLUGINSDK_ISA_* flags of the instruction sets required by this variant.
+ *
+ * @var apl::PluginFeatureVariant::functionPointer
+ * The pointer to the variant function (same signature as the feature).
+ *
+ * @var apl::PluginFeatureVariant::featureGroupHash
+ * The hash of the group of the feature.
+ * @var apl::PluginFeatureVariant::featureNameHash
+ * The hash of the name of the feature.
  */
 
 
@@ -83,4 +120,9 @@
  * Function pointer that returns the class at the passed index in this plugin.
  * @var apl::PluginInfo::getClassInfos
  * Function pointer that returns an array of all registered classes in this plugin.
+ *
+ * @var apl::PluginInfo::getFeatureVariantCount
+ * Function pointer that returns the number of registered feature variants in this plugin (since api version 5.2).
+ * @var apl::PluginInfo::getFeatureVariants
+ * Function pointer that returns an array of all registered feature variants in this plugin (since api version 5.2).
  */
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef APLUGINLIBRARY_PLUGIN_TPP
+#define APLUGINLIBRARY_PLUGIN_TPP
+
+/**
+ * Computes the signature of a feature with the function type @p Function at compile time, which can be compared with
+ * the signatureHash of a PluginFeatureInfo instead of parsing its return type and parameter list.\n
+ * Types which are not built in have to be named with A_PLUGIN_SIGNATURE_TYPE (in the plugin and the host).
+ *
+ * @tparam Function The function type of the feature (e.g. int(int, int)).
+ *
+ * @return The signature or 0 if it can't be computed (e.g. for unnamed types).
+ *
+ * @see Plugin::findFeature(const char*, const char*, APluginNameHash) const
+ */
+template<typename Function>
+inline constexpr apl::APluginNameHash apl::featureSignature()
+{
+    return sdk::detail::private_APluginSDK_signatureHash(static_cast<Function*>(nullptr));
+}
+
+/**
+ * Checks if the class of @p info can be constructed in storage of the host (plugins built with api version 5.1 or newer).
+ *
+ * @param info The class to check.
+ *
+ * @return True if constructInstance, destroyInstance, createInstances and deleteInstances can be used with @p info.
+ */
+inline bool apl::hasInstanceFunctions(const PluginClassInfo *info)
+{
+    return info != nullptr && info->pluginInfo != nullptr && info->pluginInfo->apiVersionMajor >= 5
+        && info->structSize >= offsetof(PluginClassInfo, deleteInstances) + sizeof(info->deleteInstances)
+        && info->constructAt != nullptr && info->destroyAt != nullptr
+        && info->createInstances != nullptr && info->deleteInstances != nullptr;
+}
+
+/**
+ * Constructs an instance of the class of @p info in @p memory, which must be at least PluginClassInfo::instanceSize
+ * bytes large and aligned to PluginClassInfo::instanceAlignment. The instance must be destroyed with destroyInstance.
+ *
+ * @tparam Interface The interface of the class.
+ *
+ * @param info The class of the instance.
+ * @param memory The storage of the instance.
+ *
+ * @return The instance or nullptr if the plugin can't construct instances in foreign storage.
+ *
+ * @see hasInstanceFunctions()
+ */
+template<typename Interface>
+inline Interface* apl::constructInstance(const PluginClassInfo *info, void *memory)
+{
+    if(memory == nullptr || !hasInstanceFunctions(info))
+        return nullptr;
+    return reinterpret_cast<Interface*(*)(void*)>(info->constructAt)(memory);
+}
+
+/**
+ * Destroys an instance constructed with constructInstance without freeing its storage.
+ *
+ * @tparam Interface The interface of the class.
+ *
+ * @param info The class of the instance.
+ * @param instance The instance to destroy.
+ */
+template<typename Interface>
+inline void apl::destroyInstance(const PluginClassInfo *info, Interface *instance)
+{
+    if(instance != nullptr && hasInstanceFunctions(info))
+        reinterpret_cast<void(*)(Interface*)>(info->destroyAt)(instance);
+}
+
+/**
+ * Creates @p count instances of the class of @p info with a single allocation in the plugin and one call across the
+ * plugin boundary. The instances must be deleted together with deleteInstances.
+ *
+ * @tparam Interface The interface of the class.
+ *
+ * @param info The class of the instances.
+ * @param count The number of instances to create.
+ * @param instances Array of at least @p count pointers, which receives the instances.
+ *
+ * @return @p count or 0 if no instances were created.
+ */
+template<typename Interface>
+inline size_t apl::createInstances(const PluginClassInfo *info, size_t count, Interface **instances)
+{
+    if(count == 0 || instances == nullptr || !hasInstanceFunctions(info))
+        return 0;
+    return reinterpret_cast<size_t(*)(size_t, Interface**)>(info->createInstances)(count, instances);
+}
+
+/**
+ * Deletes the instances created by one call of createInstances.
+ *
+ * @tparam Interface The interface of the class.
+ *
+ * @param info The class of the instances.
+ * @param instances The instances returned by createInstances.
+ * @param count The number of instances returned by createInstances.
+ */
+template<typename Interface>
+inline void apl::deleteInstances(const PluginClassInfo *info, Interface **instances, size_t count)
+{
+    if(count != 0 && instances != nullptr && hasInstanceFunctions(info))
+        reinterpret_cast<void(*)(Interface*)>(info->deleteInstances)(instances[0]);
+}
+
+#endif //APLUGINLIBRARY_PLUGIN_TPP
@@ -0,0 +1,77 @@
+#ifndef APLUGINLIBRARY_PLUGINID_TPP
+#define APLUGINLIBRARY_PLUGINID_TPP
+
+/**
+ * @class apl::detail::PluginIdentifier
+ *
+ * @brief A dense integer id with a generation counter, handed out by a PluginManager for its plugins, features and
+ * classes.
+ *
+ * The index is reused after the identified object is unloaded, but the generation is incremented each time, so a stale
+ * id never resolves to a different object. Use the typedefs apl::PluginId, apl::FeatureId and apl::ClassId.
+ */
+
+/**
+ * Constructs an invalid id.
+ */
+template<typename Tag>
+inline apl::detail::PluginIdentifier<Tag>::PluginIdentifier()
+    : index(UINT32_MAX), generation(0)
+{}
+/**
+ * Constructs an id with the given @p index and @p generation.
+ */
+template<typename Tag>
+inline apl::detail::PluginIdentifier<Tag>::PluginIdentifier(uint32_t index, uint32_t generation)
+    : index(index), generation(generation)
+{}
+
+/**
+ * @return The dense index of this id, which can be used to index into arrays (e.g. dispatch tables).
+ */
+template<typename Tag>
+inline uint32_t apl::detail::PluginIdentifier<Tag>::getIndex() const
+{
+    return index;
+}
+/**
+ * @return The generation of the slot at getIndex() when this id was handed out.
+ */
+template<typename Tag>
+inline uint32_t apl::detail::PluginIdentifier<Tag>::getGeneration() const
+{
+    return generation;
+}
+/**
+ * @return False if this id was default constructed (or returned because nothing was found), true otherwise. A valid id
+ * can still be stale.
+ */
+template<typename Tag>
+inline bool apl::detail::PluginIdentifier<Tag>::isValid() const
+{
+    return index != UINT32_MAX;
+}
+
+template<typename Tag>
+inline bool apl::detail::PluginIdentifier<Tag>::operator==(const PluginIdentifier &other) const
+{
+    return index == other.index && generation == other.generation;
+}
+template<typename Tag>
+inline bool apl::detail::PluginIdentifier<Tag>::operator!=(const PluginIdentifier &other) const
+{
+    return !(*this == other);
+}
+template<typename Tag>
+inline bool apl::detail::PluginIdentifier<Tag>::operator<(const PluginIdentifier &other) const
+{
+    return index < other.index || (index == other.index && generation < other.generation);
+}
+
+template<typename Tag>
+inline size_t std::hash<apl::detail::PluginIdentifier<Tag>>::operator()(const apl::detail::PluginIdentifier<Tag> &id) const
+{
+    return std::hash<uint64_t>()((static_cast<uint64_t>(id.getGeneration()) << 32u) | id.getIndex());
+}
+
+#endif //APLUGINLIBRARY_PLUGINID_TPP
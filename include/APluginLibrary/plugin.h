@@ -5,21 +5,39 @@
 
 #include <string>
 #include <memory>
+#include <cstddef>
 
 #include "APluginLibrary/libraryloader.h"
 #include "APluginSDK/plugininfos.h"
+#include "APluginSDK/private/signature.h"
 
 namespace apl
 {
     typedef APluginInfo PluginInfo;
     typedef APluginFeatureInfo PluginFeatureInfo;
     typedef APluginClassInfo PluginClassInfo;
+    typedef APluginFeatureVariant PluginFeatureVariant;
 
     namespace detail
     {
         class PluginPrivate;
     }
 
+    template<typename Function>
+    constexpr APluginNameHash featureSignature();
+
+    APLUGINLIBRARY_EXPORT unsigned long supportedInstructionSets();
+
+    bool hasInstanceFunctions(const PluginClassInfo *info);
+    template<typename Interface>
+    Interface* constructInstance(const PluginClassInfo *info, void *memory);
+    template<typename Interface>
+    void destroyInstance(const PluginClassInfo *info, Interface *instance);
+    template<typename Interface>
+    size_t createInstances(const PluginClassInfo *info, size_t count, Interface **instances);
+    template<typename Interface>
+    void deleteInstances(const PluginClassInfo *info, Interface **instances, size_t count);
+
     class APLUGINLIBRARY_EXPORT Plugin
     {
     public:
@@ -50,6 +68,14 @@ namespace apl
         const PluginClassInfo* getClassInfo(size_t index) const;
         const PluginClassInfo* const* getClassInfos() const;
 
+        const PluginFeatureInfo* findFeature(const char *featureGroup, const char *featureName) const;
+        const PluginFeatureInfo* findFeature(const char *featureGroup, const char *featureName, APluginNameHash signature) const;
+        const PluginClassInfo* findClass(const char *interfaceName, const char *className) const;
+
+        size_t getFeatureVariantCount() const;
+        const PluginFeatureVariant* const* getFeatureVariants() const;
+        void selectFeatureVariants(unsigned long instructionSets);
+
     private:
         Plugin(std::string path, library_handle handle);
 
@@ -57,5 +83,6 @@ namespace apl
     };
 }
 
+#include "implementation/plugin.tpp"
 
 #endif //APLUGINLIBRARY_PLUGIN_H
@@ -0,0 +1,53 @@
+#ifndef APLUGINLIBRARY_PLUGINID_H
+#define APLUGINLIBRARY_PLUGINID_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace apl
+{
+    namespace detail
+    {
+        template<typename Tag>
+        class PluginIdentifier
+        {
+        public:
+            inline PluginIdentifier();
+            inline PluginIdentifier(uint32_t index, uint32_t generation);
+
+            inline uint32_t getIndex() const;
+            inline uint32_t getGeneration() const;
+            inline bool isValid() const;
+
+            inline bool operator==(const PluginIdentifier &other) const;
+            inline bool operator!=(const PluginIdentifier &other) const;
+            inline bool operator<(const PluginIdentifier &other) const;
+
+        private:
+            uint32_t index;
+            uint32_t generation;
+        };
+
+        struct PluginIdTag;
+        struct FeatureIdTag;
+        struct ClassIdTag;
+    }
+
+    typedef detail::PluginIdentifier<detail::PluginIdTag> PluginId;
+    typedef detail::PluginIdentifier<detail::FeatureIdTag> FeatureId;
+    typedef detail::PluginIdentifier<detail::ClassIdTag> ClassId;
+}
+
+namespace std
+{
+    template<typename Tag>
+    struct hash<apl::detail::PluginIdentifier<Tag>>
+    {
+        inline size_t operator()(const apl::detail::PluginIdentifier<Tag> &id) const;
+    };
+}
+
+#include "implementation/pluginid.tpp"
+
+#endif //APLUGINLIBRARY_PLUGINID_H
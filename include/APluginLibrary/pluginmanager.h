@@ -4,8 +4,15 @@
 #include "APluginLibrary/apluginlibrary_export.h"
 
 #include <vector>
+#include <memory>
+#include <future>
+#include <chrono>
 
 #include "APluginLibrary/plugin.h"
+#include "APluginLibrary/pluginid.h"
+#include "APluginLibrary/pluginquery.h"
+#include "APluginLibrary/pluginmanifest.h"
+#include "APluginLibrary/pluginusageprofile.h"
 
 namespace apl
 {
@@ -33,6 +40,19 @@ namespace apl
         ClassName
     };
 
+    enum class PluginRetentionPolicy
+    {
+        Finalize,
+        DeferFinalization
+    };
+
+    enum class PluginLoadOrder
+    {
+        Path,
+        SmallestFirst,
+        Priority
+    };
+
     class PluginManagerObserver;
 
     class APLUGINLIBRARY_EXPORT PluginManager
@@ -47,29 +67,85 @@ namespace apl
         PluginManager& operator=(PluginManager&& other) noexcept;
 
         const Plugin* load(std::string path);
+        std::vector<const Plugin*> load(const std::vector<std::string> &paths);
+        std::vector<const Plugin*> load(const PluginManifest &manifest, const PluginQuery &query);
         std::vector<const Plugin*> loadDirectory(const std::string &path, bool recursive);
+        std::vector<const Plugin*> loadDirectory(const std::string &path, bool recursive, std::chrono::milliseconds budget,
+                                                 std::future<std::vector<const Plugin*>> &remaining,
+                                                 PluginLoadOrder order = PluginLoadOrder::Path,
+                                                 const std::vector<std::string> &priorities = std::vector<std::string>());
+
+        size_t index(const PluginManifest &manifest);
+        size_t indexDirectory(const std::string &path, bool recursive, const std::string &manifestFile = std::string());
+        size_t getIndexedPluginCount() const;
+
+        std::vector<const Plugin*> loadDirectory(const std::string &path, bool recursive, const PluginUsageProfile &profile,
+                                                 const std::string &manifestFile = std::string());
+        bool watchDirectory(const std::string &path, bool recursive, std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+        void unwatchDirectories();
+
+        void setUsageRecording(bool record);
+        bool isUsageRecording() const;
+        PluginUsageProfile getUsageProfile() const;
 
         size_t getLoadedPluginCount() const;
         const Plugin* getLoadedPlugin(const std::string &path) const;
         std::vector<const Plugin*> getLoadedPlugins() const;
+        uint64_t getGeneration() const;
 
         void unload(const Plugin *plugin);
         void unloadAll();
+        std::future<void> unloadAllAsync();
+        static bool waitForPendingUnloads(std::chrono::milliseconds timeout);
+
+        static void setRetentionCache(size_t maxPlugins, std::chrono::milliseconds maxAge = std::chrono::milliseconds::zero(),
+                                      PluginRetentionPolicy policy = PluginRetentionPolicy::DeferFinalization);
+        static void flushRetentionCache();
+        static size_t getRetainedPluginCount();
+        static void clearRejectedLibraries();
+        static size_t getRejectedLibraryCount();
 
         std::vector<const PluginInfo*> getPluginInfos() const;
         std::vector<const PluginInfo*> getPluginInfos(const std::string &string, PluginInfoFilter = PluginInfoFilter::PluginName) const;
+        std::vector<const PluginInfo*> getPluginInfos(const PluginQuery &query) const;
         std::vector<std::string> getPluginProperties(PluginInfoFilter filter) const;
 
         std::vector<const PluginFeatureInfo*> getFeatures() const;
         std::vector<const PluginFeatureInfo*> getFeatures(const std::string &string, PluginFeatureFilter filter = PluginFeatureFilter::FeatureGroup) const;
+        std::vector<const PluginFeatureInfo*> getFeatures(const std::string &pattern, PluginFeatureFilter filter, PluginStringMatch match) const;
+        std::vector<const PluginFeatureInfo*> getFeatures(const PluginQuery &query) const;
+        std::shared_ptr<const std::vector<const PluginFeatureInfo*>> getSharedFeatures(const std::string &string, PluginFeatureFilter filter = PluginFeatureFilter::FeatureGroup) const;
         std::vector<std::string> getFeatureProperties(PluginFeatureFilter filter) const;
 
         std::vector<const PluginClassInfo*> getClasses() const;
         std::vector<const PluginClassInfo*> getClasses(const std::string &string, PluginClassFilter filter = PluginClassFilter::InterfaceName) const;
+        std::vector<const PluginClassInfo*> getClasses(const std::string &pattern, PluginClassFilter filter, PluginStringMatch match) const;
+        std::vector<const PluginClassInfo*> getClasses(const PluginQuery &query) const;
+        std::shared_ptr<const std::vector<const PluginClassInfo*>> getSharedClasses(const std::string &string, PluginClassFilter filter = PluginClassFilter::InterfaceName) const;
         std::vector<std::string> getClassProperties(PluginClassFilter filter) const;
 
+        PluginId getPluginId(const Plugin *plugin) const;
+        const Plugin* plugin(PluginId id) const;
+        size_t getPluginIdCapacity() const;
+
+        FeatureId getFeatureId(const PluginFeatureInfo *info) const;
+        std::vector<FeatureId> getFeatureIds(const std::string &string, PluginFeatureFilter filter = PluginFeatureFilter::FeatureGroup) const;
+        std::vector<FeatureId> getFeatureIds(const PluginQuery &query) const;
+        const PluginFeatureInfo* feature(FeatureId id) const;
+        size_t getFeatureIdCapacity() const;
+
+        ClassId getClassId(const PluginClassInfo *info) const;
+        std::vector<ClassId> getClassIds(const std::string &string, PluginClassFilter filter = PluginClassFilter::InterfaceName) const;
+        std::vector<ClassId> getClassIds(const PluginQuery &query) const;
+        const PluginClassInfo* pluginClass(ClassId id) const;
+        size_t getClassIdCapacity() const;
+
         void addObserver(PluginManagerObserver *observer);
+        void addObserver(PluginManagerObserver *observer, const PluginQuery &filter);
         void removeObserver(PluginManagerObserver *observer);
+        void setAsyncObserverDispatch(bool async);
+        bool isAsyncObserverDispatch() const;
+        void flushObserverEvents();
 
     private:
         detail::PluginManagerPrivate* d_ptr;
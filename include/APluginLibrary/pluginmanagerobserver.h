@@ -5,6 +5,8 @@
 
 #include "APluginLibrary/pluginmanager.h"
 
+#include <vector>
+
 namespace apl
 {
     class APLUGINLIBRARY_EXPORT PluginManagerObserver
@@ -24,6 +26,20 @@ namespace apl
          * @param plugin  The Plugin which was loaded.
          */
         virtual void pluginUnloaded(PluginManager* pluginManager, const Plugin* plugin) = 0;
+        /**
+         * This function gets invoked once if multiple plugins are loaded at once from a PluginManager where this
+         * observer is registered. The default implementation calls pluginLoaded for every plugin.
+         * @param pluginManager The PluginManager where the plugins are loaded.
+         * @param plugins The Plugins which were loaded.
+         */
+        virtual void pluginsLoaded(PluginManager* pluginManager, const std::vector<const Plugin*>& plugins);
+        /**
+         * This function gets invoked once if multiple plugins are unloaded at once from a PluginManager where this
+         * observer is registered. The default implementation calls pluginUnloaded for every plugin.
+         * @param pluginManager The PluginManager where the plugins are unloaded.
+         * @param plugins The Plugins which were unloaded.
+         */
+        virtual void pluginsUnloaded(PluginManager* pluginManager, const std::vector<const Plugin*>& plugins);
     };
 }
 
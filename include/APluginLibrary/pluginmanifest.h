@@ -0,0 +1,54 @@
+#ifndef APLUGINLIBRARY_PLUGINMANIFEST_H
+#define APLUGINLIBRARY_PLUGINMANIFEST_H
+
+#include "APluginLibrary/apluginlibrary_export.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "APluginLibrary/plugin.h"
+#include "APluginLibrary/pluginquery.h"
+
+namespace apl
+{
+    namespace detail
+    {
+        class PluginManifestPrivate;
+    }
+
+    class APLUGINLIBRARY_EXPORT PluginManifest
+    {
+    public:
+        PluginManifest();
+        PluginManifest(const PluginManifest &other);
+        PluginManifest(PluginManifest &&other) noexcept;
+        ~PluginManifest();
+
+        PluginManifest& operator=(const PluginManifest &other);
+        PluginManifest& operator=(PluginManifest &&other) noexcept;
+
+        static PluginManifest open(const std::string &file);
+        bool save(const std::string &file) const;
+
+        size_t update(const std::string &directory, bool recursive);
+        size_t validate();
+        void clear();
+
+        size_t size() const;
+        bool contains(const std::string &path) const;
+        std::vector<std::string> getPaths() const;
+        std::vector<std::string> getPaths(const PluginQuery &query) const;
+
+        const PluginInfo* getPluginInfo(const std::string &path) const;
+        std::vector<const PluginFeatureInfo*> getFeatures(const std::string &path) const;
+        std::vector<const PluginClassInfo*> getClasses(const std::string &path) const;
+
+    private:
+        friend class detail::PluginManifestPrivate;
+
+        std::unique_ptr<detail::PluginManifestPrivate> d_ptr;
+    };
+}
+
+#endif //APLUGINLIBRARY_PLUGINMANIFEST_H
@@ -0,0 +1,85 @@
+#ifndef APLUGINLIBRARY_PLUGINQUERY_H
+#define APLUGINLIBRARY_PLUGINQUERY_H
+
+#include "APluginLibrary/apluginlibrary_export.h"
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "APluginLibrary/plugin.h"
+
+namespace apl
+{
+    namespace detail
+    {
+        class PluginQueryPrivate;
+    }
+
+    enum class PluginInfoFilter;
+    enum class PluginFeatureFilter;
+    enum class PluginClassFilter;
+
+    enum class PluginStringMatch
+    {
+        Equal,
+        Prefix,
+        Glob
+    };
+
+    struct APLUGINLIBRARY_EXPORT PluginVersion
+    {
+        PluginVersion();
+        PluginVersion(size_t versionMajor, size_t versionMinor, size_t versionPatch);
+
+        static PluginVersion pluginVersion(const PluginInfo *info);
+        static PluginVersion apiVersion(const PluginInfo *info);
+
+        bool operator==(const PluginVersion &other) const;
+        bool operator!=(const PluginVersion &other) const;
+        bool operator<(const PluginVersion &other) const;
+        bool operator<=(const PluginVersion &other) const;
+        bool operator>(const PluginVersion &other) const;
+        bool operator>=(const PluginVersion &other) const;
+
+        size_t versionMajor, versionMinor, versionPatch;
+    };
+
+    class APLUGINLIBRARY_EXPORT PluginQuery
+    {
+    public:
+        PluginQuery();
+        PluginQuery(const PluginQuery &other);
+        PluginQuery(PluginQuery &&other) noexcept;
+        ~PluginQuery();
+
+        PluginQuery& operator=(const PluginQuery &other);
+        PluginQuery& operator=(PluginQuery &&other) noexcept;
+
+        PluginQuery& where(PluginInfoFilter filter, std::string string, PluginStringMatch match = PluginStringMatch::Equal);
+        PluginQuery& where(PluginFeatureFilter filter, std::string string, PluginStringMatch match = PluginStringMatch::Equal);
+        PluginQuery& where(PluginClassFilter filter, std::string string, PluginStringMatch match = PluginStringMatch::Equal);
+
+        PluginQuery& wherePrefix(PluginInfoFilter filter, std::string prefix);
+        PluginQuery& wherePrefix(PluginFeatureFilter filter, std::string prefix);
+        PluginQuery& wherePrefix(PluginClassFilter filter, std::string prefix);
+
+        PluginQuery& whereGlob(PluginInfoFilter filter, std::string pattern);
+        PluginQuery& whereGlob(PluginFeatureFilter filter, std::string pattern);
+        PluginQuery& whereGlob(PluginClassFilter filter, std::string pattern);
+
+        PluginQuery& whereVersion(PluginInfoFilter filter, PluginVersion minimum,
+                                  PluginVersion maximum = PluginVersion(SIZE_MAX, SIZE_MAX, SIZE_MAX));
+
+        PluginQuery& prepare();
+        bool isPrepared() const;
+        bool isSatisfiable() const;
+
+    private:
+        friend class detail::PluginQueryPrivate;
+
+        std::unique_ptr<detail::PluginQueryPrivate> d_ptr;
+    };
+}
+
+#endif //APLUGINLIBRARY_PLUGINQUERY_H
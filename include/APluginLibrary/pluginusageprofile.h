@@ -0,0 +1,50 @@
+#ifndef APLUGINLIBRARY_PLUGINUSAGEPROFILE_H
+#define APLUGINLIBRARY_PLUGINUSAGEPROFILE_H
+
+#include "APluginLibrary/apluginlibrary_export.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+
+namespace apl
+{
+    namespace detail
+    {
+        class PluginUsageProfilePrivate;
+    }
+
+    class APLUGINLIBRARY_EXPORT PluginUsageProfile
+    {
+    public:
+        PluginUsageProfile();
+        PluginUsageProfile(const PluginUsageProfile &other);
+        PluginUsageProfile(PluginUsageProfile &&other) noexcept;
+        ~PluginUsageProfile();
+
+        PluginUsageProfile& operator=(const PluginUsageProfile &other);
+        PluginUsageProfile& operator=(PluginUsageProfile &&other) noexcept;
+
+        static PluginUsageProfile open(const std::string &file);
+        bool save(const std::string &file) const;
+
+        void record(const std::string &path, std::chrono::milliseconds time);
+        void record(const std::string &path, const std::string &feature, std::chrono::milliseconds time);
+        void merge(const PluginUsageProfile &other);
+        void clear();
+
+        size_t size() const;
+        bool contains(const std::string &path) const;
+        std::chrono::milliseconds getFirstUse(const std::string &path) const;
+        std::vector<std::string> getPlugins() const;
+        std::vector<std::string> getFeatures(const std::string &path) const;
+
+    private:
+        friend class detail::PluginUsageProfilePrivate;
+
+        std::unique_ptr<detail::PluginUsageProfilePrivate> d_ptr;
+    };
+}
+
+#endif //APLUGINLIBRARY_PLUGINUSAGEPROFILE_H
@@ -1,6 +1,7 @@
 #include "APluginLibrary/libraryloader.h"
 
 #include <utility>
+#include <mutex>
 
 #if defined(__unix__) || defined(__APPLE__)
 # include <dlfcn.h>
@@ -16,6 +17,18 @@
 
 std::string apl::LibraryLoader::errorString = std::string();
 
+namespace
+{
+    // libraries may be loaded from multiple threads at once (PluginManager::load(const std::vector<std::string>&))
+    std::mutex errorMutex;
+
+    void appendError(std::string &errorString, const char *error)
+    {
+        std::lock_guard<std::mutex> lockGuard(errorMutex);
+        errorString.append(error).append("\n");
+    }
+}
+
 /**
  * @return The file extension for shared libraries on this platform
  */
@@ -64,7 +77,7 @@ apl::library_handle apl::LibraryLoader::load(std::string path, const std::string
     library_handle handle = dlopen((path += suffix).c_str(), RTLD_LAZY);
     char* error = dlerror();
     if(error != nullptr)
-        errorString.append(error).append("\n");
+        appendError(errorString, error);
     if (!handle)
         return nullptr;
     return handle;
@@ -85,7 +98,7 @@ void* apl::LibraryLoader::getSymbol(library_handle handle, const std::string &na
     char* error;
     void* function = dlsym(handle, name.c_str());
     if ((error = dlerror()) != nullptr) {
-        errorString.append(error).append("\n");
+        appendError(errorString, error);
         return nullptr;
     }
     return function;
@@ -112,6 +125,7 @@ bool apl::LibraryLoader::unload(library_handle handle)
  */
 const char* apl::LibraryLoader::getError()
 {
+    std::lock_guard<std::mutex> lockGuard(errorMutex);
     if(errorString.empty())
         return nullptr;
     return errorString.c_str();
@@ -121,5 +135,6 @@ const char* apl::LibraryLoader::getError()
  */
 void apl::LibraryLoader::clearError()
 {
+    std::lock_guard<std::mutex> lockGuard(errorMutex);
     errorString.clear();
 }
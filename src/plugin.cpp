@@ -4,6 +4,18 @@
 #include "APluginSDK/pluginapi.h"
 #include "APluginSDK/private/privateplugininfos.h"
 
+#include <cstring>
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+# include <cpuid.h>
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+# include <intrin.h>
+#endif
+
 namespace
 {
     bool isValid(const apl::PluginInfo *info)
@@ -19,6 +31,85 @@ namespace
     {
         return info == nullptr || info->pluginLanguage == APLUGINLIBRARY_NAMESPACE APluginLanguage::C;
     }
+
+    /*
+     * Returns true if info has the name hashes (plugins built with api version 5 or newer), older plugins have shorter
+     * info structs.
+     */
+    template<typename Info>
+    bool hasNameHashes(const Info *info, size_t hashesEnd)
+    {
+        return info->pluginInfo != nullptr && info->pluginInfo->apiVersionMajor >= 5 && info->structSize >= hashesEnd;
+    }
+    /*
+     * Returns true if the plugin provides findFeature and findClass (built with api version 5 or newer).
+     */
+    bool hasLookupFunctions(const apl::PluginInfo *info)
+    {
+        return info->apiVersionMajor >= 5 && info->structSize >= offsetof(apl::PluginInfo, findClass) + sizeof(info->findClass)
+            && info->findFeature != nullptr && info->findClass != nullptr;
+    }
+    /*
+     * Returns true if the plugin provides feature variants (built with api version 5.2 or newer).
+     */
+    bool hasFeatureVariants(const apl::PluginInfo *info)
+    {
+        return info->apiVersionMajor >= 5
+            && info->structSize >= offsetof(apl::PluginInfo, getFeatureVariants) + sizeof(info->getFeatureVariants)
+            && info->getFeatureVariantCount != nullptr && info->getFeatureVariants != nullptr;
+    }
+
+    /*
+     * Detects the instruction set extensions of the cpu (and operating system for the AVX registers) with cpuid.
+     */
+    unsigned long detectInstructionSets()
+    {
+        unsigned long instructionSets = 0;
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+        unsigned int leaf1[4] = {0, 0, 0, 0}, leaf7[4] = {0, 0, 0, 0}, maxLeaf; // eax, ebx, ecx, edx
+        unsigned long long xcr0 = 0;
+# if defined(_MSC_VER) && !defined(__clang__)
+        int registers[4];
+        __cpuid(registers, 0);
+        maxLeaf = static_cast<unsigned int>(registers[0]);
+        __cpuid(reinterpret_cast<int*>(leaf1), 1);
+        if(maxLeaf >= 7)
+            __cpuidex(reinterpret_cast<int*>(leaf7), 7, 0);
+        if(leaf1[2] & (1u << 27u))
+            xcr0 = _xgetbv(0);
+# else
+        maxLeaf = __get_cpuid_max(0, nullptr);
+        if(maxLeaf >= 1)
+            __cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+        if(maxLeaf >= 7)
+            __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+        if(leaf1[2] & (1u << 27u)) { // the operating system saves the extended registers (OSXSAVE)
+            unsigned int eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            xcr0 = (static_cast<unsigned long long>(edx) << 32u) | eax;
+        }
+# endif
+        if(leaf1[3] & (1u << 26u))
+            instructionSets |= APLUGINSDK_ISA_SSE2;
+        if(leaf1[2] & (1u << 20u))
+            instructionSets |= APLUGINSDK_ISA_SSE4_2;
+        if((leaf1[2] & (1u << 28u)) && (xcr0 & 0x6u) == 0x6u) { // AVX and the xmm and ymm registers are enabled
+            instructionSets |= APLUGINSDK_ISA_AVX;
+            if(leaf7[1] & (1u << 5u))
+                instructionSets |= APLUGINSDK_ISA_AVX2;
+            if((leaf7[1] & (1u << 16u)) && (xcr0 & 0xe0u) == 0xe0u) // and the opmask and zmm registers
+                instructionSets |= APLUGINSDK_ISA_AVX512F;
+        }
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+        instructionSets |= APLUGINSDK_ISA_NEON;
+#endif
+        return instructionSets;
+    }
+
+    bool namesEqual(const char *name1, const char *name2)
+    {
+        return name1 != nullptr && name2 != nullptr && std::strcmp(name1, name2) == 0;
+    }
 }
 
 PRIVATE_APLUGINSDK_OPEN_PRIVATE_NAMESPACE
@@ -92,6 +183,7 @@ std::unique_ptr<apl::Plugin> apl::Plugin::load(std::string path)
     if(plugin->d_ptr->pluginInfo == nullptr)
         return nullptr;
     plugin->d_ptr->pluginInfo->privateInfo->constructPluginInternals(plugin->d_ptr->initPlugin);
+    plugin->selectFeatureVariants(supportedInstructionSets());
     return plugin;
 }
 /**
@@ -179,6 +271,8 @@ const apl::PluginFeatureInfo *apl::Plugin::getFeatureInfo(size_t index) const
     size_t featureCount = getFeatureCount();
     if(featureCount == 0 || index > featureCount - 1)
         return nullptr;
+    if(!d_ptr->featureInfos.empty())
+        return d_ptr->featureInfos[index];
     return d_ptr->pluginInfo->getFeatureInfo(index);
 }
 /**
@@ -188,7 +282,11 @@ const apl::PluginFeatureInfo *apl::Plugin::getFeatureInfo(size_t index) const
  */
 const apl::PluginFeatureInfo* const* apl::Plugin::getFeatureInfos() const
 {
-    return isLoaded() ? d_ptr->pluginInfo->getFeatureInfos() : nullptr;
+    if(!isLoaded())
+        return nullptr;
+    if(!d_ptr->featureInfos.empty())
+        return d_ptr->featureInfos.data();
+    return d_ptr->pluginInfo->getFeatureInfos();
 }
 
 /**
@@ -220,3 +318,160 @@ const apl::PluginClassInfo *const *apl::Plugin::getClassInfos() const
 {
     return isLoaded() ? d_ptr->pluginInfo->getClassInfos() : nullptr;
 }
+
+/**
+ * Searches the feature @p featureName in the feature group @p featureGroup. Plugins built with api version 5 or newer
+ * look the feature up in a perfect hash table, which they build when they are loaded. For older plugins the features
+ * are searched linearly and compared by their name hashes first (if they have them).
+ *
+ * @param featureGroup The feature group of the feature.
+ * @param featureName The name of the feature.
+ *
+ * @return The PluginFeatureInfo or nullptr if this plugin has no such feature.
+ */
+const apl::PluginFeatureInfo* apl::Plugin::findFeature(const char *featureGroup, const char *featureName) const
+{
+    if(featureGroup == nullptr || featureName == nullptr || !isLoaded())
+        return nullptr;
+    if(hasLookupFunctions(d_ptr->pluginInfo))
+        return d_ptr->selectedFeature(d_ptr->pluginInfo->findFeature(featureGroup, featureName));
+    const APluginNameHash groupHash = sdk::detail::private_APluginSDK_hashName(featureGroup);
+    const APluginNameHash nameHash = sdk::detail::private_APluginSDK_hashName(featureName);
+    const size_t hashesEnd = offsetof(PluginFeatureInfo, featureNameHash) + sizeof(APluginNameHash);
+    size_t featureCount = getFeatureCount();
+    const PluginFeatureInfo* const* features = getFeatureInfos();
+    for(size_t i = 0; i < featureCount; i++) {
+        const PluginFeatureInfo *feature = features[i];
+        if(hasNameHashes(feature, hashesEnd) && (feature->featureNameHash != nameHash || feature->featureGroupHash != groupHash))
+            continue;
+        if(namesEqual(feature->featureName, featureName) && namesEqual(feature->featureGroup, featureGroup))
+            return feature;
+    }
+    return nullptr;
+}
+/**
+ * Searches the feature @p featureName in the feature group @p featureGroup like
+ * findFeature(const char*, const char*), but only returns it if its signature equals @p signature.
+ *
+ * @param featureGroup The feature group of the feature.
+ * @param featureName The name of the feature.
+ * @param signature The expected signature (see featureSignature()).
+ *
+ * @return The PluginFeatureInfo or nullptr if this plugin has no such feature with a known and equal signature.
+ */
+const apl::PluginFeatureInfo* apl::Plugin::findFeature(const char *featureGroup, const char *featureName,
+                                                       APluginNameHash signature) const
+{
+    const PluginFeatureInfo *feature = findFeature(featureGroup, featureName);
+    const size_t signatureEnd = offsetof(PluginFeatureInfo, signatureHash) + sizeof(APluginNameHash);
+    if(feature == nullptr || signature == 0 || !hasNameHashes(feature, signatureEnd))
+        return nullptr;
+    return feature->signatureHash == signature ? feature : nullptr;
+}
+/**
+ * Searches the class @p className implementing the interface @p interfaceName, like findFeature(const char*, const char*).
+ *
+ * @param interfaceName The name of the interface.
+ * @param className The name of the class.
+ *
+ * @return The PluginClassInfo or nullptr if this plugin has no such class.
+ */
+const apl::PluginClassInfo* apl::Plugin::findClass(const char *interfaceName, const char *className) const
+{
+    if(interfaceName == nullptr || className == nullptr || !isLoaded())
+        return nullptr;
+    if(hasLookupFunctions(d_ptr->pluginInfo))
+        return d_ptr->pluginInfo->findClass(interfaceName, className);
+    const APluginNameHash interfaceHash = sdk::detail::private_APluginSDK_hashName(interfaceName);
+    const APluginNameHash nameHash = sdk::detail::private_APluginSDK_hashName(className);
+    const size_t hashesEnd = offsetof(PluginClassInfo, classNameHash) + sizeof(APluginNameHash);
+    size_t classCount = getClassCount();
+    const PluginClassInfo* const* classes = getClassInfos();
+    for(size_t i = 0; i < classCount; i++) {
+        const PluginClassInfo *classInfo = classes[i];
+        if(hasNameHashes(classInfo, hashesEnd) && (classInfo->classNameHash != nameHash || classInfo->interfaceNameHash != interfaceHash))
+            continue;
+        if(namesEqual(classInfo->className, className) && namesEqual(classInfo->interfaceName, interfaceName))
+            return classInfo;
+    }
+    return nullptr;
+}
+
+/**
+ * @return The count of PluginFeatureVariant's (instruction set specific implementations of features) contained in
+ * this plugin.
+ */
+size_t apl::Plugin::getFeatureVariantCount() const
+{
+    return isLoaded() && hasFeatureVariants(d_ptr->pluginInfo) ? d_ptr->pluginInfo->getFeatureVariantCount() : 0;
+}
+/**
+ * @return A PluginFeatureVariant array, with all PluginFeatureVariant's of the plugin.
+ *
+ * @see getFeatureVariantCount()
+ */
+const apl::PluginFeatureVariant* const* apl::Plugin::getFeatureVariants() const
+{
+    return isLoaded() && hasFeatureVariants(d_ptr->pluginInfo) ? d_ptr->pluginInfo->getFeatureVariants() : nullptr;
+}
+/**
+ * Selects for every feature the variant which requires the highest instruction sets contained in @p instructionSets
+ * (or the feature itself if there is no such variant). The PluginFeatureInfo's returned by getFeatureInfo(),
+ * getFeatureInfos() and findFeature() are copies of the features with the function pointer of the selected variant.\n
+ * This is done with supportedInstructionSets() when the plugin is loaded, calling it again (e.g. to force a variant)
+ * invalidates the PluginFeatureInfo's returned before and must not happen while other threads use the plugin.
+ *
+ * @param instructionSets The APLUGINSDK_ISA_* flags which the selected variants may require.
+ */
+void apl::Plugin::selectFeatureVariants(unsigned long instructionSets)
+{
+    d_ptr->selectedFeatures.clear();
+    d_ptr->featureInfos.clear();
+    d_ptr->selectedFeatureMap.clear();
+    size_t variantCount = getFeatureVariantCount();
+    const PluginFeatureVariant* const* variants = getFeatureVariants();
+    std::vector<std::pair<const PluginFeatureInfo*, const PluginFeatureVariant*>> selection;
+    for(size_t i = 0; i < variantCount; i++) {
+        const PluginFeatureVariant *variant = variants[i];
+        if((variant->instructionSets & ~instructionSets) != 0)
+            continue;
+        const PluginFeatureInfo *feature = findFeature(variant->featureGroup, variant->featureName);
+        if(feature == nullptr)
+            continue;
+        auto iterator = selection.begin();
+        for(; iterator != selection.end() && iterator->first != feature; ++iterator);
+        if(iterator == selection.end())
+            selection.emplace_back(feature, variant);
+        else if(variant->instructionSets > iterator->second->instructionSets)
+            iterator->second = variant;
+    }
+    if(selection.empty())
+        return;
+    d_ptr->selectedFeatures.reserve(selection.size());
+    for(const auto &selected : selection) {
+        PluginFeatureInfo feature = *selected.first;
+        feature.structSize = std::min(feature.structSize, sizeof(PluginFeatureInfo));
+        feature.functionPointer = selected.second->functionPointer;
+        d_ptr->selectedFeatures.push_back(feature);
+        d_ptr->selectedFeatureMap.emplace(selected.first, &d_ptr->selectedFeatures.back());
+    }
+    const PluginFeatureInfo* const* features = d_ptr->pluginInfo->getFeatureInfos();
+    size_t featureCount = getFeatureCount();
+    d_ptr->featureInfos.reserve(featureCount);
+    for(size_t i = 0; i < featureCount; i++)
+        d_ptr->featureInfos.push_back(d_ptr->selectedFeature(features[i]));
+}
+
+/**
+ * Detects the instruction set extensions of the cpu once, which are used to select the feature variants of loaded
+ * plugins.
+ *
+ * @return The APLUGINSDK_ISA_* flags supported by the cpu (and operating system).
+ *
+ * @see Plugin::selectFeatureVariants()
+ */
+unsigned long apl::supportedInstructionSets()
+{
+    static const unsigned long instructionSets = detectInstructionSets();
+    return instructionSets;
+}
@@ -1,10 +1,70 @@
 #include "APluginLibrary/pluginmanager.h"
 #include "private/pluginmanagerprivate.h"
+#include "private/pluginqueryprivate.h"
 
 #include <unordered_set>
 #include <algorithm>
+#include <cstring>
+#include <cstdint>
 
-#include "tinydir/tinydir.h"
+namespace
+{
+    /*
+     * The plugins loaded by a budgeted loadDirectory call. The caller takes the plugins loaded until the deadline, the
+     * background loader hands the remaining ones to the future afterwards.
+     */
+    struct BudgetedLoad
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::vector<const apl::Plugin*> plugins;
+        bool done = false, taken = false;
+        size_t takenCount = 0;
+        std::promise<std::vector<const apl::Plugin*>> remaining;
+    };
+
+    void orderPluginPaths(std::vector<std::string> &paths, apl::PluginLoadOrder order, const std::vector<std::string> &priorities)
+    {
+        if(order == apl::PluginLoadOrder::SmallestFirst) {
+            std::vector<std::pair<uint64_t, std::string>> sizes;
+            apl::detail::FileStamp stamp;
+            for(std::string& path : paths)
+                sizes.emplace_back(apl::detail::stampFile(apl::detail::getPluginAbsolutePath(path), stamp) ? stamp.size : UINT64_MAX, std::move(path));
+            std::sort(sizes.begin(), sizes.end());
+            for(size_t i = 0; i < paths.size(); i++)
+                paths[i] = std::move(sizes[i].second);
+        } else {
+            std::sort(paths.begin(), paths.end());
+            if(order == apl::PluginLoadOrder::Priority) {
+                // plugins are matched by their path or by their file name without the extension
+                auto rank = [&](const std::string &path) {
+                    std::string name = path.substr(path.find_last_of("/\\") + 1);
+                    for(size_t i = 0; i < priorities.size(); i++) {
+                        if(priorities[i] == path || priorities[i] == name)
+                            return i;
+                    }
+                    return priorities.size();
+                };
+                std::stable_sort(paths.begin(), paths.end(), [&](const std::string &p1, const std::string &p2) { return rank(p1) < rank(p2); });
+            }
+        }
+    }
+
+    apl::detail::DirectoryWatcher::Callback watcherCallback(apl::PluginManager *manager, apl::detail::PluginManagerPrivate *d_ptr)
+    {
+        return [manager, d_ptr](const std::vector<std::string> &paths) {
+            return d_ptr->applyDirectoryChanges(manager, paths);
+        };
+    }
+
+    const apl::detail::PluginQueryPrivate* prepareQuery(const apl::PluginQuery &query, apl::PluginQuery &storage)
+    {
+        if(query.isPrepared())
+            return apl::detail::PluginQueryPrivate::get(query);
+        storage = query;
+        return apl::detail::PluginQueryPrivate::get(storage.prepare());
+    }
+}
 
 /**
  * @class apl::PluginManager
@@ -24,16 +84,19 @@ apl::PluginManager::PluginManager()
 /**
  * Constructs a copy of @p other.
  *
+ * The copy shares the plugins, ids and indices of @p other until one of them loads or unloads a plugin, so copying
+ * takes constant time. Observers are not copied.
+ *
  * @see operator=(const PluginManager& other)
  */
 apl::PluginManager::PluginManager(const PluginManager &other)
     : PluginManager()
 {
-    other.d_ptr->localMutex.lock();
-    d_ptr->plugins = other.d_ptr->plugins;
-    for(auto plugin : d_ptr->plugins)
-        detail::PluginManagerPrivate::loadPlugin(plugin);
-    other.d_ptr->localMutex.unlock();
+    std::lock_guard<std::recursive_mutex> lockGuard(other.d_ptr->localMutex);
+    other.d_ptr->collectPendingIndexes();
+    d_ptr->set = other.d_ptr->set;
+    d_ptr->indexedPlugins = other.d_ptr->indexedPlugins;
+    d_ptr->invalidate();
 }
 /**
  * Move constructs @p other.
@@ -43,6 +106,10 @@ apl::PluginManager::PluginManager(const PluginManager &other)
 apl::PluginManager::PluginManager(PluginManager &&other) noexcept
     : d_ptr(other.d_ptr)
 {
+    d_ptr->joinBackgroundLoaders(); // the background loaders load into the moved from PluginManager
+    d_ptr->flushObserverEvents(); // queued events refer to the moved from PluginManager
+    if(d_ptr->watcher != nullptr)
+        d_ptr->watcher->setCallback(watcherCallback(this, d_ptr));
     other.d_ptr = nullptr;
 }
 /**
@@ -52,6 +119,10 @@ apl::PluginManager::PluginManager(PluginManager &&other) noexcept
  */
 apl::PluginManager::~PluginManager()
 {
+    if(d_ptr == nullptr)
+        return; // moved from
+    d_ptr->watcher.reset();
+    d_ptr->joinBackgroundLoaders();
     unloadAll();
     delete d_ptr;
 }
@@ -66,13 +137,16 @@ apl::PluginManager::~PluginManager()
 apl::PluginManager &apl::PluginManager::operator=(const PluginManager &other)
 {
     if(this != &other) {
+        d_ptr->watcher.reset(); // the watched directories aren't copied
+        d_ptr->joinBackgroundLoaders();
         d_ptr->localMutex.lock();
         unloadAll();
         d_ptr->observers.clear();
         other.d_ptr->localMutex.lock();
-        d_ptr->plugins = other.d_ptr->plugins;
-        for(auto plugin : d_ptr->plugins)
-            detail::PluginManagerPrivate::loadPlugin(plugin);
+        other.d_ptr->collectPendingIndexes();
+        d_ptr->set = other.d_ptr->set;
+        d_ptr->indexedPlugins = other.d_ptr->indexedPlugins;
+        d_ptr->invalidate();
         other.d_ptr->localMutex.unlock();
         d_ptr->localMutex.unlock();
     }
@@ -88,11 +162,23 @@ apl::PluginManager &apl::PluginManager::operator=(const PluginManager &other)
 apl::PluginManager &apl::PluginManager::operator=(PluginManager &&other) noexcept
 {
     using std::swap;
+    d_ptr->joinBackgroundLoaders();
+    other.d_ptr->joinBackgroundLoaders();
+    d_ptr->flushObserverEvents();
+    other.d_ptr->flushObserverEvents();
+    for(detail::PluginManagerPrivate *p : {d_ptr, other.d_ptr}) {
+        if(p->watcher != nullptr)
+            p->watcher->setCallback(nullptr); // a running callback needs localMutex
+    }
     d_ptr->localMutex.lock();
     other.d_ptr->localMutex.lock();
     swap(d_ptr, other.d_ptr);
     other.d_ptr->localMutex.unlock();
     d_ptr->localMutex.unlock();
+    if(d_ptr->watcher != nullptr)
+        d_ptr->watcher->setCallback(watcherCallback(this, d_ptr));
+    if(other.d_ptr->watcher != nullptr)
+        other.d_ptr->watcher->setCallback(watcherCallback(&other, other.d_ptr));
     return *this;
 }
 
@@ -107,16 +193,54 @@ const apl::Plugin* apl::PluginManager::load(std::string path)
 {
     d_ptr->localMutex.lock();
     Plugin* plugin = detail::PluginManagerPrivate::loadPlugin(std::move(path));
-    if(plugin != nullptr && std::find(d_ptr->plugins.begin(), d_ptr->plugins.end(), plugin) == d_ptr->plugins.end()) {
-        d_ptr->plugins.push_back(plugin);
-        for(auto observer : d_ptr->observers)
-            observer->pluginLoaded(this, plugin);
+    if(plugin != nullptr && d_ptr->addPlugin(plugin)) {
+        d_ptr->notifyLoaded(this, {plugin});
     } else if(plugin != nullptr) {
         detail::PluginManagerPrivate::unloadPlugin(plugin);
     }
     d_ptr->localMutex.unlock();
     return plugin;
 }
+/**
+ * Loads multiple plugins into this PluginManager at once and notifies the observers once about all new plugins (see
+ * PluginManagerObserver::pluginsLoaded).
+ *
+ * The paths are resolved and the shared libraries are opened in parallel and the global plugin registry is updated in
+ * one transaction, so this is faster than loading the plugins one by one.
+ *
+ * @param paths The paths to the shared libraries containing the plugins.
+ *
+ * @return The plugins in the same order as @p paths, nullptr for the plugins which couldn't be loaded.
+ */
+std::vector<const apl::Plugin*> apl::PluginManager::load(const std::vector<std::string> &paths)
+{
+    std::vector<Plugin*> loadedPlugins = detail::PluginManagerPrivate::loadPlugins(paths);
+    std::vector<const Plugin*> plugins(loadedPlugins.begin(), loadedPlugins.end()), addedPlugins;
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    for(auto plugin : loadedPlugins) {
+        if(plugin != nullptr && d_ptr->addPlugin(plugin))
+            addedPlugins.push_back(plugin);
+        else if(plugin != nullptr)
+            detail::PluginManagerPrivate::unloadPlugin(plugin); // already loaded or duplicated in paths
+    }
+    d_ptr->notifyLoaded(this, addedPlugins);
+    return plugins;
+}
+/**
+ * Loads the plugins of @p manifest which match @p query like load(const std::vector<std::string>&), without loading
+ * any other plugin to find them.
+ *
+ * @param manifest The PluginManifest with the metadata of the plugins.
+ * @param query The PluginQuery the plugins must match (see PluginManifest::getPaths(const PluginQuery&)).
+ *
+ * @return The loaded plugins (plugins which couldn't be loaded are skipped).
+ */
+std::vector<const apl::Plugin*> apl::PluginManager::load(const PluginManifest &manifest, const PluginQuery &query)
+{
+    std::vector<const Plugin*> plugins = load(manifest.getPaths(query));
+    plugins.erase(std::remove(plugins.begin(), plugins.end(), nullptr), plugins.end());
+    return plugins;
+}
 /**
  * Loads all plugins in the directory at path into this PluginManager.
  *
@@ -124,43 +248,253 @@ const apl::Plugin* apl::PluginManager::load(std::string path)
  * @param recursive If the directory should be searched recursive.
  *
  * @return The loaded plugins.
+ *
+ * @see load(const std::vector<std::string>&)
  */
 std::vector<const apl::Plugin*> apl::PluginManager::loadDirectory(const std::string &path, bool recursive)
 {
-    tinydir_dir dir;
-    tinydir_file file;
-    std::vector<const apl::Plugin*> plugins, tmpPlugins;
-    const apl::Plugin* tmpPlugin;
-    std::string filePath;
+    std::vector<std::string> paths;
+    detail::collectPluginPaths(path, recursive, paths);
+    std::vector<const Plugin*> plugins = load(paths);
+    plugins.erase(std::remove(plugins.begin(), plugins.end(), nullptr), plugins.end());
+    return plugins;
+}
 
-    tinydir_open(&dir, path.c_str());
-    d_ptr->localMutex.lock();
-    while (dir.has_next) {
-        tinydir_readfile(&dir, &file);
-        filePath = file.path;
-        if(strcmp(file.name, ".") != 0 && strcmp(file.name, "..") != 0) {
-            if (file.is_dir && recursive) {
-                tmpPlugins = loadDirectory(filePath, recursive);
-                plugins.insert(plugins.end(), tmpPlugins.begin(), tmpPlugins.end());
-            } else if (!file.is_dir && strcmp(file.extension, apl::LibraryLoader::libExtension()) == 0
-                       && (tmpPlugin = load(filePath.erase(filePath.size() - 1 - strlen(file.extension)))) != nullptr) {
-                plugins.emplace_back(tmpPlugin);
-            }
-        }
-        tinydir_next(&dir);
+/**
+ * Indexes the plugins of @p manifest without loading them. An indexed plugin is loaded (once) by the first call of
+ * getFeatures, getClasses, getFeatureIds or getClassIds with a filter or query which matches one of its features or
+ * classes (calls without a filter load all indexed plugins), so only the plugins which are actually used are loaded.
+ *
+ * @param manifest The PluginManifest containing the plugins.
+ *
+ * @return The count of indexed plugins (plugins which are already loaded or indexed are skipped).
+ *
+ * @see getIndexedPluginCount()
+ */
+size_t apl::PluginManager::index(const PluginManifest &manifest)
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->index(*detail::PluginManifestPrivate::get(manifest));
+}
+/**
+ * Indexes all plugins in the directory at @p path like index(const PluginManifest&). If @p manifestFile is given, the
+ * manifest saved there is used and only new or changed plugins are loaded to index them (the manifest is saved again
+ * if it changed), otherwise every plugin is loaded and released again once to read its metadata.
+ *
+ * @param path The path of the directory.
+ * @param recursive If the subdirectories should be indexed too.
+ * @param manifestFile The path of the manifest file of this directory or an empty string.
+ *
+ * @return The count of indexed plugins.
+ *
+ * @see PluginManifest
+ */
+size_t apl::PluginManager::indexDirectory(const std::string &path, bool recursive, const std::string &manifestFile)
+{
+    PluginManifest manifest = manifestFile.empty() ? PluginManifest() : PluginManifest::open(manifestFile);
+    size_t size = manifest.size();
+    if((manifest.update(path, recursive) > 0 || manifest.size() != size) && !manifestFile.empty())
+        manifest.save(manifestFile);
+    return index(manifest);
+}
+/**
+ * @return The count of indexed plugins which aren't loaded yet.
+ */
+size_t apl::PluginManager::getIndexedPluginCount() const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    d_ptr->collectPendingIndexes();
+    return d_ptr->indexedPlugins.size();
+}
+
+/**
+ * Loads the plugins in the directory at @p path which were used according to @p profile synchronously, ordered by
+ * their first use, and indexes all other plugins like indexDirectory(const std::string&, bool, const std::string&), so
+ * they are loaded lazily when they are requested. If no @p manifestFile is given, reading the metadata of the other
+ * plugins would load each of them once, so they are indexed on a background thread instead; the first query which
+ * needs the index (or getIndexedPluginCount()) waits until it is complete.
+ *
+ * @param path The path of the directory.
+ * @param recursive If the plugins in the subdirectories should be loaded too.
+ * @param profile The usage profile of a previous run (see getUsageProfile()).
+ * @param manifestFile The path of the manifest file of this directory or an empty string.
+ *
+ * @return The loaded plugins ordered by their first use in @p profile.
+ */
+std::vector<const apl::Plugin*> apl::PluginManager::loadDirectory(const std::string &path, bool recursive,
+                                                                  const PluginUsageProfile &profile, const std::string &manifestFile)
+{
+    std::vector<std::string> paths;
+    detail::collectPluginPaths(path, recursive, paths);
+    std::unordered_set<std::string> directoryPaths;
+    for(const std::string& pluginPath : paths) {
+        std::string absolutePath = detail::getPluginAbsolutePath(pluginPath);
+        directoryPaths.insert(absolutePath.erase(absolutePath.size() - 1 - strlen(LibraryLoader::libExtension())));
+    }
+    std::vector<std::string> hotPaths = profile.getPlugins();
+    hotPaths.erase(std::remove_if(hotPaths.begin(), hotPaths.end(), [&](const std::string &hotPath) {
+        return directoryPaths.find(hotPath) == directoryPaths.end();
+    }), hotPaths.end());
+    std::vector<const Plugin*> plugins = load(hotPaths);
+    plugins.erase(std::remove(plugins.begin(), plugins.end(), nullptr), plugins.end());
+    if(!manifestFile.empty()) {
+        indexDirectory(path, recursive, manifestFile);
+    } else {
+        std::future<PluginManifest> pendingIndex = std::async(std::launch::async, [path, recursive]() {
+            PluginManifest manifest;
+            manifest.update(path, recursive);
+            return manifest;
+        });
+        std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+        d_ptr->pendingIndexes.push_back(std::move(pendingIndex));
     }
-    tinydir_close(&dir);
-    d_ptr->localMutex.unlock();
     return plugins;
 }
+/**
+ * Loads all plugins in the directory at @p path like loadDirectory(const std::string&, bool) and keeps watching the
+ * directory afterwards: new shared libraries are loaded, removed ones are unloaded and changed ones are swapped. As the
+ * old shared library stays mapped while another PluginManager (or a queued observer event) still uses the old plugin,
+ * a changed plugin is unloaded but only loaded again once the old plugin is released everywhere (checked every
+ * @p debounce). Changes are applied on a background thread once no further changes happened for @p debounce. On Linux
+ * the directory is watched with inotify, so the cost is proportional to the changes, on other platforms it is
+ * rescanned every @p debounce interval.
+ *
+ * @param path The path of the directory.
+ * @param recursive If the subdirectories should be watched too.
+ * @param debounce The time without changes after which the changes are applied (for all watched directories).
+ *
+ * @return True if the directory is watched, false if it can't be watched.
+ *
+ * @see unwatchDirectories()
+ */
+bool apl::PluginManager::watchDirectory(const std::string &path, bool recursive, std::chrono::milliseconds debounce)
+{
+    {
+        std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+        if(d_ptr->watcher == nullptr)
+            d_ptr->watcher.reset(new detail::DirectoryWatcher(debounce, watcherCallback(this, d_ptr)));
+        else
+            d_ptr->watcher->setDebounce(debounce);
+        if(!d_ptr->watcher->watch(path, recursive))
+            return false;
+    }
+    loadDirectory(path, recursive);
+    return true;
+}
+/**
+ * Stops watching all directories, the loaded plugins stay loaded.
+ */
+void apl::PluginManager::unwatchDirectories()
+{
+    std::unique_ptr<detail::DirectoryWatcher> watcher;
+    {
+        std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+        watcher = std::move(d_ptr->watcher);
+    }
+}
 
+/**
+ * Enables or disables the recording of the plugins, features and classes returned by the filtered getFeatures and
+ * getClasses calls of this PluginManager. Enabling the recording starts a new profile
+ * whose times are relative to this call.
+ *
+ * @param record If the usage should be recorded.
+ *
+ * @see getUsageProfile()
+ */
+void apl::PluginManager::setUsageRecording(bool record)
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    if(record) {
+        d_ptr->usageProfile.reset(new PluginUsageProfile());
+        d_ptr->usageStart = std::chrono::steady_clock::now();
+        d_ptr->recordedInfos.clear();
+    } else {
+        d_ptr->usageProfile.reset();
+    }
+}
+/**
+ * @return True if the usage is recorded, false if not.
+ */
+bool apl::PluginManager::isUsageRecording() const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->usageProfile != nullptr;
+}
+/**
+ * @return A copy of the usage recorded since usage recording was enabled, which can be saved and passed to
+ * loadDirectory(const std::string&, bool, const PluginUsageProfile&, const std::string&) on the next start.
+ */
+apl::PluginUsageProfile apl::PluginManager::getUsageProfile() const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->usageProfile == nullptr ? PluginUsageProfile() : *d_ptr->usageProfile;
+}
+
+/**
+ * Loads the plugins in the directory at @p path like loadDirectory(const std::string&, bool), but returns after
+ * @p budget at the latest. The plugins are loaded in batches (in parallel within a batch) in the given order on a
+ * background thread, the plugins loaded until the budget is exhausted are returned and the remaining ones are loaded in
+ * the background afterwards. The observers are notified about every loaded batch as usual.
+ *
+ * @param path The path of the directory.
+ * @param recursive If the plugins in the subdirectories should be loaded too.
+ * @param budget The maximum time this call blocks.
+ * @param remaining Set to a future which gets ready with the plugins loaded after this call returned, after all
+ * plugins are loaded.
+ * @param order The order in which the plugins are loaded: by path, smallest shared libraries first or the plugins in
+ * @p priorities first.
+ * @param priorities The paths or file names (without the file extension) of the plugins which are loaded first, in
+ * this order, if @p order is PluginLoadOrder::Priority.
+ *
+ * @return The plugins loaded within @p budget in loading order.
+ */
+std::vector<const apl::Plugin*> apl::PluginManager::loadDirectory(const std::string &path, bool recursive, std::chrono::milliseconds budget,
+                                                                  std::future<std::vector<const Plugin*>> &remaining,
+                                                                  PluginLoadOrder order, const std::vector<std::string> &priorities)
+{
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    std::vector<std::string> paths;
+    detail::collectPluginPaths(path, recursive, paths);
+    orderPluginPaths(paths, order, priorities);
+
+    auto state = std::make_shared<BudgetedLoad>();
+    remaining = state->remaining.get_future();
+    std::thread loader([this, state, paths]() {
+        size_t batchSize = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        for(size_t first = 0; first < paths.size(); first += batchSize) {
+            std::vector<const Plugin*> plugins = load(std::vector<std::string>(paths.begin() + first, paths.begin() + std::min(first + batchSize, paths.size())));
+            plugins.erase(std::remove(plugins.begin(), plugins.end(), nullptr), plugins.end());
+            std::lock_guard<std::mutex> lockGuard(state->mutex);
+            state->plugins.insert(state->plugins.end(), plugins.begin(), plugins.end());
+            state->condition.notify_all();
+        }
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done = true;
+        state->condition.notify_all();
+        state->condition.wait(lock, [&]() { return state->taken; });
+        state->remaining.set_value(std::vector<const Plugin*>(state->plugins.begin() + state->takenCount, state->plugins.end()));
+    });
+    {
+        std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+        d_ptr->backgroundLoaders.push_back(std::move(loader));
+    }
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait_until(lock, deadline, [&]() { return state->done; });
+    std::vector<const Plugin*> plugins = state->plugins;
+    state->takenCount = plugins.size();
+    state->taken = true;
+    state->condition.notify_all();
+    return plugins;
+}
 /**
  * @return The count of loaded Plugins int this PluginManager.
  */
 size_t apl::PluginManager::getLoadedPluginCount() const
 {
     std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
-    return d_ptr->plugins.size();
+    return d_ptr->set->plugins.size();
 }
 /**
  * @return The loaded Plugin with the given @p path as constant pointers in this PluginManager or nullptr if no plugin
@@ -169,7 +503,7 @@ size_t apl::PluginManager::getLoadedPluginCount() const
 const apl::Plugin* apl::PluginManager::getLoadedPlugin(const std::string &path) const
 {
     std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
-    for(auto plugin : d_ptr->plugins) {
+    for(auto plugin : d_ptr->set->plugins) {
         if(plugin->getPath() == path)
             return plugin;
     }
@@ -182,13 +516,25 @@ std::vector<const apl::Plugin*> apl::PluginManager::getLoadedPlugins() const
 {
     std::vector<const Plugin*> plugins;
     d_ptr->localMutex.lock();
-    plugins.reserve(d_ptr->plugins.size());
-    for(auto plugin : d_ptr->plugins)
+    plugins.reserve(d_ptr->set->plugins.size());
+    for(auto plugin : d_ptr->set->plugins)
         plugins.push_back(plugin);
     d_ptr->localMutex.unlock();
     return plugins;
 }
 
+/**
+ * The generation is incremented every time a plugin is loaded into or unloaded from this PluginManager. If it didn't
+ * change since the last query, the results of all queries are unchanged too.
+ *
+ * @return The current generation of this PluginManager.
+ */
+uint64_t apl::PluginManager::getGeneration() const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->generation;
+}
+
 /**
  * Unloads a specific plugin from this PluginManager and notifies the observer about the removed plugin.
  *
@@ -197,13 +543,8 @@ std::vector<const apl::Plugin*> apl::PluginManager::getLoadedPlugins() const
 void apl::PluginManager::unload(const Plugin *plugin)
 {
     d_ptr->localMutex.lock();
-    auto iterator = std::remove(d_ptr->plugins.begin(), d_ptr->plugins.end(), plugin);
-    if(iterator != d_ptr->plugins.end()) {
-        d_ptr->plugins.erase(iterator);
-        for(auto observer : d_ptr->observers)
-            observer->pluginUnloaded(this, const_cast<Plugin*>(plugin));
-        detail::PluginManagerPrivate::unloadPlugin(const_cast<Plugin*>(plugin));
-    }
+    if(d_ptr->removePlugin(plugin))
+        d_ptr->releaseUnloaded(this, {const_cast<Plugin*>(plugin)});
     d_ptr->localMutex.unlock();
 }
 /**
@@ -212,15 +553,158 @@ void apl::PluginManager::unload(const Plugin *plugin)
 void apl::PluginManager::unloadAll()
 {
     d_ptr->localMutex.lock();
-    while(!d_ptr->plugins.empty()) {
-        Plugin* plugin = d_ptr->plugins.back();
-        d_ptr->plugins.pop_back();
-        for(auto observer : d_ptr->observers)
-            observer->pluginUnloaded(this, plugin);
-        detail::PluginManagerPrivate::unloadPlugin(plugin);
+    if(d_ptr->observers.empty()) {
+        // without observers the references can be released by dropping the (possibly shared) set at once
+        if(!d_ptr->set->plugins.empty()) {
+            d_ptr->set = std::make_shared<detail::PluginSet>();
+            d_ptr->invalidate();
+        }
+        d_ptr->localMutex.unlock();
+        return;
     }
+    std::vector<Plugin*> plugins;
+    while(!d_ptr->set->plugins.empty()) {
+        Plugin* plugin = d_ptr->set->plugins.back();
+        d_ptr->removePlugin(plugin);
+        if(d_ptr->dispatcher != nullptr)
+            plugins.push_back(plugin); // queued as one event
+        else
+            d_ptr->releaseUnloaded(this, {plugin});
+    }
+    d_ptr->releaseUnloaded(this, std::move(plugins));
     d_ptr->localMutex.unlock();
 }
+/**
+ * Unloads all plugins in this PluginManager like unloadAll(), but only detaches them from this PluginManager and
+ * notifies the observers immediately. The plugins which aren't used anymore are destroyed (their fini functions are
+ * called and their shared libraries are closed) on a background thread: plugins loaded in the same batch (see
+ * load(const std::vector<std::string>&)) in parallel and the batches in reverse loading order.
+ *
+ * Loading one of these plugins again waits until it is destroyed.
+ *
+ * @return A future which gets ready after all plugins released by this call are destroyed. Plugins still used by other
+ * PluginManager's or pending observer events are destroyed when they are released there.
+ *
+ * @see waitForPendingUnloads(std::chrono::milliseconds)
+ */
+std::future<void> apl::PluginManager::unloadAllAsync()
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    std::vector<Plugin*> plugins(d_ptr->set->plugins.rbegin(), d_ptr->set->plugins.rend()), references;
+    if(d_ptr->set.use_count() == 1) {
+        references = plugins; // the references of the set are released below instead of by its destructor
+        d_ptr->set->plugins.clear();
+    }
+    if(!plugins.empty()) {
+        d_ptr->set = std::make_shared<detail::PluginSet>();
+        d_ptr->invalidate();
+    }
+    if(!d_ptr->observers.empty() && !plugins.empty()) {
+        if(d_ptr->dispatcher != nullptr) {
+            detail::PluginManagerPrivate::acquirePlugins(plugins); // held by the event until delivery
+            d_ptr->releaseUnloaded(this, plugins);
+        } else {
+            for(Plugin* plugin : plugins) {
+                for(const detail::ObserverNotification& notification : d_ptr->notificationsFor({plugin}))
+                    notification.observer->pluginUnloaded(this, plugin);
+            }
+        }
+    }
+    return detail::PluginManagerPrivate::releasePluginsAsync(references);
+}
+/**
+ * Waits until all plugins released by unloadAllAsync() of any PluginManager are destroyed, but at most @p timeout.
+ *
+ * @param timeout The maximum time to wait.
+ *
+ * @return True if all plugins are destroyed, false if the timeout expired.
+ */
+bool apl::PluginManager::waitForPendingUnloads(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(detail::PluginManagerPrivate::staticMutex);
+    return detail::PluginManagerPrivate::pendingCondition.wait_for(lock, timeout, []() {
+        return detail::PluginManagerPrivate::reapingCount == 0;
+    });
+}
+
+/**
+ * Configures the retention cache shared by all PluginManager's. Plugins which aren't used by any PluginManager anymore
+ * are kept in this cache instead of being destroyed, so loading them again soon after is only a reference count
+ * increment (or at least doesn't need to map and relocate their shared libraries again). The least recently released
+ * plugins are evicted if the cache holds more than @p maxPlugins plugins and plugins older than @p maxAge are evicted
+ * when the plugins are loaded or unloaded. The cache is disabled by default.
+ *
+ * @param maxPlugins The maximum count of retained plugins, 0 disables the cache and destroys all retained plugins.
+ * @param maxAge The maximum time a plugin is retained, 0 for no limit.
+ * @param policy PluginRetentionPolicy::DeferFinalization keeps the whole plugin (its fini function is called when it is
+ * evicted), PluginRetentionPolicy::Finalize destroys the plugin but keeps its shared library mapped.
+ *
+ * @see flushRetentionCache()
+ */
+void apl::PluginManager::setRetentionCache(size_t maxPlugins, std::chrono::milliseconds maxAge, PluginRetentionPolicy policy)
+{
+    std::vector<detail::RetentionCache::Entry> evicted;
+    {
+        std::lock_guard<std::mutex> lockGuard(detail::PluginManagerPrivate::staticMutex);
+        detail::PluginManagerPrivate::retentionCache.configure(maxPlugins, maxAge, policy, evicted);
+        detail::PluginManagerPrivate::reserveEvicted(evicted);
+    }
+    detail::PluginManagerPrivate::destroyEvicted(evicted);
+}
+/**
+ * Destroys all plugins retained by the retention cache.
+ *
+ * @see setRetentionCache(size_t, std::chrono::milliseconds, PluginRetentionPolicy)
+ */
+void apl::PluginManager::flushRetentionCache()
+{
+    std::vector<detail::RetentionCache::Entry> evicted;
+    {
+        std::lock_guard<std::mutex> lockGuard(detail::PluginManagerPrivate::staticMutex);
+        detail::PluginManagerPrivate::retentionCache.flush(evicted);
+        detail::PluginManagerPrivate::reserveEvicted(evicted);
+    }
+    detail::PluginManagerPrivate::destroyEvicted(evicted);
+}
+/**
+ * @return The count of plugins currently retained by the retention cache (expired plugins are evicted before).
+ */
+size_t apl::PluginManager::getRetainedPluginCount()
+{
+    std::vector<detail::RetentionCache::Entry> evicted;
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lockGuard(detail::PluginManagerPrivate::staticMutex);
+        detail::PluginManagerPrivate::retentionCache.evictExpired(evicted);
+        detail::PluginManagerPrivate::reserveEvicted(evicted);
+        size = detail::PluginManagerPrivate::retentionCache.size();
+    }
+    detail::PluginManagerPrivate::destroyEvicted(evicted);
+    return size;
+}
+/**
+ * Shared libraries which don't contain a plugin are remembered (with their device, inode, size and modification time)
+ * and not opened again until they change. Libraries without an exported APluginSDK_getPluginInfo are rejected without
+ * opening them at all (on ELF platforms). This forgets all rejected libraries, e.g. after missing dependencies of a
+ * plugin were installed.
+ *
+ * @see getRejectedLibraryCount()
+ */
+void apl::PluginManager::clearRejectedLibraries()
+{
+    std::lock_guard<std::mutex> lockGuard(detail::PluginManagerPrivate::staticMutex);
+    detail::PluginManagerPrivate::rejectedLibraries.clear();
+}
+/**
+ * @return The count of shared libraries which are remembered as containing no plugin.
+ *
+ * @see clearRejectedLibraries()
+ */
+size_t apl::PluginManager::getRejectedLibraryCount()
+{
+    std::lock_guard<std::mutex> lockGuard(detail::PluginManagerPrivate::staticMutex);
+    return detail::PluginManagerPrivate::rejectedLibraries.size();
+}
 
 /**
  * @return The PluginInfo's of all loaded plugins in this PluginManager.
@@ -229,8 +713,8 @@ std::vector<const apl::PluginInfo*> apl::PluginManager::getPluginInfos() const
 {
     std::vector<const PluginInfo*> infos;
     d_ptr->localMutex.lock();
-    infos.reserve(d_ptr->plugins.size());
-    for(const auto plugin : d_ptr->plugins)
+    infos.reserve(d_ptr->set->plugins.size());
+    for(const auto plugin : d_ptr->set->plugins)
         infos.emplace_back(plugin->getPluginInfo());
     d_ptr->localMutex.unlock();
     return infos;
@@ -246,8 +730,8 @@ std::vector<const apl::PluginInfo*> apl::PluginManager::getPluginInfos(const std
     std::vector<const PluginInfo*> infos;
     const PluginInfo* info;
     d_ptr->localMutex.lock();
-    infos.reserve(d_ptr->plugins.size());
-    for(const auto plugin : d_ptr->plugins) {
+    infos.reserve(d_ptr->set->plugins.size());
+    for(const auto plugin : d_ptr->set->plugins) {
         info = plugin->getPluginInfo();
         if(string == detail::filterPluginInfo(info, filter))
             infos.emplace_back(info);
@@ -255,6 +739,23 @@ std::vector<const apl::PluginInfo*> apl::PluginManager::getPluginInfos(const std
     d_ptr->localMutex.unlock();
     return infos;
 }
+/**
+ * @param query The query to execute.
+ *
+ * @return The PluginInfo's of all loaded plugins in this PluginManager which fulfill @p query, ordered by PluginId.
+ */
+std::vector<const apl::PluginInfo*> apl::PluginManager::getPluginInfos(const PluginQuery &query) const
+{
+    PluginQuery storage;
+    const detail::PluginQueryPrivate* queryPrivate = prepareQuery(query, storage);
+    std::vector<const PluginInfo*> infos;
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    detail::IdList ids = d_ptr->queryPlugins(*queryPrivate);
+    infos.reserve(ids.size());
+    for(uint32_t index : ids)
+        infos.push_back(d_ptr->set->pluginIds.get(d_ptr->set->pluginIds.idAt(index))->getPluginInfo());
+    return infos;
+}
 /**
  * @param filter The filter to use.
  * @return A vector with all filtered plugin info properties contained in the plugins loaded by this PluginManager.
@@ -263,8 +764,8 @@ std::vector<std::string> apl::PluginManager::getPluginProperties(PluginInfoFilte
 {
     std::unordered_set<std::string> propertiesSet;
     d_ptr->localMutex.lock();
-    propertiesSet.reserve(d_ptr->plugins.size());
-    for(const auto plugin : d_ptr->plugins)
+    propertiesSet.reserve(d_ptr->set->plugins.size());
+    for(const auto plugin : d_ptr->set->plugins)
         propertiesSet.emplace(detail::filterPluginInfo(plugin->getPluginInfo(), filter));
     d_ptr->localMutex.unlock();
     return std::vector<std::string>(propertiesSet.begin(), propertiesSet.end());
@@ -278,7 +779,9 @@ std::vector<const apl::PluginFeatureInfo*> apl::PluginManager::getFeatures() con
     std::vector<const PluginFeatureInfo*> features;
     const PluginFeatureInfo* const* featureInfos;
     d_ptr->localMutex.lock();
-    for(const auto plugin : d_ptr->plugins) {
+    if(d_ptr->hasIndexedPlugins())
+        d_ptr->loadIndexed(const_cast<PluginManager*>(this), detail::PluginQueryPrivate());
+    for(const auto plugin : d_ptr->set->plugins) {
         featureInfos = plugin->getFeatureInfos();
         if(featureInfos != nullptr)
             features.insert(features.end(), featureInfos, featureInfos + plugin->getFeatureCount());
@@ -294,17 +797,78 @@ std::vector<const apl::PluginFeatureInfo*> apl::PluginManager::getFeatures() con
  */
 std::vector<const apl::PluginFeatureInfo*> apl::PluginManager::getFeatures(const std::string &string, PluginFeatureFilter filter) const
 {
+    return *getSharedFeatures(string, filter);
+}
+/**
+ * The matching features are looked up in the sorted per-property index, so the cost depends on the number of matches
+ * and not on the number of loaded features.
+ *
+ * @param pattern The string, prefix or glob pattern to filter for.
+ * @param filter The filter to use.
+ * @param match How @p pattern is matched.
+ *
+ * @return The filtered PluginFeatureInfo's of all loaded plugins in this PluginManager. Results of exact matches are
+ * ordered like getFeatures(const std::string&, PluginFeatureFilter), all others are ordered by FeatureId.
+ */
+std::vector<const apl::PluginFeatureInfo*> apl::PluginManager::getFeatures(const std::string &pattern, PluginFeatureFilter filter, PluginStringMatch match) const
+{
+    if(match == PluginStringMatch::Equal)
+        return getFeatures(pattern, filter);
+    return getFeatures(PluginQuery().where(filter, pattern, match).prepare());
+}
+/**
+ * @param query The query to execute.
+ *
+ * @return The PluginFeatureInfo's of all loaded plugins in this PluginManager which fulfill @p query, ordered by
+ * FeatureId.
+ */
+std::vector<const apl::PluginFeatureInfo*> apl::PluginManager::getFeatures(const PluginQuery &query) const
+{
+    PluginQuery storage;
+    const detail::PluginQueryPrivate* queryPrivate = prepareQuery(query, storage);
     std::vector<const PluginFeatureInfo*> features;
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    if(d_ptr->hasIndexedPlugins())
+        d_ptr->loadIndexed(const_cast<PluginManager*>(this), *queryPrivate);
+    detail::IdList ids = d_ptr->queryFeatures(*queryPrivate);
+    features.reserve(ids.size());
+    for(uint32_t index : ids)
+        features.push_back(d_ptr->set->featureIds.get(d_ptr->set->featureIds.idAt(index)));
+    d_ptr->recordUsage(features);
+    return features;
+}
+/**
+ * Same as getFeatures(const std::string&, PluginFeatureFilter), but the result is memoized until the next load or
+ * unload (see getGeneration()), so repeated queries share one immutable result instead of scanning all features again.
+ *
+ * @param string The string to filter for.
+ * @param filter The filter to use.
+ *
+ * @return The filtered PluginFeatureInfo's of all loaded plugins in this PluginManager.
+ */
+std::shared_ptr<const std::vector<const apl::PluginFeatureInfo*>> apl::PluginManager::getSharedFeatures(const std::string &string, PluginFeatureFilter filter) const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    d_ptr->loadIndexed(const_cast<PluginManager*>(this), filter, string);
+    auto key = std::make_pair(filter, string);
+    auto iterator = d_ptr->featureQueryCache.find(key);
+    if(iterator != d_ptr->featureQueryCache.end()) {
+        d_ptr->recordUsage(*iterator->second);
+        return iterator->second;
+    }
+    auto features = std::make_shared<std::vector<const PluginFeatureInfo*>>();
     const PluginFeatureInfo* const* featureInfos;
-    d_ptr->localMutex.lock();
-    for(const auto plugin : d_ptr->plugins) {
+    for(const auto plugin : d_ptr->set->plugins) {
         featureInfos = plugin->getFeatureInfos();
         for(size_t i = 0; i < plugin->getFeatureCount(); i++) {
             if(string == detail::filterFeatureInfo(featureInfos[i], filter))
-                features.emplace_back(featureInfos[i]);
+                features->emplace_back(featureInfos[i]);
         }
     }
-    d_ptr->localMutex.unlock();
+    if(d_ptr->featureQueryCache.size() >= detail::PluginManagerPrivate::maxQueryCacheSize)
+        d_ptr->featureQueryCache.clear();
+    d_ptr->featureQueryCache.emplace(std::move(key), features);
+    d_ptr->recordUsage(*features);
     return features;
 }
 /**
@@ -317,7 +881,7 @@ std::vector<std::string> apl::PluginManager::getFeatureProperties(PluginFeatureF
     const PluginFeatureInfo* const* featureInfos;
     const char* property;
     d_ptr->localMutex.lock();
-    for(const auto plugin : d_ptr->plugins) {
+    for(const auto plugin : d_ptr->set->plugins) {
         featureInfos = plugin->getFeatureInfos();
         for(size_t i = 0; i < plugin->getFeatureCount(); i++) {
             property = detail::filterFeatureInfo(featureInfos[i], filter);
@@ -336,7 +900,9 @@ std::vector<const apl::PluginClassInfo*> apl::PluginManager::getClasses() const
     std::vector<const PluginClassInfo*> classes;
     const PluginClassInfo* const* classInfos;
     d_ptr->localMutex.lock();
-    for(const auto plugin : d_ptr->plugins) {
+    if(d_ptr->hasIndexedPlugins())
+        d_ptr->loadIndexed(const_cast<PluginManager*>(this), detail::PluginQueryPrivate());
+    for(const auto plugin : d_ptr->set->plugins) {
         classInfos = plugin->getClassInfos();
         if(classInfos != nullptr)
             classes.insert(classes.end(), classInfos, classInfos + plugin->getClassCount());
@@ -352,17 +918,77 @@ std::vector<const apl::PluginClassInfo*> apl::PluginManager::getClasses() const
  */
 std::vector<const apl::PluginClassInfo*> apl::PluginManager::getClasses(const std::string &string, PluginClassFilter filter) const
 {
+    return *getSharedClasses(string, filter);
+}
+/**
+ * The matching classes are looked up in the sorted per-property index, so the cost depends on the number of matches
+ * and not on the number of loaded classes.
+ *
+ * @param pattern The string, prefix or glob pattern to filter for.
+ * @param filter The filter to use.
+ * @param match How @p pattern is matched.
+ *
+ * @return The filtered PluginClassInfo's of all loaded plugins in this PluginManager. Results of exact matches are
+ * ordered like getClasses(const std::string&, PluginClassFilter), all others are ordered by ClassId.
+ */
+std::vector<const apl::PluginClassInfo*> apl::PluginManager::getClasses(const std::string &pattern, PluginClassFilter filter, PluginStringMatch match) const
+{
+    if(match == PluginStringMatch::Equal)
+        return getClasses(pattern, filter);
+    return getClasses(PluginQuery().where(filter, pattern, match).prepare());
+}
+/**
+ * @param query The query to execute.
+ *
+ * @return The PluginClassInfo's of all loaded plugins in this PluginManager which fulfill @p query, ordered by ClassId.
+ */
+std::vector<const apl::PluginClassInfo*> apl::PluginManager::getClasses(const PluginQuery &query) const
+{
+    PluginQuery storage;
+    const detail::PluginQueryPrivate* queryPrivate = prepareQuery(query, storage);
     std::vector<const PluginClassInfo*> classes;
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    if(d_ptr->hasIndexedPlugins())
+        d_ptr->loadIndexed(const_cast<PluginManager*>(this), *queryPrivate);
+    detail::IdList ids = d_ptr->queryClasses(*queryPrivate);
+    classes.reserve(ids.size());
+    for(uint32_t index : ids)
+        classes.push_back(d_ptr->set->classIds.get(d_ptr->set->classIds.idAt(index)));
+    d_ptr->recordUsage(classes);
+    return classes;
+}
+/**
+ * Same as getClasses(const std::string&, PluginClassFilter), but the result is memoized until the next load or unload
+ * (see getGeneration()), so repeated queries share one immutable result instead of scanning all classes again.
+ *
+ * @param string The string to filter for.
+ * @param filter The filter to use.
+ *
+ * @return The filtered PluginClassInfo's of all loaded plugins in this PluginManager.
+ */
+std::shared_ptr<const std::vector<const apl::PluginClassInfo*>> apl::PluginManager::getSharedClasses(const std::string &string, PluginClassFilter filter) const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    d_ptr->loadIndexed(const_cast<PluginManager*>(this), filter, string);
+    auto key = std::make_pair(filter, string);
+    auto iterator = d_ptr->classQueryCache.find(key);
+    if(iterator != d_ptr->classQueryCache.end()) {
+        d_ptr->recordUsage(*iterator->second);
+        return iterator->second;
+    }
+    auto classes = std::make_shared<std::vector<const PluginClassInfo*>>();
     const PluginClassInfo* const* classInfos;
-    d_ptr->localMutex.lock();
-    for(const auto plugin : d_ptr->plugins) {
+    for(const auto plugin : d_ptr->set->plugins) {
         classInfos = plugin->getClassInfos();
         for(size_t i = 0; i < plugin->getClassCount(); i++) {
             if(string == detail::filterClassInfo(classInfos[i], filter))
-                classes.emplace_back(classInfos[i]);
+                classes->emplace_back(classInfos[i]);
         }
     }
-    d_ptr->localMutex.unlock();
+    if(d_ptr->classQueryCache.size() >= detail::PluginManagerPrivate::maxQueryCacheSize)
+        d_ptr->classQueryCache.clear();
+    d_ptr->classQueryCache.emplace(std::move(key), classes);
+    d_ptr->recordUsage(*classes);
     return classes;
 }
 /**
@@ -375,7 +1001,7 @@ std::vector<std::string> apl::PluginManager::getClassProperties(PluginClassFilte
     const PluginClassInfo* const* classInfos;
     const char* property;
     d_ptr->localMutex.lock();
-    for(const auto plugin : d_ptr->plugins) {
+    for(const auto plugin : d_ptr->set->plugins) {
         classInfos = plugin->getClassInfos();
         for(size_t i = 0; i < plugin->getClassCount(); i++) {
             property = detail::filterClassInfo(classInfos[i], filter);
@@ -386,6 +1012,186 @@ std::vector<std::string> apl::PluginManager::getClassProperties(PluginClassFilte
     return std::vector<std::string>(propertiesSet.begin(), propertiesSet.end());
 }
 
+/**
+ * @param plugin The plugin to get the id for.
+ *
+ * @return The id of @p plugin in this PluginManager or an invalid id if @p plugin isn't loaded in this PluginManager.
+ */
+apl::PluginId apl::PluginManager::getPluginId(const Plugin *plugin) const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    auto iterator = d_ptr->set->pluginEntries.find(plugin);
+    return iterator == d_ptr->set->pluginEntries.end() ? PluginId() : iterator->second.id;
+}
+/**
+ * Resolves a PluginId in constant time.
+ *
+ * @param id The id of the plugin.
+ *
+ * @return The plugin with the given @p id or nullptr if the id is invalid or stale (the plugin was unloaded).
+ */
+const apl::Plugin* apl::PluginManager::plugin(PluginId id) const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->set->pluginIds.get(id);
+}
+/**
+ * PluginIds are dense, so arrays indexed by PluginId::getIndex() only have to be as large as the returned value.
+ *
+ * @return The upper bound (exclusive) of all PluginId indices currently handed out by this PluginManager.
+ */
+size_t apl::PluginManager::getPluginIdCapacity() const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->set->pluginIds.capacity();
+}
+
+/**
+ * @param info The PluginFeatureInfo to get the id for.
+ *
+ * @return The id of @p info in this PluginManager or an invalid id if the feature isn't loaded in this PluginManager.
+ */
+apl::FeatureId apl::PluginManager::getFeatureId(const PluginFeatureInfo *info) const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    auto iterator = d_ptr->set->featureIdLookup.find(info);
+    return iterator == d_ptr->set->featureIdLookup.end() ? FeatureId() : iterator->second;
+}
+/**
+ * @param string The string to filter for.
+ * @param filter The filter to use.
+ *
+ * @return The ids of the filtered features in the same order as getFeatures(const std::string&, PluginFeatureFilter).
+ */
+std::vector<apl::FeatureId> apl::PluginManager::getFeatureIds(const std::string &string, PluginFeatureFilter filter) const
+{
+    std::vector<FeatureId> ids;
+    d_ptr->localMutex.lock();
+    d_ptr->loadIndexed(const_cast<PluginManager*>(this), filter, string);
+    for(const auto plugin : d_ptr->set->plugins) {
+        const detail::PluginEntry& entry = d_ptr->set->pluginEntries.at(plugin);
+        for(FeatureId id : entry.featureIds) {
+            if(string == detail::filterFeatureInfo(d_ptr->set->featureIds.get(id), filter))
+                ids.push_back(id);
+        }
+    }
+    d_ptr->localMutex.unlock();
+    return ids;
+}
+/**
+ * @param query The query to execute.
+ *
+ * @return The sorted ids of all features which fulfill @p query.
+ */
+std::vector<apl::FeatureId> apl::PluginManager::getFeatureIds(const PluginQuery &query) const
+{
+    PluginQuery storage;
+    const detail::PluginQueryPrivate* queryPrivate = prepareQuery(query, storage);
+    std::vector<FeatureId> ids;
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    if(d_ptr->hasIndexedPlugins())
+        d_ptr->loadIndexed(const_cast<PluginManager*>(this), *queryPrivate);
+    for(uint32_t index : d_ptr->queryFeatures(*queryPrivate))
+        ids.push_back(d_ptr->set->featureIds.idAt(index));
+    return ids;
+}
+/**
+ * Resolves a FeatureId in constant time.
+ *
+ * @param id The id of the feature.
+ *
+ * @return The PluginFeatureInfo with the given @p id or nullptr if the id is invalid or stale (the plugin containing
+ * the feature was unloaded).
+ */
+const apl::PluginFeatureInfo* apl::PluginManager::feature(FeatureId id) const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->set->featureIds.get(id);
+}
+/**
+ * FeatureIds are dense, so arrays indexed by FeatureId::getIndex() only have to be as large as the returned value.
+ *
+ * @return The upper bound (exclusive) of all FeatureId indices currently handed out by this PluginManager.
+ */
+size_t apl::PluginManager::getFeatureIdCapacity() const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->set->featureIds.capacity();
+}
+
+/**
+ * @param info The PluginClassInfo to get the id for.
+ *
+ * @return The id of @p info in this PluginManager or an invalid id if the class isn't loaded in this PluginManager.
+ */
+apl::ClassId apl::PluginManager::getClassId(const PluginClassInfo *info) const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    auto iterator = d_ptr->set->classIdLookup.find(info);
+    return iterator == d_ptr->set->classIdLookup.end() ? ClassId() : iterator->second;
+}
+/**
+ * @param string The string to filter for.
+ * @param filter The filter to use.
+ *
+ * @return The ids of the filtered classes in the same order as getClasses(const std::string&, PluginClassFilter).
+ */
+std::vector<apl::ClassId> apl::PluginManager::getClassIds(const std::string &string, PluginClassFilter filter) const
+{
+    std::vector<ClassId> ids;
+    d_ptr->localMutex.lock();
+    d_ptr->loadIndexed(const_cast<PluginManager*>(this), filter, string);
+    for(const auto plugin : d_ptr->set->plugins) {
+        const detail::PluginEntry& entry = d_ptr->set->pluginEntries.at(plugin);
+        for(ClassId id : entry.classIds) {
+            if(string == detail::filterClassInfo(d_ptr->set->classIds.get(id), filter))
+                ids.push_back(id);
+        }
+    }
+    d_ptr->localMutex.unlock();
+    return ids;
+}
+/**
+ * @param query The query to execute.
+ *
+ * @return The sorted ids of all classes which fulfill @p query.
+ */
+std::vector<apl::ClassId> apl::PluginManager::getClassIds(const PluginQuery &query) const
+{
+    PluginQuery storage;
+    const detail::PluginQueryPrivate* queryPrivate = prepareQuery(query, storage);
+    std::vector<ClassId> ids;
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    if(d_ptr->hasIndexedPlugins())
+        d_ptr->loadIndexed(const_cast<PluginManager*>(this), *queryPrivate);
+    for(uint32_t index : d_ptr->queryClasses(*queryPrivate))
+        ids.push_back(d_ptr->set->classIds.idAt(index));
+    return ids;
+}
+/**
+ * Resolves a ClassId in constant time.
+ *
+ * @param id The id of the class.
+ *
+ * @return The PluginClassInfo with the given @p id or nullptr if the id is invalid or stale (the plugin containing
+ * the class was unloaded).
+ */
+const apl::PluginClassInfo* apl::PluginManager::pluginClass(ClassId id) const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->set->classIds.get(id);
+}
+/**
+ * ClassIds are dense, so arrays indexed by ClassId::getIndex() only have to be as large as the returned value.
+ *
+ * @return The upper bound (exclusive) of all ClassId indices currently handed out by this PluginManager.
+ */
+size_t apl::PluginManager::getClassIdCapacity() const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->set->classIds.capacity();
+}
+
 /**
  * Adds an observer to this PluginManager instance which gets notified about changes.
  * @param observer The observer to be added (only added if not already an observer of this PluginManager instance).
@@ -393,10 +1199,28 @@ std::vector<std::string> apl::PluginManager::getClassProperties(PluginClassFilte
 void apl::PluginManager::addObserver(PluginManagerObserver *observer)
 {
     d_ptr->localMutex.lock();
-    if(observer != nullptr && std::find(d_ptr->observers.begin(), d_ptr->observers.end(), observer) == d_ptr->observers.end())
-        d_ptr->observers.push_back(observer);
+    auto iterator = std::find_if(d_ptr->observers.begin(), d_ptr->observers.end(), [&](const detail::ObserverSubscription &subscription) {
+        return subscription.observer == observer;
+    });
+    if(observer != nullptr && iterator == d_ptr->observers.end())
+        d_ptr->observers.push_back({observer, nullptr});
     d_ptr->localMutex.unlock();
 }
+/**
+ * Adds an observer to this PluginManager instance which only gets notified about plugins fulfilling @p filter (see
+ * getPluginInfos(const PluginQuery&)), e.g. plugins providing a specific feature group or class interface. Every
+ * distinct filter is evaluated only once per load or unload, no matter how many observers use it.
+ *
+ * @param observer The observer to be added. If it is already an observer of this PluginManager instance, its filter is
+ * replaced.
+ * @param filter The query the plugins have to fulfill.
+ */
+void apl::PluginManager::addObserver(PluginManagerObserver *observer, const PluginQuery &filter)
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    if(observer != nullptr)
+        d_ptr->addObserver(observer, &filter);
+}
 /**
  * Removes an observer from this PluginManager instance.
  * @param observer The observer to be removed.
@@ -404,8 +1228,59 @@ void apl::PluginManager::addObserver(PluginManagerObserver *observer)
 void apl::PluginManager::removeObserver(PluginManagerObserver *observer)
 {
     d_ptr->localMutex.lock();
-    auto iterator = std::find(d_ptr->observers.begin(), d_ptr->observers.end(), observer);
+    auto iterator = std::find_if(d_ptr->observers.begin(), d_ptr->observers.end(), [&](const detail::ObserverSubscription &subscription) {
+        return subscription.observer == observer;
+    });
     if(iterator != d_ptr->observers.end())
         d_ptr->observers.erase(iterator);
     d_ptr->localMutex.unlock();
+    d_ptr->flushObserverEvents(); // the observer may be destroyed after this returns
+}
+
+/**
+ * Enables or disables the asynchronous notification of the observers.
+ *
+ * If enabled, load and unload events are queued and delivered in order on a dedicated thread instead of inside load()
+ * and unload(), so slow observers don't block other threads using this PluginManager. Consecutive events of the same
+ * kind are delivered as one batch (PluginManagerObserver::pluginsLoaded and PluginManagerObserver::pluginsUnloaded).
+ * Unloaded plugins are released after the delivery, so they stay valid inside the callbacks.
+ *
+ * Disabling delivers all queued events first. Must not be called from an observer callback.
+ *
+ * @param async If the observers should be notified asynchronously.
+ *
+ * @see flushObserverEvents()
+ */
+void apl::PluginManager::setAsyncObserverDispatch(bool async)
+{
+    std::shared_ptr<detail::ObserverDispatcher> dispatcher;
+    {
+        std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+        if(d_ptr->dispatcher != nullptr && d_ptr->dispatcher->isDispatcherThread())
+            throw std::runtime_error("The observer dispatch can't be changed from an observer callback");
+        if(async && d_ptr->dispatcher == nullptr)
+            d_ptr->dispatcher = std::make_shared<detail::ObserverDispatcher>();
+        else if(!async)
+            dispatcher.swap(d_ptr->dispatcher);
+    }
+    if(dispatcher != nullptr)
+        dispatcher->flush();
+}
+/**
+ * @return If the observers are notified asynchronously.
+ *
+ * @see setAsyncObserverDispatch(bool)
+ */
+bool apl::PluginManager::isAsyncObserverDispatch() const
+{
+    std::lock_guard<std::recursive_mutex> lockGuard(d_ptr->localMutex);
+    return d_ptr->dispatcher != nullptr;
+}
+/**
+ * Blocks until all observer events queued before are delivered. Does nothing if the observers are notified
+ * synchronously or if called from an observer callback.
+ */
+void apl::PluginManager::flushObserverEvents()
+{
+    d_ptr->flushObserverEvents();
 }
@@ -10,3 +10,14 @@
  */
 
 apl::PluginManagerObserver::~PluginManagerObserver() = default;
+
+void apl::PluginManagerObserver::pluginsLoaded(PluginManager *pluginManager, const std::vector<const Plugin*> &plugins)
+{
+    for(const Plugin* plugin : plugins)
+        pluginLoaded(pluginManager, plugin);
+}
+void apl::PluginManagerObserver::pluginsUnloaded(PluginManager *pluginManager, const std::vector<const Plugin*> &plugins)
+{
+    for(const Plugin* plugin : plugins)
+        pluginUnloaded(pluginManager, plugin);
+}
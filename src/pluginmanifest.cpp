@@ -0,0 +1,240 @@
+#include "APluginLibrary/pluginmanifest.h"
+#include "private/pluginmanifestprivate.h"
+#include "private/pluginmanagerprivate.h"
+#include "private/pluginqueryprivate.h"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @class apl::PluginManifest
+ *
+ * @brief A PluginManifest caches the metadata of the plugins in directories in a file.
+ *
+ * The manifest stores the name, versions, features and classes of every indexed plugin together with the identity,
+ * size and modification time of its shared library. A manifest saved by a previous process can be opened (the file
+ * is mapped, not parsed) and validated with one stat call per plugin, so its metadata can be queried before or
+ * instead of loading the plugins. Only new and changed shared libraries are loaded by update().
+ *
+ * The PluginInfo's, PluginFeatureInfo's and PluginClassInfo's returned by a manifest only contain metadata, their
+ * function pointers are nullptr.
+ */
+
+/**
+ * Creates an empty PluginManifest.
+ */
+apl::PluginManifest::PluginManifest()
+    : d_ptr(new detail::PluginManifestPrivate())
+{}
+/**
+ * Constructs a copy of @p other, the entries are shared.
+ */
+apl::PluginManifest::PluginManifest(const PluginManifest &other)
+    : d_ptr(new detail::PluginManifestPrivate(*other.d_ptr))
+{}
+/**
+ * Move constructs a PluginManifest from @p other.
+ */
+apl::PluginManifest::PluginManifest(PluginManifest &&other) noexcept
+    : d_ptr(std::move(other.d_ptr))
+{
+    other.d_ptr.reset(new detail::PluginManifestPrivate());
+}
+/**
+ * Destroys the PluginManifest, the returned infos get invalid.
+ */
+apl::PluginManifest::~PluginManifest() = default;
+
+/**
+ * Copies the entries of @p other to this PluginManifest.
+ */
+apl::PluginManifest& apl::PluginManifest::operator=(const PluginManifest &other)
+{
+    if(this != &other)
+        *d_ptr = *other.d_ptr;
+    return *this;
+}
+/**
+ * Moves the entries of @p other to this PluginManifest.
+ */
+apl::PluginManifest& apl::PluginManifest::operator=(PluginManifest &&other) noexcept
+{
+    std::swap(d_ptr, other.d_ptr);
+    return *this;
+}
+
+/**
+ * Opens the manifest saved at @p file. The file is mapped and the metadata references it directly.
+ *
+ * @param file The path of the manifest file.
+ *
+ * @return The opened PluginManifest, which is empty if @p file doesn't exist or isn't a valid manifest.
+ *
+ * @see validate()
+ */
+apl::PluginManifest apl::PluginManifest::open(const std::string &file)
+{
+    PluginManifest manifest;
+    manifest.d_ptr->read(file);
+    return manifest;
+}
+/**
+ * Saves the manifest at @p file. The file is replaced atomically.
+ *
+ * @param file The path of the manifest file.
+ *
+ * @return True if the manifest was saved, false if not.
+ */
+bool apl::PluginManifest::save(const std::string &file) const
+{
+    return d_ptr->write(file);
+}
+
+/**
+ * Removes the plugins whose shared libraries changed or don't exist anymore and indexes all new (and changed) shared
+ * libraries in @p directory. Only these libraries are loaded (in parallel, plugins already loaded by a PluginManager
+ * are reused) and released again afterwards.
+ *
+ * @param directory The directory containing the plugins.
+ * @param recursive If the subdirectories should be indexed too.
+ *
+ * @return The count of plugins which were indexed.
+ */
+size_t apl::PluginManifest::update(const std::string &directory, bool recursive)
+{
+    validate();
+    std::vector<std::string> paths;
+    detail::collectPluginPaths(directory, recursive, paths);
+    std::vector<std::string> newPaths;
+    std::vector<detail::FileStamp> stamps;
+    for(const std::string& path : paths) {
+        std::string libraryPath = detail::getPluginAbsolutePath(path);
+        std::string absolutePath = libraryPath.substr(0, libraryPath.size() - 1 - strlen(LibraryLoader::libExtension()));
+        detail::FileStamp stamp;
+        if(!contains(absolutePath) && detail::stampFile(libraryPath, stamp)) {
+            newPaths.push_back(std::move(absolutePath));
+            stamps.push_back(stamp);
+        }
+    }
+    std::vector<Plugin*> plugins = detail::PluginManagerPrivate::loadPlugins(newPaths);
+    size_t count = 0;
+    for(size_t i = 0; i < plugins.size(); i++) {
+        if(plugins[i] != nullptr) {
+            d_ptr->entries[newPaths[i]] = detail::PluginManifestPrivate::index(plugins[i], newPaths[i], stamps[i]);
+            count += 1;
+        }
+    }
+    plugins.erase(std::remove(plugins.begin(), plugins.end(), nullptr), plugins.end());
+    detail::PluginManagerPrivate::releasePlugins(plugins);
+    return count;
+}
+/**
+ * Checks the shared library of every plugin with one stat call and removes the plugins whose libraries changed or
+ * don't exist anymore.
+ *
+ * @return The count of removed plugins.
+ */
+size_t apl::PluginManifest::validate()
+{
+    size_t count = 0;
+    detail::FileStamp stamp;
+    for(auto iterator = d_ptr->entries.begin(); iterator != d_ptr->entries.end();) {
+        std::string libraryPath = std::string(iterator->first).append(".").append(LibraryLoader::libExtension());
+        if(!detail::stampFile(libraryPath, stamp) || stamp != iterator->second->stamp) {
+            iterator = d_ptr->entries.erase(iterator);
+            count += 1;
+        } else {
+            ++iterator;
+        }
+    }
+    return count;
+}
+/**
+ * Removes all plugins from the manifest.
+ */
+void apl::PluginManifest::clear()
+{
+    d_ptr->entries.clear();
+}
+
+/**
+ * @return The count of plugins in the manifest.
+ */
+size_t apl::PluginManifest::size() const
+{
+    return d_ptr->entries.size();
+}
+/**
+ * @param path The absolute path of a plugin without the file extension.
+ *
+ * @return True if the manifest contains the plugin at @p path, false if not.
+ */
+bool apl::PluginManifest::contains(const std::string &path) const
+{
+    return d_ptr->entries.find(path) != d_ptr->entries.end();
+}
+/**
+ * @return The absolute paths (without the file extension) of all plugins in the manifest in lexicographical order.
+ */
+std::vector<std::string> apl::PluginManifest::getPaths() const
+{
+    std::vector<std::string> paths;
+    paths.reserve(d_ptr->entries.size());
+    for(const auto& entry : d_ptr->entries)
+        paths.push_back(entry.first);
+    return paths;
+}
+/**
+ * Returns the paths of the plugins which fulfill the plugin criteria of @p query and provide at least one feature and
+ * one class fulfilling its feature and class criteria, without loading them.
+ *
+ * @param query The PluginQuery.
+ *
+ * @return The absolute paths (without the file extension) of the matching plugins, which can be passed to
+ * PluginManager::load(const std::vector<std::string>&).
+ */
+std::vector<std::string> apl::PluginManifest::getPaths(const PluginQuery &query) const
+{
+    PluginQuery preparedQuery = query;
+    const detail::PluginQueryPrivate *queryPrivate = detail::PluginQueryPrivate::get(preparedQuery.prepare());
+    std::vector<std::string> paths;
+    for(const auto& entry : d_ptr->entries) {
+        const detail::ManifestEntry &manifestEntry = *entry.second;
+        const std::vector<const PluginFeatureInfo*> &features = manifestEntry.getFeatureInfos();
+        const std::vector<const PluginClassInfo*> &classes = manifestEntry.getClassInfos();
+        if(queryPrivate->matchesPluginContents(&manifestEntry.info, features.data(), features.size(), classes.data(), classes.size()))
+            paths.push_back(entry.first);
+    }
+    return paths;
+}
+
+/**
+ * @param path The absolute path of a plugin without the file extension.
+ *
+ * @return The PluginInfo of the plugin at @p path or nullptr if the manifest doesn't contain it.
+ */
+const apl::PluginInfo* apl::PluginManifest::getPluginInfo(const std::string &path) const
+{
+    auto iterator = d_ptr->entries.find(path);
+    return iterator == d_ptr->entries.end() ? nullptr : &iterator->second->info;
+}
+/**
+ * @param path The absolute path of a plugin without the file extension.
+ *
+ * @return The PluginFeatureInfo's of the plugin at @p path.
+ */
+std::vector<const apl::PluginFeatureInfo*> apl::PluginManifest::getFeatures(const std::string &path) const
+{
+    auto iterator = d_ptr->entries.find(path);
+    return iterator == d_ptr->entries.end() ? std::vector<const PluginFeatureInfo*>() : iterator->second->getFeatureInfos();
+}
+/**
+ * @param path The absolute path of a plugin without the file extension.
+ *
+ * @return The PluginClassInfo's of the plugin at @p path.
+ */
+std::vector<const apl::PluginClassInfo*> apl::PluginManifest::getClasses(const std::string &path) const
+{
+    auto iterator = d_ptr->entries.find(path);
+    return iterator == d_ptr->entries.end() ? std::vector<const PluginClassInfo*>() : iterator->second->getClassInfos();
+}
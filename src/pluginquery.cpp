@@ -0,0 +1,441 @@
+#include "APluginLibrary/pluginquery.h"
+#include "private/pluginqueryprivate.h"
+#include "private/pluginmanagerprivate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace
+{
+    template<typename Filter>
+    bool lessCriterion(const apl::detail::StringCriterion<Filter> &c1, const apl::detail::StringCriterion<Filter> &c2)
+    {
+        return std::tie(c1.match, c1.filter, c1.string) < std::tie(c2.match, c2.filter, c2.string);
+    }
+    template<typename Filter>
+    bool equalCriterion(const apl::detail::StringCriterion<Filter> &c1, const apl::detail::StringCriterion<Filter> &c2)
+    {
+        return c1.match == c2.match && c1.filter == c2.filter && c1.string == c2.string;
+    }
+
+    /*
+     * Sorts the criteria (equality criteria first, as they are the most selective ones), removes duplicates and drops
+     * prefix criteria which are implied by an equality criterion on the same property. Returns false if the criteria
+     * contradict each other.
+     */
+    template<typename Filter>
+    bool prepareCriteria(std::vector<apl::detail::StringCriterion<Filter>> &criteria)
+    {
+        std::sort(criteria.begin(), criteria.end(), lessCriterion<Filter>);
+        criteria.erase(std::unique(criteria.begin(), criteria.end(), equalCriterion<Filter>), criteria.end());
+        auto firstPrefix = std::find_if(criteria.begin(), criteria.end(), [](const apl::detail::StringCriterion<Filter> &c) {
+            return c.match != apl::PluginStringMatch::Equal;
+        });
+        for(auto equal = criteria.begin(); equal != firstPrefix; ++equal) {
+            if(equal + 1 != firstPrefix && (equal + 1)->filter == equal->filter)
+                return false; // two different strings for the same property
+        }
+        bool satisfiable = true;
+        auto end = std::remove_if(firstPrefix, criteria.end(), [&](const apl::detail::StringCriterion<Filter> &c) {
+            for(auto equal = criteria.begin(); equal != firstPrefix; ++equal) {
+                if(equal->filter == c.filter) {
+                    satisfiable = satisfiable && apl::detail::matchesString(equal->string.c_str(), c.string, c.match);
+                    return true;
+                }
+            }
+            return false;
+        });
+        criteria.erase(end, criteria.end());
+        return satisfiable;
+    }
+
+    apl::PluginVersion versionOf(const apl::PluginInfo *info, apl::PluginInfoFilter filter)
+    {
+        if(filter == apl::PluginInfoFilter::PluginVersion)
+            return apl::PluginVersion::pluginVersion(info);
+        return apl::PluginVersion::apiVersion(info);
+    }
+}
+
+/**
+ * @struct apl::PluginVersion
+ *
+ * @brief A comparable (major, minor, patch) version triple of a plugin or its api.
+ */
+
+/**
+ * Constructs the version 0.0.0.
+ */
+apl::PluginVersion::PluginVersion()
+    : PluginVersion(0, 0, 0)
+{}
+/**
+ * Constructs the version @p versionMajor.@p versionMinor.@p versionPatch.
+ */
+apl::PluginVersion::PluginVersion(size_t versionMajor, size_t versionMinor, size_t versionPatch)
+    : versionMajor(versionMajor), versionMinor(versionMinor), versionPatch(versionPatch)
+{}
+
+/**
+ * @return The plugin version of @p info.
+ */
+apl::PluginVersion apl::PluginVersion::pluginVersion(const PluginInfo *info)
+{
+    return PluginVersion(info->pluginVersionMajor, info->pluginVersionMinor, info->pluginVersionPatch);
+}
+/**
+ * @return The api version of @p info.
+ */
+apl::PluginVersion apl::PluginVersion::apiVersion(const PluginInfo *info)
+{
+    return PluginVersion(info->apiVersionMajor, info->apiVersionMinor, info->apiVersionPatch);
+}
+
+bool apl::PluginVersion::operator==(const PluginVersion &other) const
+{
+    return std::tie(versionMajor, versionMinor, versionPatch) == std::tie(other.versionMajor, other.versionMinor, other.versionPatch);
+}
+bool apl::PluginVersion::operator!=(const PluginVersion &other) const
+{
+    return !(*this == other);
+}
+bool apl::PluginVersion::operator<(const PluginVersion &other) const
+{
+    return std::tie(versionMajor, versionMinor, versionPatch) < std::tie(other.versionMajor, other.versionMinor, other.versionPatch);
+}
+bool apl::PluginVersion::operator<=(const PluginVersion &other) const
+{
+    return !(other < *this);
+}
+bool apl::PluginVersion::operator>(const PluginVersion &other) const
+{
+    return other < *this;
+}
+bool apl::PluginVersion::operator>=(const PluginVersion &other) const
+{
+    return !(*this < other);
+}
+
+/**
+ * @class apl::PluginQuery
+ *
+ * @brief A PluginQuery combines multiple criteria on plugins, features and classes, which are executed together by a
+ * PluginManager.
+ *
+ * String criteria compare a property for equality, by prefix or against a glob pattern (see PluginStringMatch).
+ *
+ * All criteria of a query must be fulfilled:
+ * - feature criteria must all be fulfilled by the same feature,
+ * - class criteria must all be fulfilled by the same class,
+ * - plugin info criteria (names and versions) must be fulfilled by the plugin.
+ *
+ * If a query is executed for features (PluginManager::getFeatures(const PluginQuery&)), class criteria restrict the
+ * result to features of plugins which provide at least one matching class (and vice versa for classes).
+ *
+ * A query should be prepared once with prepare() and can then be executed many times. The PluginManager answers
+ * queries from per-property indices by intersecting sorted id lists, instead of scanning all features and classes.
+ */
+
+apl::PluginQuery::PluginQuery()
+    : d_ptr(new detail::PluginQueryPrivate())
+{}
+apl::PluginQuery::PluginQuery(const PluginQuery &other)
+    : d_ptr(new detail::PluginQueryPrivate(*other.d_ptr))
+{}
+apl::PluginQuery::PluginQuery(PluginQuery &&other) noexcept
+    : d_ptr(std::move(other.d_ptr))
+{}
+apl::PluginQuery::~PluginQuery() = default;
+
+apl::PluginQuery& apl::PluginQuery::operator=(const PluginQuery &other)
+{
+    if(this != &other)
+        d_ptr.reset(new detail::PluginQueryPrivate(*other.d_ptr));
+    return *this;
+}
+apl::PluginQuery& apl::PluginQuery::operator=(PluginQuery &&other) noexcept
+{
+    d_ptr.swap(other.d_ptr);
+    return *this;
+}
+
+/**
+ * Adds the criterion that the property @p filter of the plugin must match @p string.
+ *
+ * @param match How @p string is matched (equality, prefix or glob pattern).
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::where(PluginInfoFilter filter, std::string string, PluginStringMatch match)
+{
+    d_ptr->infoCriteria.push_back({filter, std::move(string), match});
+    d_ptr->prepared = false;
+    return *this;
+}
+/**
+ * Adds the criterion that the property @p filter of the feature must match @p string.
+ *
+ * @param match How @p string is matched (equality, prefix or glob pattern).
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::where(PluginFeatureFilter filter, std::string string, PluginStringMatch match)
+{
+    d_ptr->featureCriteria.push_back({filter, std::move(string), match});
+    d_ptr->prepared = false;
+    return *this;
+}
+/**
+ * Adds the criterion that the property @p filter of the class must match @p string.
+ *
+ * @param match How @p string is matched (equality, prefix or glob pattern).
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::where(PluginClassFilter filter, std::string string, PluginStringMatch match)
+{
+    d_ptr->classCriteria.push_back({filter, std::move(string), match});
+    d_ptr->prepared = false;
+    return *this;
+}
+
+/**
+ * Adds the criterion that the property @p filter of the plugin must start with @p prefix.
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::wherePrefix(PluginInfoFilter filter, std::string prefix)
+{
+    return where(filter, std::move(prefix), PluginStringMatch::Prefix);
+}
+/**
+ * Adds the criterion that the property @p filter of the feature must start with @p prefix.
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::wherePrefix(PluginFeatureFilter filter, std::string prefix)
+{
+    return where(filter, std::move(prefix), PluginStringMatch::Prefix);
+}
+/**
+ * Adds the criterion that the property @p filter of the class must start with @p prefix.
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::wherePrefix(PluginClassFilter filter, std::string prefix)
+{
+    return where(filter, std::move(prefix), PluginStringMatch::Prefix);
+}
+
+/**
+ * Adds the criterion that the property @p filter of the plugin must match the glob @p pattern.
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::whereGlob(PluginInfoFilter filter, std::string pattern)
+{
+    return where(filter, std::move(pattern), PluginStringMatch::Glob);
+}
+/**
+ * Adds the criterion that the property @p filter of the feature must match the glob @p pattern.
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::whereGlob(PluginFeatureFilter filter, std::string pattern)
+{
+    return where(filter, std::move(pattern), PluginStringMatch::Glob);
+}
+/**
+ * Adds the criterion that the property @p filter of the class must match the glob @p pattern.
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::whereGlob(PluginClassFilter filter, std::string pattern)
+{
+    return where(filter, std::move(pattern), PluginStringMatch::Glob);
+}
+
+/**
+ * Adds the criterion that the plugin or api version (depending on @p filter) must be in the range
+ * [@p minimum, @p maximum].
+ *
+ * @param filter PluginInfoFilter::PluginVersion or PluginInfoFilter::ApiVersion.
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::whereVersion(PluginInfoFilter filter, PluginVersion minimum, PluginVersion maximum)
+{
+    if(filter != PluginInfoFilter::PluginVersion && filter != PluginInfoFilter::ApiVersion)
+        throw std::runtime_error("Unsupported apl::PluginInfoFilter for version ranges");
+    d_ptr->versionCriteria.push_back({filter, minimum, maximum});
+    d_ptr->prepared = false;
+    return *this;
+}
+
+/**
+ * Normalizes the criteria of this query (removes duplicated and implied criteria, merges version ranges, orders the
+ * criteria by selectivity and detects contradicting criteria). Unprepared queries are prepared on every execution.
+ *
+ * @return A reference to this
+ */
+apl::PluginQuery& apl::PluginQuery::prepare()
+{
+    if(d_ptr->prepared)
+        return *this;
+    d_ptr->satisfiable = prepareCriteria(d_ptr->infoCriteria) && prepareCriteria(d_ptr->featureCriteria)
+                         && prepareCriteria(d_ptr->classCriteria);
+    std::vector<detail::VersionCriterion> versions;
+    for(const detail::VersionCriterion& criterion : d_ptr->versionCriteria) {
+        auto iterator = std::find_if(versions.begin(), versions.end(), [&](const detail::VersionCriterion &c) {
+            return c.filter == criterion.filter;
+        });
+        if(iterator == versions.end()) {
+            versions.push_back(criterion);
+        } else {
+            iterator->minimum = std::max(iterator->minimum, criterion.minimum);
+            iterator->maximum = std::min(iterator->maximum, criterion.maximum);
+        }
+    }
+    for(const detail::VersionCriterion& criterion : versions)
+        d_ptr->satisfiable = d_ptr->satisfiable && criterion.minimum <= criterion.maximum;
+    d_ptr->versionCriteria = std::move(versions);
+    d_ptr->prepared = true;
+    return *this;
+}
+/**
+ * @return If this query was prepared and not modified afterwards.
+ */
+bool apl::PluginQuery::isPrepared() const
+{
+    return d_ptr->prepared;
+}
+/**
+ * @return False if this query is prepared and its criteria contradict each other (the result is always empty), true
+ * otherwise.
+ */
+bool apl::PluginQuery::isSatisfiable() const
+{
+    return !d_ptr->prepared || d_ptr->satisfiable;
+}
+
+
+const apl::detail::PluginQueryPrivate* apl::detail::PluginQueryPrivate::get(const PluginQuery &query)
+{
+    return query.d_ptr.get();
+}
+
+bool apl::detail::PluginQueryPrivate::hasPluginCriteria() const
+{
+    return !infoCriteria.empty() || !versionCriteria.empty();
+}
+bool apl::detail::PluginQueryPrivate::matchesPlugin(const PluginInfo *info) const
+{
+    for(const auto& criterion : infoCriteria) {
+        if(!matchesString(filterPluginInfo(info, criterion.filter).c_str(), criterion.string, criterion.match))
+            return false;
+    }
+    for(const auto& criterion : versionCriteria) {
+        PluginVersion version = versionOf(info, criterion.filter);
+        if(version < criterion.minimum || version > criterion.maximum)
+            return false;
+    }
+    return true;
+}
+bool apl::detail::PluginQueryPrivate::matchesFeature(const PluginFeatureInfo *info) const
+{
+    for(const auto& criterion : featureCriteria) {
+        if(!matchesString(filterFeatureInfo(info, criterion.filter), criterion.string, criterion.match))
+            return false;
+    }
+    return true;
+}
+bool apl::detail::PluginQueryPrivate::matchesClass(const PluginClassInfo *info) const
+{
+    for(const auto& criterion : classCriteria) {
+        if(!matchesString(filterClassInfo(info, criterion.filter), criterion.string, criterion.match))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Returns if plugin fulfills the plugin criteria and provides at least one feature and one class fulfilling the
+ * feature and class criteria (if there are any).
+ */
+bool apl::detail::PluginQueryPrivate::matchesPluginContents(const Plugin *plugin) const
+{
+    const PluginClassInfo* const* classInfos = plugin->getClassInfos();
+    return matchesPluginContents(plugin->getPluginInfo(), plugin->getFeatureInfos(), plugin->getFeatureCount(),
+                                 classInfos, classInfos == nullptr ? 0 : plugin->getClassCount());
+}
+bool apl::detail::PluginQueryPrivate::matchesPluginContents(const PluginInfo *info, const PluginFeatureInfo* const* features,
+                                                            size_t featureCount, const PluginClassInfo* const* classes,
+                                                            size_t classCount) const
+{
+    if(!satisfiable || !matchesPlugin(info))
+        return false;
+    if(!featureCriteria.empty() && std::none_of(features, features + featureCount, [this](const PluginFeatureInfo *feature) { return matchesFeature(feature); }))
+        return false;
+    if(!classCriteria.empty() && std::none_of(classes, classes + classCount, [this](const PluginClassInfo *classInfo) { return matchesClass(classInfo); }))
+        return false;
+    return true;
+}
+
+bool apl::detail::PluginQueryPrivate::equals(const PluginQueryPrivate &other) const
+{
+    auto equalVersions = [](const VersionCriterion &c1, const VersionCriterion &c2) {
+        return c1.filter == c2.filter && c1.minimum == c2.minimum && c1.maximum == c2.maximum;
+    };
+    return prepared == other.prepared && satisfiable == other.satisfiable
+           && infoCriteria.size() == other.infoCriteria.size() && featureCriteria.size() == other.featureCriteria.size()
+           && classCriteria.size() == other.classCriteria.size() && versionCriteria.size() == other.versionCriteria.size()
+           && std::equal(infoCriteria.begin(), infoCriteria.end(), other.infoCriteria.begin(), equalCriterion<PluginInfoFilter>)
+           && std::equal(featureCriteria.begin(), featureCriteria.end(), other.featureCriteria.begin(), equalCriterion<PluginFeatureFilter>)
+           && std::equal(classCriteria.begin(), classCriteria.end(), other.classCriteria.begin(), equalCriterion<PluginClassFilter>)
+           && std::equal(versionCriteria.begin(), versionCriteria.end(), other.versionCriteria.begin(), equalVersions);
+}
+
+bool apl::detail::matchesString(const char *string, const std::string &pattern, PluginStringMatch match)
+{
+    if(match == PluginStringMatch::Equal)
+        return pattern == string;
+    else if(match == PluginStringMatch::Prefix)
+        return std::strncmp(string, pattern.c_str(), pattern.size()) == 0;
+    else if(match == PluginStringMatch::Glob)
+        return matchesGlob(string, pattern.c_str());
+    else
+        throw std::runtime_error("Unsupported apl::PluginStringMatch");
+}
+/*
+ * Matches string against a glob pattern, where '*' matches any sequence and '?' any single character. Only the last
+ * '*' is backtracked to, so the cost is bound by strlen(string) * strlen(pattern).
+ */
+bool apl::detail::matchesGlob(const char *string, const char *pattern)
+{
+    const char *starPattern = nullptr, *starString = nullptr;
+    while(*string != '\0') {
+        if(*pattern == '*') {
+            starPattern = ++pattern;
+            starString = string;
+        } else if(*pattern == '?' || *pattern == *string) {
+            ++pattern;
+            ++string;
+        } else if(starPattern != nullptr) {
+            pattern = starPattern;
+            string = ++starString;
+        } else {
+            return false;
+        }
+    }
+    while(*pattern == '*')
+        ++pattern;
+    return *pattern == '\0';
+}
+/*
+ * Returns the literal part of pattern in front of the first wildcard. Every string matching pattern starts with it.
+ */
+std::string apl::detail::globPrefix(const std::string &pattern)
+{
+    return pattern.substr(0, pattern.find_first_of("*?"));
+}
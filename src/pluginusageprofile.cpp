@@ -0,0 +1,238 @@
+#include "APluginLibrary/pluginusageprofile.h"
+#include "private/pluginusageprofileprivate.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * @class apl::PluginUsageProfile
+ *
+ * @brief A PluginUsageProfile records which plugins and features a process used and when they were used first.
+ *
+ * A PluginManager records the profile while usage recording is enabled (see PluginManager::setUsageRecording(bool)).
+ * Saved profiles are used on the next start to load the plugins in the order they were used before (see
+ * PluginManager::loadDirectory(const std::string&, bool, const PluginUsageProfile&, const std::string&)).
+ *
+ * The plugins are identified by their absolute paths without the file extension, the times are relative to the start
+ * of the recording.
+ */
+
+/*
+ * Returns the usage of the plugin at path and lowers its first use to time.
+ */
+apl::detail::PluginUsage& apl::detail::PluginUsageProfilePrivate::usage(const std::string &path, std::chrono::milliseconds time)
+{
+    PluginUsage& usage = plugins.emplace(path, PluginUsage{time, {}}).first->second;
+    usage.firstUse = std::min(usage.firstUse, time);
+    return usage;
+}
+
+/**
+ * Creates an empty PluginUsageProfile.
+ */
+apl::PluginUsageProfile::PluginUsageProfile()
+    : d_ptr(new detail::PluginUsageProfilePrivate())
+{}
+/**
+ * Constructs a copy of @p other.
+ */
+apl::PluginUsageProfile::PluginUsageProfile(const PluginUsageProfile &other)
+    : d_ptr(new detail::PluginUsageProfilePrivate(*other.d_ptr))
+{}
+/**
+ * Move constructs a PluginUsageProfile from @p other.
+ */
+apl::PluginUsageProfile::PluginUsageProfile(PluginUsageProfile &&other) noexcept
+    : d_ptr(std::move(other.d_ptr))
+{
+    other.d_ptr.reset(new detail::PluginUsageProfilePrivate());
+}
+/**
+ * Destroys the PluginUsageProfile.
+ */
+apl::PluginUsageProfile::~PluginUsageProfile() = default;
+
+/**
+ * Copies the usage of @p other to this PluginUsageProfile.
+ */
+apl::PluginUsageProfile& apl::PluginUsageProfile::operator=(const PluginUsageProfile &other)
+{
+    if(this != &other)
+        *d_ptr = *other.d_ptr;
+    return *this;
+}
+/**
+ * Moves the usage of @p other to this PluginUsageProfile.
+ */
+apl::PluginUsageProfile& apl::PluginUsageProfile::operator=(PluginUsageProfile &&other) noexcept
+{
+    std::swap(d_ptr, other.d_ptr);
+    return *this;
+}
+
+/**
+ * Reads the profile saved at @p file.
+ *
+ * @param file The path of the profile file.
+ *
+ * @return The read PluginUsageProfile, which is empty if @p file doesn't exist. Invalid lines are skipped.
+ */
+apl::PluginUsageProfile apl::PluginUsageProfile::open(const std::string &file)
+{
+    PluginUsageProfile profile;
+    std::ifstream stream(file);
+    std::string line, type, time, path;
+    while(std::getline(stream, line)) {
+        std::istringstream lineStream(line);
+        if(!std::getline(lineStream, type, '\t') || !std::getline(lineStream, time, '\t') || !std::getline(lineStream, path, '\t'))
+            continue;
+        char *end;
+        std::chrono::milliseconds milliseconds(std::strtoll(time.c_str(), &end, 10));
+        if(end == time.c_str() || *end != '\0')
+            continue;
+        std::string feature;
+        if(type == "plugin")
+            profile.record(path, milliseconds);
+        else if(type == "feature" && std::getline(lineStream, feature))
+            profile.record(path, feature, milliseconds);
+    }
+    return profile;
+}
+/**
+ * Saves the profile at @p file as tab separated text. The file is replaced atomically.
+ *
+ * @param file The path of the profile file.
+ *
+ * @return True if the profile was saved, false if not.
+ */
+bool apl::PluginUsageProfile::save(const std::string &file) const
+{
+    std::string temporaryFile = file + ".tmp";
+    {
+        std::ofstream stream(temporaryFile, std::ios::trunc);
+        for(const auto& plugin : d_ptr->plugins) {
+            stream << "plugin\t" << plugin.second.firstUse.count() << '\t' << plugin.first << '\n';
+            for(const auto& feature : plugin.second.features)
+                stream << "feature\t" << feature.second.count() << '\t' << plugin.first << '\t' << feature.first << '\n';
+        }
+        if(!stream.flush()) {
+            stream.close();
+            std::remove(temporaryFile.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(file.c_str());
+#endif
+    return std::rename(temporaryFile.c_str(), file.c_str()) == 0;
+}
+
+/**
+ * Records that the plugin at @p path was used at @p time. Only the first use is kept.
+ *
+ * @param path The absolute path of the plugin without the file extension.
+ * @param time The time since the start of the recording.
+ */
+void apl::PluginUsageProfile::record(const std::string &path, std::chrono::milliseconds time)
+{
+    d_ptr->usage(path, time);
+}
+/**
+ * Records that @p feature of the plugin at @p path was used at @p time. Only the first use is kept.
+ *
+ * @param path The absolute path of the plugin without the file extension.
+ * @param feature The feature as "featureGroup::featureName".
+ * @param time The time since the start of the recording.
+ */
+void apl::PluginUsageProfile::record(const std::string &path, const std::string &feature, std::chrono::milliseconds time)
+{
+    auto& features = d_ptr->usage(path, time).features;
+    auto iterator = features.emplace(feature, time).first;
+    iterator->second = std::min(iterator->second, time);
+}
+/**
+ * Adds the usage recorded in @p other, e.g. to combine the profiles of multiple runs. The earliest uses are kept.
+ *
+ * @param other The profile to merge.
+ */
+void apl::PluginUsageProfile::merge(const PluginUsageProfile &other)
+{
+    for(const auto& plugin : other.d_ptr->plugins) {
+        record(plugin.first, plugin.second.firstUse);
+        for(const auto& feature : plugin.second.features)
+            record(plugin.first, feature.first, feature.second);
+    }
+}
+/**
+ * Removes all recorded usage.
+ */
+void apl::PluginUsageProfile::clear()
+{
+    d_ptr->plugins.clear();
+}
+
+/**
+ * @return The count of used plugins.
+ */
+size_t apl::PluginUsageProfile::size() const
+{
+    return d_ptr->plugins.size();
+}
+/**
+ * @param path The absolute path of the plugin without the file extension.
+ *
+ * @return True if the plugin at @p path was used, false if not.
+ */
+bool apl::PluginUsageProfile::contains(const std::string &path) const
+{
+    return d_ptr->plugins.find(path) != d_ptr->plugins.end();
+}
+/**
+ * @param path The absolute path of the plugin without the file extension.
+ *
+ * @return The time of the first use of the plugin at @p path or -1 if it wasn't used.
+ */
+std::chrono::milliseconds apl::PluginUsageProfile::getFirstUse(const std::string &path) const
+{
+    auto iterator = d_ptr->plugins.find(path);
+    return iterator == d_ptr->plugins.end() ? std::chrono::milliseconds(-1) : iterator->second.firstUse;
+}
+/**
+ * @return The paths of all used plugins ordered by their first use.
+ */
+std::vector<std::string> apl::PluginUsageProfile::getPlugins() const
+{
+    std::vector<std::pair<std::chrono::milliseconds, std::string>> plugins;
+    plugins.reserve(d_ptr->plugins.size());
+    for(const auto& plugin : d_ptr->plugins)
+        plugins.emplace_back(plugin.second.firstUse, plugin.first);
+    std::sort(plugins.begin(), plugins.end());
+    std::vector<std::string> paths;
+    paths.reserve(plugins.size());
+    for(auto& plugin : plugins)
+        paths.push_back(std::move(plugin.second));
+    return paths;
+}
+/**
+ * @param path The absolute path of the plugin without the file extension.
+ *
+ * @return The used features ("featureGroup::featureName") of the plugin at @p path ordered by their first use.
+ */
+std::vector<std::string> apl::PluginUsageProfile::getFeatures(const std::string &path) const
+{
+    auto iterator = d_ptr->plugins.find(path);
+    if(iterator == d_ptr->plugins.end())
+        return std::vector<std::string>();
+    std::vector<std::pair<std::chrono::milliseconds, std::string>> features;
+    for(const auto& feature : iterator->second.features)
+        features.emplace_back(feature.second, feature.first);
+    std::sort(features.begin(), features.end());
+    std::vector<std::string> names;
+    names.reserve(features.size());
+    for(auto& feature : features)
+        names.push_back(std::move(feature.second));
+    return names;
+}
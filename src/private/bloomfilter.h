@@ -0,0 +1,29 @@
+#ifndef APLUGINLIBRARY_BLOOMFILTER_H
+#define APLUGINLIBRARY_BLOOMFILTER_H
+
+#include <array>
+#include <cstdint>
+
+namespace apl
+{
+    namespace detail
+    {
+        /*
+         * A fixed size Bloom filter over tagged strings (the tag distinguishes e.g. feature groups from class names).
+         */
+        class BloomFilter
+        {
+        public:
+            void add(uint32_t tag, const char *string);
+            bool mightContain(uint32_t tag, const char *string) const;
+
+        private:
+            static const uint32_t bitCount = 512;
+            static const uint32_t hashCount = 3;
+
+            std::array<uint64_t, bitCount / 64> bits = {};
+        };
+    }
+}
+
+#endif //APLUGINLIBRARY_BLOOMFILTER_H
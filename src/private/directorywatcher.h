@@ -0,0 +1,76 @@
+#ifndef APLUGINLIBRARY_DIRECTORYWATCHER_H
+#define APLUGINLIBRARY_DIRECTORYWATCHER_H
+
+#include <vector>
+#include <string>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+#include "APluginLibrary/apluginlibrary_export.h"
+#include "pluginmanifestprivate.h"
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        class APLUGINLIBRARY_NO_EXPORT DirectoryWatcher
+        {
+        public:
+            typedef std::function<std::vector<std::string>(const std::vector<std::string>&)> Callback; // returns the paths to retry
+
+            DirectoryWatcher(std::chrono::milliseconds debounce, Callback callback);
+            ~DirectoryWatcher();
+
+            DirectoryWatcher(const DirectoryWatcher &other) = delete;
+            DirectoryWatcher& operator=(const DirectoryWatcher &other) = delete;
+
+            bool watch(const std::string &path, bool recursive);
+            void setCallback(Callback callback);
+            void setDebounce(std::chrono::milliseconds debounce);
+
+        private:
+            struct WatchedDirectory
+            {
+                std::string path;
+                bool recursive;
+            };
+
+            void run();
+            void deliver(std::set<std::string> &changes);
+
+            std::mutex mutex; // guards the watched directories and the debounce time
+            std::mutex callbackMutex;
+            Callback callback;
+            std::chrono::milliseconds debounce;
+#ifdef __linux__
+            bool addWatch(const std::string &path, bool recursive, std::set<std::string> *changes);
+            void readEvents(std::set<std::string> &changes);
+
+            int inotifyFd = -1;
+            int stopPipe[2] = {-1, -1};
+            std::unordered_map<int, WatchedDirectory> watches;
+#else
+            void scan(std::set<std::string> &changes);
+
+            std::condition_variable condition;
+            bool stopped = false;
+            std::vector<WatchedDirectory> directories;
+            std::map<std::string, FileStamp> stamps;
+#endif
+            std::thread thread;
+        };
+    }
+}
+
+#endif //APLUGINLIBRARY_DIRECTORYWATCHER_H
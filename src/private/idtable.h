@@ -0,0 +1,40 @@
+#ifndef APLUGINLIBRARY_IDTABLE_H
+#define APLUGINLIBRARY_IDTABLE_H
+
+#include <vector>
+
+#include "APluginLibrary/pluginid.h"
+
+namespace apl
+{
+    namespace detail
+    {
+        template<typename T, typename Id>
+        class IdTable
+        {
+        public:
+            inline Id insert(T value);
+            inline bool erase(Id id);
+            inline T get(Id id) const;
+            inline Id idAt(uint32_t index) const;
+
+            inline size_t size() const;
+            inline size_t capacity() const;
+
+        private:
+            struct Slot
+            {
+                T value;
+                uint32_t generation;
+                bool used;
+            };
+            std::vector<Slot> slots;
+            std::vector<uint32_t> freeSlots;
+            size_t count = 0;
+        };
+    }
+}
+
+#include "implementation/idtable.tpp"
+
+#endif //APLUGINLIBRARY_IDTABLE_H
@@ -0,0 +1,60 @@
+#ifndef APLUGINLIBRARY_IDTABLE_TPP
+#define APLUGINLIBRARY_IDTABLE_TPP
+
+template<typename T, typename Id>
+inline Id apl::detail::IdTable<T, Id>::insert(T value)
+{
+    uint32_t index;
+    if(freeSlots.empty()) {
+        index = static_cast<uint32_t>(slots.size());
+        slots.push_back({value, 0, true});
+    } else {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+        slots[index].value = value;
+        slots[index].used = true;
+    }
+    ++count;
+    return Id(index, slots[index].generation);
+}
+template<typename T, typename Id>
+inline bool apl::detail::IdTable<T, Id>::erase(Id id)
+{
+    if(get(id) == nullptr)
+        return false;
+    Slot& slot = slots[id.getIndex()];
+    slot.value = nullptr;
+    slot.used = false;
+    ++slot.generation; // invalidates all handed out ids for this slot
+    freeSlots.push_back(id.getIndex());
+    --count;
+    return true;
+}
+template<typename T, typename Id>
+inline T apl::detail::IdTable<T, Id>::get(Id id) const
+{
+    if(id.getIndex() >= slots.size())
+        return nullptr;
+    const Slot& slot = slots[id.getIndex()];
+    return slot.used && slot.generation == id.getGeneration() ? slot.value : nullptr;
+}
+template<typename T, typename Id>
+inline Id apl::detail::IdTable<T, Id>::idAt(uint32_t index) const
+{
+    if(index >= slots.size() || !slots[index].used)
+        return Id();
+    return Id(index, slots[index].generation);
+}
+
+template<typename T, typename Id>
+inline size_t apl::detail::IdTable<T, Id>::size() const
+{
+    return count;
+}
+template<typename T, typename Id>
+inline size_t apl::detail::IdTable<T, Id>::capacity() const
+{
+    return slots.size();
+}
+
+#endif //APLUGINLIBRARY_IDTABLE_TPP
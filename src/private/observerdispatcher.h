@@ -0,0 +1,65 @@
+#ifndef APLUGINLIBRARY_OBSERVERDISPATCHER_H
+#define APLUGINLIBRARY_OBSERVERDISPATCHER_H
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "APluginLibrary/pluginmanager.h"
+#include "APluginLibrary/pluginmanagerobserver.h"
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        struct ObserverNotification
+        {
+            PluginManagerObserver *observer;
+            std::vector<const Plugin*> plugins;
+        };
+
+        struct ObserverEvent
+        {
+            ObserverEvent *next;
+            bool loaded;
+            PluginManager *manager;
+            std::vector<Plugin*> plugins; // unloaded plugins hold one reference, which is released after delivery
+            std::vector<ObserverNotification> notifications;
+        };
+
+        class APLUGINLIBRARY_NO_EXPORT ObserverDispatcher
+        {
+        public:
+            ObserverDispatcher();
+            ~ObserverDispatcher();
+
+            void push(ObserverEvent *event);
+            void flush();
+            bool isDispatcherThread() const;
+
+            static void deliver(PluginManagerObserver *observer, bool loaded, PluginManager *manager,
+                                const std::vector<const Plugin*> &plugins);
+
+        private:
+            void run();
+            void dispatch(std::vector<ObserverEvent*> &events);
+
+            std::atomic<ObserverEvent*> head;
+            std::atomic<uint64_t> pushedCount;
+            uint64_t deliveredCount = 0;
+            bool stopped = false;
+            std::mutex mutex;
+            std::condition_variable pushedCondition, deliveredCondition;
+            std::thread thread;
+        };
+    }
+}
+
+#endif //APLUGINLIBRARY_OBSERVERDISPATCHER_H
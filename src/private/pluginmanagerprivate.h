@@ -4,10 +4,24 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <array>
+#include <functional>
+#include <thread>
 
 #include "APluginLibrary/pluginmanager.h"
 #include "APluginLibrary/pluginmanagerobserver.h"
+#include "pluginset.h"
+#include "observerdispatcher.h"
+#include "retentioncache.h"
+#include "pluginmanifestprivate.h"
+#include "bloomfilter.h"
+#include "pluginusageprofileprivate.h"
+#include "directorywatcher.h"
 
 #ifdef APLUGINLIBRARY_TEST
 # undef APLUGINLIBRARY_NO_EXPORT
@@ -18,18 +32,107 @@ namespace apl
 {
     namespace detail
     {
+        template<typename Filter>
+        struct QueryKeyHash
+        {
+            size_t operator()(const std::pair<Filter, std::string> &key) const
+            {
+                return std::hash<std::string>()(key.second) * 31 + static_cast<size_t>(key.first);
+            }
+        };
+        template<typename Filter, typename Info>
+        using QueryCache = std::unordered_map<std::pair<Filter, std::string>, std::shared_ptr<const std::vector<const Info*>>, QueryKeyHash<Filter>>;
+
+        struct ObserverSubscription
+        {
+            PluginManagerObserver *observer;
+            std::shared_ptr<const PluginQuery> filter; // nullptr if the observer is notified about all plugins
+        };
+
+        struct IndexedPlugin
+        {
+            std::shared_ptr<const ManifestEntry> entry;
+            BloomFilter filter; // feature groups and names, interface and class names
+        };
+
         class APLUGINLIBRARY_NO_EXPORT PluginManagerPrivate
         {
         public:
-            std::vector<Plugin*> plugins;
-            std::vector<PluginManagerObserver*> observers;
+            std::shared_ptr<PluginSet> set = std::make_shared<PluginSet>(); // shared by copies until modified
+            std::vector<ObserverSubscription> observers;
             std::recursive_mutex localMutex;
 
+            uint64_t generation = 0;
+            QueryCache<PluginFeatureFilter, PluginFeatureInfo> featureQueryCache;
+            QueryCache<PluginClassFilter, PluginClassInfo> classQueryCache;
+            static const size_t maxQueryCacheSize = 256;
+
+            std::shared_ptr<ObserverDispatcher> dispatcher; // nullptr if the observers are notified synchronously
+
+            std::vector<IndexedPlugin> indexedPlugins; // indexed plugins which are loaded on demand
+            std::vector<std::future<PluginManifest>> pendingIndexes; // manifests which are still built in the background
+            std::vector<std::thread> backgroundLoaders; // continue loadDirectory calls which exceeded their budget
+
+            std::unique_ptr<DirectoryWatcher> watcher; // nullptr if no directory is watched
+
+            void joinBackgroundLoaders();
+            std::vector<std::string> applyDirectoryChanges(PluginManager *manager, const std::vector<std::string> &paths);
+
+            size_t index(const PluginManifestPrivate &manifest);
+            void collectPendingIndexes();
+            bool hasIndexedPlugins();
+            void loadIndexed(PluginManager *manager, const PluginQueryPrivate &query);
+            void loadIndexed(PluginManager *manager, PluginFeatureFilter filter, const std::string &string);
+            void loadIndexed(PluginManager *manager, PluginClassFilter filter, const std::string &string);
+
+            std::unique_ptr<PluginUsageProfile> usageProfile; // nullptr if the usage isn't recorded
+            std::chrono::steady_clock::time_point usageStart;
+            std::unordered_set<const void*> recordedInfos; // features and classes recorded since the last change
+            std::unordered_map<const Plugin*, std::string> usagePaths;
+
+            void recordUsage(const std::vector<const PluginFeatureInfo*> &features);
+            void recordUsage(const std::vector<const PluginClassInfo*> &classes);
+            const std::string& usagePath(uint32_t pluginIndex);
+
+            void addObserver(PluginManagerObserver *observer, const PluginQuery *filter);
+            std::vector<ObserverNotification> notificationsFor(const std::vector<const Plugin*> &changedPlugins) const;
+            void notifyLoaded(PluginManager *manager, const std::vector<const Plugin*> &loadedPlugins);
+            void releaseUnloaded(PluginManager *manager, std::vector<Plugin*> unloadedPlugins);
+            void flushObserverEvents();
+
+            void invalidate();
+            PluginSet& mutableSet();
+            bool containsPlugin(const Plugin *plugin) const;
+            bool addPlugin(Plugin *plugin);
+            bool removePlugin(const Plugin *plugin);
+
+            IdList queryPlugins(const PluginQueryPrivate &query) const;
+            IdList queryFeatures(const PluginQueryPrivate &query) const;
+            IdList queryClasses(const PluginQueryPrivate &query) const;
+
             static std::unordered_map<std::string, std::pair<size_t, Plugin*>> allPlugins;
             static std::mutex staticMutex;
+            static std::unordered_map<const Plugin*, std::string> pluginPaths; // absolute path of every plugin in allPlugins
+            static std::unordered_map<const Plugin*, uint64_t> loadBatches; // load batch of every plugin in allPlugins
+            static uint64_t loadBatchCount;
+            static std::unordered_set<std::string> pendingPlugins; // absolute paths currently loaded or destroyed without staticMutex
+            static size_t reapingCount; // count of plugins which are destroyed by the PluginReaper
+            static std::condition_variable pendingCondition;
+            static RetentionCache retentionCache; // recently released plugins which can be loaded again instantly
+            static std::unordered_map<std::string, FileStamp> rejectedLibraries; // libraries which contain no plugin
+            static bool isRejectedLibrary(const std::string &absolutePath, const FileStamp &stamp);
+            static void updateRejectedLibrary(const std::string &absolutePath, const FileStamp &stamp, bool rejected);
+            static Plugin* reviveRetainedPlugin(const std::string &absolutePath, library_handle &handle,
+                                                std::vector<RetentionCache::Entry> &evicted);
+            static void reserveEvicted(std::vector<RetentionCache::Entry> &evicted);
+            static void destroyEvicted(std::vector<RetentionCache::Entry> &evicted);
             static Plugin* loadPlugin(std::string absolutePath);
-            static void loadPlugin(Plugin *plugin);
+            static std::vector<Plugin*> loadPlugins(const std::vector<std::string> &paths);
+            static void acquirePlugins(const std::vector<Plugin*> &plugins);
+            static void releasePlugins(const std::vector<Plugin*> &plugins);
+            static std::future<void> releasePluginsAsync(const std::vector<Plugin*> &plugins);
             static void unloadPlugin(Plugin *plugin);
+            static bool forgetRetainedPlugin(const std::string &path);
         };
     }
 
@@ -42,6 +145,10 @@ namespace apl
         std::string filterPluginInfo(const PluginInfo* info, PluginInfoFilter filter);
         const char* filterFeatureInfo(const PluginFeatureInfo* info, PluginFeatureFilter filter);
         const char* filterClassInfo(const PluginClassInfo* info, PluginClassFilter filter);
+
+        void parallelFor(size_t count, const std::function<void(size_t)> &function);
+        std::string getPluginAbsolutePath(std::string path);
+        void collectPluginPaths(const std::string &path, bool recursive, std::vector<std::string> &paths);
     }
 }
 
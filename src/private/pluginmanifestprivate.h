@@ -0,0 +1,86 @@
+#ifndef APLUGINLIBRARY_PLUGINMANIFESTPRIVATE_H
+#define APLUGINLIBRARY_PLUGINMANIFESTPRIVATE_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+#include "APluginLibrary/pluginmanifest.h"
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        struct FileStamp
+        {
+            uint64_t device, inode, size;
+            int64_t modified; // nanoseconds since the epoch
+
+            bool operator==(const FileStamp &other) const;
+            bool operator!=(const FileStamp &other) const;
+        };
+
+        struct ManifestFeatureRecord;
+        struct ManifestClassRecord;
+
+        /*
+         * The metadata of one plugin. The strings and the feature and class records are owned by storage, which is
+         * either the mapped manifest file or a buffer with the records of a freshly indexed plugin. The names can be
+         * read from the records directly, the PluginFeatureInfo's and PluginClassInfo's are only created from them when
+         * they are requested first (e.g. for a query which passed the Bloom filter of the plugin). Entries are
+         * immutable otherwise and shared by copies of a PluginManifest.
+         */
+        struct APLUGINLIBRARY_NO_EXPORT ManifestEntry
+        {
+            std::string path; // absolute path of the plugin without the file extension
+            FileStamp stamp;
+            std::shared_ptr<const void> storage;
+            PluginInfo info;
+            const ManifestFeatureRecord *featureRecords;
+            const ManifestClassRecord *classRecords;
+            uint32_t featureCount, classCount;
+            const char *strings;
+
+            const char* featureGroup(size_t index) const;
+            const char* featureName(size_t index) const;
+            const char* interfaceName(size_t index) const;
+            const char* className(size_t index) const;
+
+            const std::vector<const PluginFeatureInfo*>& getFeatureInfos() const;
+            const std::vector<const PluginClassInfo*>& getClassInfos() const;
+
+        private:
+            void createInfos() const;
+
+            mutable std::once_flag infosCreated;
+            mutable std::vector<PluginFeatureInfo> features;
+            mutable std::vector<PluginClassInfo> classes;
+            mutable std::vector<const PluginFeatureInfo*> featurePointers;
+            mutable std::vector<const PluginClassInfo*> classPointers;
+        };
+
+        class APLUGINLIBRARY_NO_EXPORT PluginManifestPrivate
+        {
+        public:
+            std::map<std::string, std::shared_ptr<const ManifestEntry>> entries;
+
+            static const PluginManifestPrivate* get(const PluginManifest &manifest);
+
+            bool read(const std::string &file);
+            bool write(const std::string &file) const;
+            static std::shared_ptr<const ManifestEntry> index(const Plugin *plugin, const std::string &path, const FileStamp &stamp);
+        };
+
+        APLUGINLIBRARY_NO_EXPORT bool stampFile(const std::string &path, FileStamp &stamp);
+    }
+}
+
+#endif //APLUGINLIBRARY_PLUGINMANIFESTPRIVATE_H
@@ -3,6 +3,9 @@
 
 #include "APluginLibrary/plugin.h"
 
+#include <vector>
+#include <unordered_map>
+
 #ifdef APLUGINLIBRARY_TEST
 # undef APLUGINLIBRARY_NO_EXPORT
 # define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
@@ -21,6 +24,13 @@ namespace apl {
             void(*initPlugin)() = nullptr;
             void(*finiPlugin)() = nullptr;
 
+            // copies of the features with a selected variant and the features of the plugin with these copies (both
+            // empty if no variant is selected)
+            std::vector<PluginFeatureInfo> selectedFeatures;
+            std::vector<const PluginFeatureInfo*> featureInfos;
+            std::unordered_map<const PluginFeatureInfo*, const PluginFeatureInfo*> selectedFeatureMap;
+
+            const PluginFeatureInfo* selectedFeature(const PluginFeatureInfo *info) const;
             void reset();
         };
     }
@@ -0,0 +1,21 @@
+#ifndef APLUGINLIBRARY_PLUGINPROBE_H
+#define APLUGINLIBRARY_PLUGINPROBE_H
+
+#include "APluginLibrary/apluginlibrary_export.h"
+
+#include <string>
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        APLUGINLIBRARY_NO_EXPORT bool mayContainPlugin(const std::string &libraryPath);
+    }
+}
+
+#endif //APLUGINLIBRARY_PLUGINPROBE_H
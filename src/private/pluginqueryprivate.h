@@ -0,0 +1,63 @@
+#ifndef APLUGINLIBRARY_PLUGINQUERYPRIVATE_H
+#define APLUGINLIBRARY_PLUGINQUERYPRIVATE_H
+
+#include <vector>
+#include <string>
+
+#include "APluginLibrary/pluginquery.h"
+#include "APluginLibrary/pluginmanager.h"
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        template<typename Filter>
+        struct StringCriterion
+        {
+            Filter filter;
+            std::string string;
+            PluginStringMatch match;
+        };
+
+        struct VersionCriterion
+        {
+            PluginInfoFilter filter;
+            PluginVersion minimum, maximum;
+        };
+
+        class APLUGINLIBRARY_NO_EXPORT PluginQueryPrivate
+        {
+        public:
+            std::vector<StringCriterion<PluginInfoFilter>> infoCriteria;
+            std::vector<VersionCriterion> versionCriteria;
+            std::vector<StringCriterion<PluginFeatureFilter>> featureCriteria;
+            std::vector<StringCriterion<PluginClassFilter>> classCriteria;
+
+            bool prepared = false;
+            bool satisfiable = true;
+
+            static const PluginQueryPrivate* get(const PluginQuery &query);
+
+            bool hasPluginCriteria() const;
+            bool matchesPlugin(const PluginInfo *info) const;
+            bool matchesFeature(const PluginFeatureInfo *info) const;
+            bool matchesClass(const PluginClassInfo *info) const;
+            bool matchesPluginContents(const Plugin *plugin) const;
+            bool matchesPluginContents(const PluginInfo *info, const PluginFeatureInfo* const* features, size_t featureCount,
+                                       const PluginClassInfo* const* classes, size_t classCount) const;
+
+            bool equals(const PluginQueryPrivate &other) const;
+        };
+
+        APLUGINLIBRARY_NO_EXPORT bool matchesString(const char *string, const std::string &pattern, PluginStringMatch match);
+        APLUGINLIBRARY_NO_EXPORT bool matchesGlob(const char *string, const char *pattern);
+        APLUGINLIBRARY_NO_EXPORT std::string globPrefix(const std::string &pattern);
+    }
+}
+
+#endif //APLUGINLIBRARY_PLUGINQUERYPRIVATE_H
@@ -0,0 +1,59 @@
+#ifndef APLUGINLIBRARY_PLUGINREAPER_H
+#define APLUGINLIBRARY_PLUGINREAPER_H
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <cstdint>
+
+#include "APluginLibrary/plugin.h"
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        struct ReapedPlugin
+        {
+            Plugin *plugin;
+            std::string absolutePath;
+            uint64_t loadBatch;
+        };
+
+        class APLUGINLIBRARY_NO_EXPORT PluginReaper
+        {
+        public:
+            static PluginReaper& instance();
+            ~PluginReaper();
+
+            std::future<void> push(std::vector<ReapedPlugin> plugins);
+
+        private:
+            struct Job
+            {
+                std::vector<ReapedPlugin> plugins;
+                std::promise<void> done;
+            };
+
+            PluginReaper();
+            void run();
+            static void reap(Job &job);
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<Job> jobs;
+            bool stopped = false;
+            std::thread thread;
+        };
+    }
+}
+
+#endif //APLUGINLIBRARY_PLUGINREAPER_H
@@ -0,0 +1,59 @@
+#ifndef APLUGINLIBRARY_PLUGINSET_H
+#define APLUGINLIBRARY_PLUGINSET_H
+
+#include <vector>
+#include <unordered_map>
+#include <array>
+
+#include "APluginLibrary/plugin.h"
+#include "APluginLibrary/pluginid.h"
+#include "idtable.h"
+#include "stringindex.h"
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        struct PluginEntry
+        {
+            PluginId id;
+            std::vector<FeatureId> featureIds;
+            std::vector<ClassId> classIds;
+        };
+
+        class APLUGINLIBRARY_NO_EXPORT PluginSet
+        {
+        public:
+            PluginSet() = default;
+            PluginSet(const PluginSet &other);
+            ~PluginSet();
+
+            PluginSet& operator=(const PluginSet &other) = delete;
+
+            std::vector<Plugin*> plugins;
+
+            std::unordered_map<const Plugin*, PluginEntry> pluginEntries;
+            std::unordered_map<const PluginFeatureInfo*, FeatureId> featureIdLookup;
+            std::unordered_map<const PluginClassInfo*, ClassId> classIdLookup;
+            IdTable<Plugin*, PluginId> pluginIds;
+            IdTable<const PluginFeatureInfo*, FeatureId> featureIds;
+            IdTable<const PluginClassInfo*, ClassId> classIds;
+
+            std::array<StringIndex, 3> pluginIndices;
+            std::array<StringIndex, 4> featureIndices;
+            std::array<StringIndex, 2> classIndices;
+            IdList featurePlugins, classPlugins; // plugin id index of every feature/class id index
+
+            bool contains(const Plugin *plugin) const;
+            bool add(Plugin *plugin);
+            bool remove(const Plugin *plugin);
+        };
+    }
+}
+
+#endif //APLUGINLIBRARY_PLUGINSET_H
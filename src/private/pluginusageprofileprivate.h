@@ -0,0 +1,35 @@
+#ifndef APLUGINLIBRARY_PLUGINUSAGEPROFILEPRIVATE_H
+#define APLUGINLIBRARY_PLUGINUSAGEPROFILEPRIVATE_H
+
+#include <map>
+#include <string>
+#include <chrono>
+
+#include "APluginLibrary/pluginusageprofile.h"
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        struct PluginUsage
+        {
+            std::chrono::milliseconds firstUse;
+            std::map<std::string, std::chrono::milliseconds> features; // first use of every used feature
+        };
+
+        class APLUGINLIBRARY_NO_EXPORT PluginUsageProfilePrivate
+        {
+        public:
+            std::map<std::string, PluginUsage> plugins;
+
+            PluginUsage& usage(const std::string &path, std::chrono::milliseconds time);
+        };
+    }
+}
+
+#endif //APLUGINLIBRARY_PLUGINUSAGEPROFILEPRIVATE_H
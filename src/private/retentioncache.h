@@ -0,0 +1,67 @@
+#ifndef APLUGINLIBRARY_RETENTIONCACHE_H
+#define APLUGINLIBRARY_RETENTIONCACHE_H
+
+#include <list>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+
+#include "APluginLibrary/pluginmanager.h"
+
+#ifdef APLUGINLIBRARY_TEST
+# undef APLUGINLIBRARY_NO_EXPORT
+# define APLUGINLIBRARY_NO_EXPORT APLUGINLIBRARY_EXPORT
+#endif
+
+namespace apl
+{
+    namespace detail
+    {
+        class APLUGINLIBRARY_NO_EXPORT RetentionCache
+        {
+        public:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Entry
+            {
+                std::string absolutePath;
+                Plugin *plugin; // the plugin itself if its finalization is deferred
+                library_handle handle; // an additional handle keeping the library mapped if the plugin is finalized
+                uint64_t loadBatch;
+                Clock::time_point retainedAt;
+                bool reserved; // absolutePath is pending while the evicted entry is destroyed
+            };
+
+            ~RetentionCache();
+
+            void configure(size_t maxSize, std::chrono::milliseconds maxAge, PluginRetentionPolicy policy,
+                           std::vector<Entry> &evicted);
+            bool retain(Plugin *plugin, const std::string &absolutePath, uint64_t loadBatch, std::vector<Entry> &evicted);
+            bool retainLibrary(library_handle handle, const std::string &absolutePath, uint64_t loadBatch,
+                               std::vector<Entry> &evicted);
+            Plugin* take(const std::string &absolutePath, uint64_t &loadBatch, library_handle &handle,
+                         std::vector<Entry> &evicted);
+            void erase(const std::string &absolutePath, std::vector<Entry> &evicted);
+            void evictExpired(std::vector<Entry> &evicted);
+            void flush(std::vector<Entry> &evicted);
+            size_t size() const;
+            bool retainsLibraries(const Plugin *plugin) const;
+
+            static void destroy(std::vector<Entry> &evicted);
+
+        private:
+            void insert(Entry entry, std::vector<Entry> &evicted);
+            void evict(std::list<Entry>::iterator iterator, std::vector<Entry> &evicted);
+
+            size_t maxSize = 0;
+            std::chrono::milliseconds maxAge = std::chrono::milliseconds::zero();
+            PluginRetentionPolicy policy = PluginRetentionPolicy::DeferFinalization;
+            std::list<Entry> entries; // least recently released first
+            std::unordered_map<std::string, std::list<Entry>::iterator> lookup;
+        };
+    }
+}
+
+#endif //APLUGINLIBRARY_RETENTIONCACHE_H
@@ -0,0 +1,39 @@
+#include "../bloomfilter.h"
+
+namespace
+{
+    /*
+     * FNV-1a of tag and string, the two halves are used for double hashing.
+     */
+    uint64_t hash(uint32_t tag, const char *string)
+    {
+        uint64_t hash = 14695981039346656037ULL ^ tag;
+        hash *= 1099511628211ULL;
+        for(; string != nullptr && *string != '\0'; ++string) {
+            hash ^= static_cast<unsigned char>(*string);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+void apl::detail::BloomFilter::add(uint32_t tag, const char *string)
+{
+    uint64_t value = hash(tag, string);
+    uint32_t h1 = static_cast<uint32_t>(value), h2 = static_cast<uint32_t>(value >> 32) | 1;
+    for(uint32_t i = 0; i < hashCount; i++) {
+        uint32_t bit = (h1 + i * h2) % bitCount;
+        bits[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+bool apl::detail::BloomFilter::mightContain(uint32_t tag, const char *string) const
+{
+    uint64_t value = hash(tag, string);
+    uint32_t h1 = static_cast<uint32_t>(value), h2 = static_cast<uint32_t>(value >> 32) | 1;
+    for(uint32_t i = 0; i < hashCount; i++) {
+        uint32_t bit = (h1 + i * h2) % bitCount;
+        if((bits[bit / 64] & (uint64_t(1) << (bit % 64))) == 0)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,251 @@
+#include "../directorywatcher.h"
+#include "../pluginmanagerprivate.h"
+
+#include <cstring>
+
+#ifdef __linux__
+# include <sys/inotify.h>
+# include <poll.h>
+# include <unistd.h>
+# include <fcntl.h>
+# include <climits>
+#endif
+
+#include "tinydir/tinydir.h"
+
+/*
+ * The DirectoryWatcher watches directories for new, changed and removed shared libraries and reports the paths
+ * (without the file extension) of all changed libraries to its callback, once no further changes happened for the
+ * debounce time. On Linux the directories are watched with inotify, so the cost is proportional to the changes, on
+ * other platforms the watched directories are rescanned every debounce interval and compared by FileStamp.
+ */
+
+namespace
+{
+    /*
+     * Returns name without the shared library extension or an empty string if name isn't a shared library.
+     */
+    std::string libraryStem(const std::string &name)
+    {
+        std::string extension = std::string(".").append(apl::LibraryLoader::libExtension());
+        if(name.size() <= extension.size() || name.compare(name.size() - extension.size(), extension.size(), extension) != 0)
+            return std::string();
+        return name.substr(0, name.size() - extension.size());
+    }
+}
+
+apl::detail::DirectoryWatcher::DirectoryWatcher(std::chrono::milliseconds debounce, Callback callback)
+    : callback(std::move(callback)), debounce(debounce)
+{
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(pipe(stopPipe) != 0)
+        stopPipe[0] = stopPipe[1] = -1;
+#endif
+    thread = std::thread(&DirectoryWatcher::run, this);
+}
+/*
+ * Stops watching, pending changes are dropped.
+ */
+apl::detail::DirectoryWatcher::~DirectoryWatcher()
+{
+#ifdef __linux__
+    char stop = 0;
+    if(stopPipe[1] >= 0 && write(stopPipe[1], &stop, 1) != 1) {
+        close(stopPipe[1]); // wakes the thread with POLLHUP
+        stopPipe[1] = -1;
+    }
+    thread.join();
+    for(int fd : {inotifyFd, stopPipe[0], stopPipe[1]}) {
+        if(fd >= 0)
+            close(fd);
+    }
+#else
+    {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+        stopped = true;
+    }
+    condition.notify_one();
+    thread.join();
+#endif
+}
+
+/*
+ * Starts watching the directory at path (and its subdirectories if recursive). Returns false if the directory can't be
+ * watched.
+ */
+bool apl::detail::DirectoryWatcher::watch(const std::string &path, bool recursive)
+{
+    std::lock_guard<std::mutex> lockGuard(mutex);
+#ifdef __linux__
+    return addWatch(path, recursive, nullptr);
+#else
+    tinydir_dir dir;
+    if(tinydir_open(&dir, path.c_str()) != 0)
+        return false;
+    tinydir_close(&dir);
+    directories.push_back({path, recursive});
+    std::set<std::string> changes;
+    scan(changes); // takes the initial stamps
+    return true;
+#endif
+}
+/*
+ * Replaces the callback, waits until a running callback returned.
+ */
+void apl::detail::DirectoryWatcher::setCallback(Callback callback)
+{
+    std::lock_guard<std::mutex> lockGuard(callbackMutex);
+    this->callback = std::move(callback);
+}
+void apl::detail::DirectoryWatcher::setDebounce(std::chrono::milliseconds debounce)
+{
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    this->debounce = debounce;
+}
+
+/*
+ * Reports changes to the callback, the paths the callback couldn't apply yet are kept in changes to be delivered again.
+ */
+void apl::detail::DirectoryWatcher::deliver(std::set<std::string> &changes)
+{
+    std::vector<std::string> paths(changes.begin(), changes.end());
+    changes.clear();
+    std::lock_guard<std::mutex> lockGuard(callbackMutex);
+    if(callback) {
+        std::vector<std::string> retryPaths = callback(paths);
+        changes.insert(retryPaths.begin(), retryPaths.end());
+    }
+}
+
+#ifdef __linux__
+/*
+ * Adds an inotify watch for path (and its subdirectories if recursive). If changes isn't nullptr, the libraries in the
+ * added directories are reported as changed (used for directories created while watching). mutex must be locked.
+ */
+bool apl::detail::DirectoryWatcher::addWatch(const std::string &path, bool recursive, std::set<std::string> *changes)
+{
+    if(inotifyFd < 0)
+        return false;
+    int wd = inotify_add_watch(inotifyFd, path.c_str(), IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+    if(wd < 0)
+        return false;
+    watches[wd] = {path, recursive};
+    tinydir_dir dir;
+    tinydir_file file;
+    if(tinydir_open(&dir, path.c_str()) != 0)
+        return true;
+    for(; dir.has_next; tinydir_next(&dir)) {
+        if(tinydir_readfile(&dir, &file) != 0 || strcmp(file.name, ".") == 0 || strcmp(file.name, "..") == 0)
+            continue;
+        if(file.is_dir && recursive) {
+            addWatch(file.path, recursive, changes);
+        } else if(!file.is_dir && changes != nullptr) {
+            std::string stem = libraryStem(file.path);
+            if(!stem.empty())
+                changes->insert(stem);
+        }
+    }
+    tinydir_close(&dir);
+    return true;
+}
+/*
+ * Reads all available inotify events and adds the changed libraries to changes.
+ */
+void apl::detail::DirectoryWatcher::readEvents(std::set<std::string> &changes)
+{
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    std::lock_guard<std::mutex> lockGuard(mutex);
+    while((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for(char *pointer = buffer; pointer < buffer + length;) {
+            const inotify_event *event = reinterpret_cast<const inotify_event*>(pointer);
+            pointer += sizeof(inotify_event) + event->len;
+            auto iterator = watches.find(event->wd);
+            if(iterator == watches.end())
+                continue;
+            if(event->mask & IN_IGNORED) {
+                watches.erase(iterator);
+                continue;
+            }
+            if(event->len == 0)
+                continue;
+            std::string path = iterator->second.path + "/" + event->name;
+            if(event->mask & IN_ISDIR) {
+                if(iterator->second.recursive && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                    addWatch(path, true, &changes);
+            } else if(!(event->mask & IN_CREATE)) { // created files are reported when they are closed after writing
+                std::string stem = libraryStem(path);
+                if(!stem.empty())
+                    changes.insert(stem);
+            }
+        }
+    }
+}
+void apl::detail::DirectoryWatcher::run()
+{
+    std::set<std::string> changes;
+    std::chrono::steady_clock::time_point lastChange;
+    while(true) {
+        int timeout = -1;
+        if(!changes.empty()) {
+            std::lock_guard<std::mutex> lockGuard(mutex);
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastChange);
+            timeout = static_cast<int>(std::max<int64_t>((debounce - elapsed).count(), 0));
+        }
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopPipe[0], POLLIN, 0}};
+        int result = poll(fds, 2, timeout);
+        if(inotifyFd < 0 || stopPipe[0] < 0 || fds[1].revents != 0)
+            return;
+        if(result > 0 && (fds[0].revents & POLLIN)) {
+            size_t count = changes.size();
+            readEvents(changes);
+            if(changes.size() != count)
+                lastChange = std::chrono::steady_clock::now();
+        } else if(result == 0 && !changes.empty()) {
+            deliver(changes);
+            lastChange = std::chrono::steady_clock::now(); // retried after the debounce time
+        }
+    }
+}
+#else
+/*
+ * Compares the stamps of all libraries in the watched directories with the previous scan. mutex must be locked.
+ */
+void apl::detail::DirectoryWatcher::scan(std::set<std::string> &changes)
+{
+    std::vector<std::string> paths;
+    for(const WatchedDirectory& directory : directories)
+        collectPluginPaths(directory.path, directory.recursive, paths);
+    std::map<std::string, FileStamp> currentStamps;
+    FileStamp stamp;
+    for(const std::string& path : paths) {
+        if(stampFile(std::string(path).append(".").append(LibraryLoader::libExtension()), stamp))
+            currentStamps.emplace(path, stamp);
+    }
+    for(const auto& entry : currentStamps) {
+        auto iterator = stamps.find(entry.first);
+        if(iterator == stamps.end() || iterator->second != entry.second)
+            changes.insert(entry.first);
+    }
+    for(const auto& entry : stamps) {
+        if(currentStamps.find(entry.first) == currentStamps.end())
+            changes.insert(entry.first);
+    }
+    stamps.swap(currentStamps);
+}
+void apl::detail::DirectoryWatcher::run()
+{
+    std::set<std::string> changes;
+    std::unique_lock<std::mutex> lock(mutex);
+    while(!condition.wait_for(lock, debounce, [&]() { return stopped; })) {
+        size_t count = changes.size();
+        scan(changes);
+        if(changes.size() == count && !changes.empty()) {
+            lock.unlock();
+            deliver(changes);
+            lock.lock();
+        }
+    }
+}
+#endif
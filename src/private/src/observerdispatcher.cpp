@@ -0,0 +1,131 @@
+#include "../observerdispatcher.h"
+#include "../pluginmanagerprivate.h"
+
+#include <algorithm>
+
+namespace
+{
+    bool isSameBatch(const apl::detail::ObserverEvent *event1, const apl::detail::ObserverEvent *event2)
+    {
+        return event1->loaded == event2->loaded && event1->manager == event2->manager;
+    }
+
+    void merge(std::vector<apl::detail::ObserverNotification> &notifications,
+               const std::vector<apl::detail::ObserverNotification> &newNotifications)
+    {
+        for(const apl::detail::ObserverNotification& newNotification : newNotifications) {
+            auto iterator = std::find_if(notifications.begin(), notifications.end(),
+                                         [&](const apl::detail::ObserverNotification &notification) {
+                return notification.observer == newNotification.observer;
+            });
+            if(iterator == notifications.end())
+                notifications.push_back(newNotification);
+            else
+                iterator->plugins.insert(iterator->plugins.end(), newNotification.plugins.begin(), newNotification.plugins.end());
+        }
+    }
+}
+
+/*
+ * Delivers the observer events of a PluginManager on a dedicated thread. Producers push events onto a lock-free stack,
+ * the dispatcher thread takes the whole stack at once and reverses it, so events are delivered in push order. Runs of
+ * consecutive events of the same kind are delivered as one batch.
+ */
+apl::detail::ObserverDispatcher::ObserverDispatcher()
+    : head(nullptr), pushedCount(0), thread(&ObserverDispatcher::run, this)
+{}
+/*
+ * Delivers all pending events and stops the dispatcher thread.
+ */
+apl::detail::ObserverDispatcher::~ObserverDispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+        stopped = true;
+    }
+    pushedCondition.notify_one();
+    thread.join();
+}
+
+void apl::detail::ObserverDispatcher::push(ObserverEvent *event)
+{
+    ++pushedCount;
+    event->next = head.load(std::memory_order_relaxed);
+    while(!head.compare_exchange_weak(event->next, event, std::memory_order_release, std::memory_order_relaxed)) {}
+
+    // the mutex is only taken to not miss the wakeup of the dispatcher thread (which checks head while holding it)
+    {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+    }
+    pushedCondition.notify_one();
+}
+/*
+ * Blocks until all events pushed before are delivered. Does nothing if called from an observer callback.
+ */
+void apl::detail::ObserverDispatcher::flush()
+{
+    if(isDispatcherThread())
+        return;
+    uint64_t count = pushedCount.load();
+    std::unique_lock<std::mutex> lock(mutex);
+    deliveredCondition.wait(lock, [&]() { return deliveredCount >= count; });
+}
+bool apl::detail::ObserverDispatcher::isDispatcherThread() const
+{
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+/*
+ * Calls pluginLoaded/pluginUnloaded for single plugins and pluginsLoaded/pluginsUnloaded for batches.
+ */
+void apl::detail::ObserverDispatcher::deliver(PluginManagerObserver *observer, bool loaded, PluginManager *manager,
+                                              const std::vector<const Plugin*> &plugins)
+{
+    if(plugins.size() == 1 && loaded)
+        observer->pluginLoaded(manager, plugins.front());
+    else if(plugins.size() == 1)
+        observer->pluginUnloaded(manager, plugins.front());
+    else if(loaded)
+        observer->pluginsLoaded(manager, plugins);
+    else
+        observer->pluginsUnloaded(manager, plugins);
+}
+
+void apl::detail::ObserverDispatcher::run()
+{
+    std::vector<ObserverEvent*> events;
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+        pushedCondition.wait(lock, [&]() { return stopped || head.load(std::memory_order_relaxed) != nullptr; });
+        ObserverEvent* event = head.exchange(nullptr, std::memory_order_acquire);
+        if(event == nullptr && stopped)
+            return;
+        lock.unlock();
+        events.clear();
+        for(; event != nullptr; event = event->next)
+            events.push_back(event);
+        std::reverse(events.begin(), events.end());
+        dispatch(events);
+        lock.lock();
+        deliveredCount += events.size();
+        deliveredCondition.notify_all();
+    }
+}
+void apl::detail::ObserverDispatcher::dispatch(std::vector<ObserverEvent*> &events)
+{
+    std::vector<ObserverNotification> notifications;
+    for(size_t begin = 0, end; begin < events.size(); begin = end) {
+        notifications.clear();
+        for(end = begin; end < events.size() && isSameBatch(events[begin], events[end]); end++)
+            merge(notifications, events[end]->notifications);
+        for(const ObserverNotification& notification : notifications)
+            deliver(notification.observer, events[begin]->loaded, events[begin]->manager, notification.plugins);
+        for(size_t i = begin; i < end; i++) {
+            if(!events[i]->loaded) {
+                for(Plugin* plugin : events[i]->plugins)
+                    PluginManagerPrivate::unloadPlugin(plugin);
+            }
+            delete events[i];
+        }
+    }
+}
@@ -1,6 +1,15 @@
 #include "../pluginmanagerprivate.h"
+#include "../pluginreaper.h"
+#include "../pluginprobe.h"
 
 #include <climits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <cstring>
+
+#include "tinydir/tinydir.h"
 
 #ifdef _WIN32
 # define realpath(N,R) _fullpath((R),(N),_MAX_PATH)
@@ -11,64 +20,855 @@
 
 std::unordered_map<std::string, std::pair<size_t, apl::Plugin*>> apl::detail::PluginManagerPrivate::allPlugins;
 std::mutex apl::detail::PluginManagerPrivate::staticMutex;
+std::unordered_map<const apl::Plugin*, std::string> apl::detail::PluginManagerPrivate::pluginPaths;
+std::unordered_map<const apl::Plugin*, uint64_t> apl::detail::PluginManagerPrivate::loadBatches;
+uint64_t apl::detail::PluginManagerPrivate::loadBatchCount = 0;
+std::unordered_set<std::string> apl::detail::PluginManagerPrivate::pendingPlugins;
+size_t apl::detail::PluginManagerPrivate::reapingCount = 0;
+std::condition_variable apl::detail::PluginManagerPrivate::pendingCondition;
+apl::detail::RetentionCache apl::detail::PluginManagerPrivate::retentionCache;
+std::unordered_map<std::string, apl::detail::FileStamp> apl::detail::PluginManagerPrivate::rejectedLibraries;
 
 namespace
 {
-    inline std::string getPluginAbsolutePath(std::string path)
+    uint32_t bloomTag(apl::PluginFeatureFilter filter)
     {
-        if(path.empty())
-            return path;
-        char buf[PATH_MAX];
-        char *res = realpath(path.append(".").append(apl::LibraryLoader::libExtension()).c_str(), buf);
-        if(res != nullptr)
-            return buf;
-        return path;
+        return static_cast<uint32_t>(filter);
+    }
+    uint32_t bloomTag(apl::PluginClassFilter filter)
+    {
+        return 16 + static_cast<uint32_t>(filter);
+    }
+    bool bloomFiltered(apl::PluginFeatureFilter filter)
+    {
+        return filter == apl::PluginFeatureFilter::FeatureGroup || filter == apl::PluginFeatureFilter::FeatureName;
+    }
+    bool bloomFiltered(apl::PluginClassFilter)
+    {
+        return true;
+    }
+    /*
+     * Returns false if filter proves that no feature (or class) fulfills the equality criteria.
+     */
+    template<typename Filter>
+    bool mightMatch(const apl::detail::BloomFilter &filter, const std::vector<apl::detail::StringCriterion<Filter>> &criteria)
+    {
+        for(const auto& criterion : criteria) {
+            if(criterion.match == apl::PluginStringMatch::Equal && bloomFiltered(criterion.filter)
+               && !filter.mightContain(bloomTag(criterion.filter), criterion.string.c_str()))
+                return false;
+        }
+        return true;
+    }
+
+    template<typename Filter, size_t N>
+    apl::detail::IdList lookup(const std::array<apl::detail::StringIndex, N> &indices,
+                               const std::vector<apl::detail::StringCriterion<Filter>> &criteria)
+    {
+        std::vector<apl::detail::IdList> lists;
+        lists.reserve(criteria.size());
+        for(const auto& criterion : criteria)
+            lists.push_back(indices[static_cast<size_t>(criterion.filter)].find(criterion.string, criterion.match));
+        return apl::detail::intersect(std::move(lists));
+    }
+    template<typename T, typename Id>
+    apl::detail::IdList allIds(const apl::detail::IdTable<T, Id> &table)
+    {
+        apl::detail::IdList ids;
+        ids.reserve(table.size());
+        for(uint32_t i = 0; i < table.capacity(); i++) {
+            if(table.idAt(i).isValid())
+                ids.push_back(i);
+        }
+        return ids;
+    }
+    apl::detail::IdList pluginsOf(const apl::detail::IdList &ids, const apl::detail::IdList &owners)
+    {
+        apl::detail::IdList plugins;
+        plugins.reserve(ids.size());
+        for(uint32_t id : ids)
+            plugins.push_back(owners[id]);
+        std::sort(plugins.begin(), plugins.end());
+        plugins.erase(std::unique(plugins.begin(), plugins.end()), plugins.end());
+        return plugins;
+    }
+    apl::detail::IdList filterByPlugins(const apl::detail::IdList &ids, const apl::detail::IdList &owners,
+                                        const apl::detail::IdList &plugins)
+    {
+        apl::detail::IdList result;
+        for(uint32_t id : ids) {
+            if(apl::detail::containsId(plugins, owners[id]))
+                result.push_back(id);
+        }
+        return result;
+    }
+
+    /*
+     * Collects the plugins fulfilling the plugin info criteria of query and optionally providing at least one
+     * feature/class which fulfills the feature/class criteria. Returns false if the plugins aren't restricted at all.
+     */
+    bool lookupPlugins(const apl::detail::PluginSet &set, const apl::detail::PluginQueryPrivate &query,
+                       bool featureProviders, bool classProviders, apl::detail::IdList &plugins)
+    {
+        std::vector<apl::detail::IdList> lists;
+        if(!query.infoCriteria.empty())
+            lists.push_back(lookup(set.pluginIndices, query.infoCriteria));
+        if(!query.versionCriteria.empty()) {
+            apl::detail::IdList ids;
+            for(uint32_t i = 0; i < set.pluginIds.capacity(); i++) {
+                const apl::Plugin* plugin = set.pluginIds.get(set.pluginIds.idAt(i));
+                if(plugin != nullptr && query.matchesPlugin(plugin->getPluginInfo()))
+                    ids.push_back(i);
+            }
+            lists.push_back(std::move(ids));
+        }
+        if(featureProviders && !query.featureCriteria.empty())
+            lists.push_back(pluginsOf(lookup(set.featureIndices, query.featureCriteria), set.featurePlugins));
+        if(classProviders && !query.classCriteria.empty())
+            lists.push_back(pluginsOf(lookup(set.classIndices, query.classCriteria), set.classPlugins));
+        if(lists.empty())
+            return false;
+        plugins = apl::detail::intersect(std::move(lists));
+        return true;
     }
 }
 
 apl::Plugin* apl::detail::PluginManagerPrivate::loadPlugin(std::string path)
 {
     std::string absolutePath = getPluginAbsolutePath(path);
-    std::lock_guard<std::mutex> lockGuard(staticMutex);
+    FileStamp stamp;
+    bool stamped = stampFile(absolutePath, stamp);
+    std::unique_lock<std::mutex> lock(staticMutex);
+    pendingCondition.wait(lock, [&]() { return pendingPlugins.find(absolutePath) == pendingPlugins.end(); });
     auto iterator = allPlugins.find(absolutePath);
     if(iterator != allPlugins.end()) {
         iterator->second.first += 1;
         return iterator->second.second;
     }
-    Plugin *plugin = Plugin::load(std::move(path)).release();
-    if(plugin != nullptr)
-        allPlugins.emplace(std::move(absolutePath), std::make_pair(1, plugin));
+    std::vector<RetentionCache::Entry> evicted;
+    library_handle retainedHandle;
+    Plugin *plugin = reviveRetainedPlugin(absolutePath, retainedHandle, evicted);
+    bool load = plugin == nullptr && (retainedHandle != nullptr || !stamped || !isRejectedLibrary(absolutePath, stamp));
+    if(load)
+        pendingPlugins.insert(absolutePath); // the plugin is initialized without staticMutex, other threads wait for it
+    reserveEvicted(evicted);
+    lock.unlock();
+    destroyEvicted(evicted);
+    if(!load)
+        return plugin;
+
+    if(retainedHandle != nullptr || mayContainPlugin(absolutePath))
+        plugin = Plugin::load(std::move(path)).release();
+    LibraryLoader::unload(retainedHandle); // the library stayed mapped until it was opened again
+
+    lock.lock();
+    if(stamped)
+        updateRejectedLibrary(absolutePath, stamp, plugin == nullptr);
+    if(plugin != nullptr) {
+        pluginPaths.emplace(plugin, absolutePath);
+        loadBatches.emplace(plugin, ++loadBatchCount);
+        allPlugins.emplace(absolutePath, std::make_pair(1, plugin));
+    }
+    pendingPlugins.erase(absolutePath);
+    lock.unlock();
+    pendingCondition.notify_all();
     return plugin;
 }
-
-void apl::detail::PluginManagerPrivate::loadPlugin(apl::Plugin* plugin)
+/*
+ * Takes the plugin at absolutePath out of the retentionCache and registers it again with one reference. Returns nullptr
+ * if the plugin isn't retained or was finalized, then handle is set to the handle which kept its shared library mapped
+ * (or nullptr) and has to be unloaded after the plugin is loaded again. Expired entries are appended to evicted.
+ * staticMutex must be locked.
+ */
+apl::Plugin* apl::detail::PluginManagerPrivate::reviveRetainedPlugin(const std::string &absolutePath, library_handle &handle,
+                                                                     std::vector<RetentionCache::Entry> &evicted)
+{
+    uint64_t loadBatch;
+    Plugin *plugin = retentionCache.take(absolutePath, loadBatch, handle, evicted);
+    if(plugin != nullptr) {
+        pluginPaths.emplace(plugin, absolutePath);
+        loadBatches.emplace(plugin, loadBatch);
+        allPlugins.emplace(absolutePath, std::make_pair(1, plugin));
+    }
+    return plugin;
+}
+/*
+ * Marks the paths of the entries evicted from the retentionCache as pending (unless they are already, e.g. because the
+ * calling thread loads them again), so they aren't loaded again until destroyEvicted is done. staticMutex must be
+ * locked.
+ */
+void apl::detail::PluginManagerPrivate::reserveEvicted(std::vector<RetentionCache::Entry> &evicted)
+{
+    for(RetentionCache::Entry& entry : evicted)
+        entry.reserved = pendingPlugins.insert(entry.absolutePath).second;
+}
+/*
+ * Destroys the entries evicted from the retentionCache (finalizes their plugins and closes their libraries) like
+ * releasePlugins destroys released plugins. staticMutex must not be locked.
+ */
+void apl::detail::PluginManagerPrivate::destroyEvicted(std::vector<RetentionCache::Entry> &evicted)
 {
-    if(plugin == nullptr)
+    if(evicted.empty())
         return;
-    std::string absolutePath = getPluginAbsolutePath(plugin->getPath());
-    staticMutex.lock();
-    auto iterator = allPlugins.find(absolutePath);
-    if(iterator != allPlugins.end())
-        iterator->second.first += 1;
+    std::vector<std::string> reservedPaths;
+    for(const RetentionCache::Entry& entry : evicted) {
+        if(entry.reserved)
+            reservedPaths.push_back(entry.absolutePath);
+    }
+    RetentionCache::destroy(evicted);
+    {
+        std::lock_guard<std::mutex> lockGuard(staticMutex);
+        for(const std::string& path : reservedPaths)
+            pendingPlugins.erase(path);
+    }
+    pendingCondition.notify_all();
+}
+
+/*
+ * Returns true if the library at absolutePath failed to load as plugin before and didn't change since (still has
+ * stamp). staticMutex must be locked.
+ */
+bool apl::detail::PluginManagerPrivate::isRejectedLibrary(const std::string &absolutePath, const FileStamp &stamp)
+{
+    auto iterator = rejectedLibraries.find(absolutePath);
+    return iterator != rejectedLibraries.end() && iterator->second == stamp;
+}
+/*
+ * Remembers (or forgets) that the library at absolutePath with stamp contains no plugin, so it isn't opened again
+ * until it changes. staticMutex must be locked.
+ */
+void apl::detail::PluginManagerPrivate::updateRejectedLibrary(const std::string &absolutePath, const FileStamp &stamp, bool rejected)
+{
+    if(rejected)
+        rejectedLibraries[absolutePath] = stamp;
     else
-        allPlugins.emplace(std::move(absolutePath), std::make_pair(1, plugin));
-    staticMutex.unlock();
+        rejectedLibraries.erase(absolutePath);
+}
+
+/*
+ * Loads the plugins at paths like loadPlugin(std::string) and returns them in the same order (nullptr for plugins which
+ * couldn't be loaded), every returned plugin holds one reference. The paths are resolved and the shared libraries which
+ * aren't loaded yet are opened in parallel, while the registry is only locked twice: once to take the already loaded
+ * plugins and to reserve the new paths (so no other thread loads them at the same time) and once to publish the
+ * results.
+ */
+std::vector<apl::Plugin*> apl::detail::PluginManagerPrivate::loadPlugins(const std::vector<std::string> &paths)
+{
+    std::vector<std::string> absolutePaths(paths.size());
+    std::vector<FileStamp> stamps(paths.size());
+    std::unique_ptr<bool[]> stamped(new bool[paths.size()]);
+    parallelFor(paths.size(), [&](size_t i) {
+        absolutePaths[i] = getPluginAbsolutePath(paths[i]);
+        stamped[i] = stampFile(absolutePaths[i], stamps[i]);
+    });
+
+    std::vector<Plugin*> plugins(paths.size(), nullptr);
+    std::unordered_map<std::string, size_t> firstIndices; // deduplicates the paths of the batch
+    std::vector<size_t> duplicates, reserved, deferred;
+    std::vector<library_handle> retainedHandles;
+    std::vector<RetentionCache::Entry> evicted;
+    std::unique_lock<std::mutex> lock(staticMutex);
+    for(size_t i = 0; i < paths.size(); i++) {
+        if(!firstIndices.emplace(absolutePaths[i], i).second) {
+            duplicates.push_back(i);
+            continue;
+        }
+        auto iterator = allPlugins.find(absolutePaths[i]);
+        if(iterator != allPlugins.end()) {
+            iterator->second.first += 1;
+            plugins[i] = iterator->second.second;
+        } else if(pendingPlugins.find(absolutePaths[i]) != pendingPlugins.end()) {
+            deferred.push_back(i); // loaded by another thread, wait for it after the own plugins are published
+        } else {
+            library_handle retainedHandle;
+            plugins[i] = reviveRetainedPlugin(absolutePaths[i], retainedHandle, evicted);
+            if(plugins[i] == nullptr && (retainedHandle != nullptr || !stamped[i] || !isRejectedLibrary(absolutePaths[i], stamps[i]))) {
+                pendingPlugins.insert(absolutePaths[i]);
+                reserved.push_back(i);
+                if(retainedHandle != nullptr)
+                    retainedHandles.push_back(retainedHandle);
+            }
+        }
+    }
+    reserveEvicted(evicted);
+    lock.unlock();
+    destroyEvicted(evicted);
+
+    parallelFor(reserved.size(), [&](size_t i) {
+        if(mayContainPlugin(absolutePaths[reserved[i]]))
+            plugins[reserved[i]] = Plugin::load(paths[reserved[i]]).release();
+    });
+    for(library_handle handle : retainedHandles)
+        LibraryLoader::unload(handle);
+
+    lock.lock();
+    uint64_t loadBatch = ++loadBatchCount;
+    for(size_t i : reserved) {
+        if(plugins[i] != nullptr) {
+            pluginPaths.emplace(plugins[i], absolutePaths[i]);
+            loadBatches.emplace(plugins[i], loadBatch);
+            allPlugins.emplace(absolutePaths[i], std::make_pair(1, plugins[i]));
+        }
+        if(stamped[i])
+            updateRejectedLibrary(absolutePaths[i], stamps[i], plugins[i] == nullptr);
+        pendingPlugins.erase(absolutePaths[i]);
+    }
+    lock.unlock();
+    pendingCondition.notify_all();
+
+    for(size_t i : deferred)
+        plugins[i] = loadPlugin(paths[i]);
+    if(!duplicates.empty()) {
+        lock.lock();
+        for(size_t i : duplicates) {
+            auto iterator = allPlugins.find(absolutePaths[i]);
+            if(iterator != allPlugins.end() && iterator->second.second == plugins[firstIndices[absolutePaths[i]]]) {
+                iterator->second.first += 1;
+                plugins[i] = iterator->second.second;
+            }
+        }
+    }
+    return plugins;
+}
+
+/*
+ * Acquires one more reference of every plugin in plugins (which must be loaded already) in one registry transaction.
+ */
+void apl::detail::PluginManagerPrivate::acquirePlugins(const std::vector<Plugin*> &plugins)
+{
+    std::lock_guard<std::mutex> lockGuard(staticMutex);
+    for(Plugin* plugin : plugins) {
+        auto pathIterator = pluginPaths.find(plugin);
+        if(pathIterator != pluginPaths.end())
+            allPlugins[pathIterator->second].first += 1;
+    }
+}
+/*
+ * Releases one reference of every plugin in plugins (in the given order) in one registry transaction and destroys the
+ * plugins without references (or moves them to the retentionCache if it is enabled). The plugins (and the entries
+ * evicted from the retentionCache) are finalized after staticMutex is unlocked, loading them again meanwhile waits
+ * until they are destroyed. If the retentionCache keeps the libraries of finalized plugins, their additional handles
+ * are opened before the plugins are destroyed and retained afterwards.
+ */
+void apl::detail::PluginManagerPrivate::releasePlugins(const std::vector<Plugin*> &plugins)
+{
+    std::vector<ReapedPlugin> destroyedPlugins;
+    std::vector<bool> retainLibraries;
+    std::vector<RetentionCache::Entry> evicted;
+    {
+        std::lock_guard<std::mutex> lockGuard(staticMutex);
+        for(Plugin* plugin : plugins) {
+            auto pathIterator = pluginPaths.find(plugin);
+            if(pathIterator == pluginPaths.end())
+                continue;
+            auto iterator = allPlugins.find(pathIterator->second);
+            if(iterator != allPlugins.end() && (iterator->second.first -= 1) == 0) {
+                if(!retentionCache.retain(plugin, pathIterator->second, loadBatches[plugin], evicted)) {
+                    destroyedPlugins.push_back({plugin, pathIterator->second, loadBatches[plugin]});
+                    retainLibraries.push_back(retentionCache.retainsLibraries(plugin));
+                    pendingPlugins.insert(pathIterator->second);
+                }
+                allPlugins.erase(iterator);
+                pluginPaths.erase(pathIterator);
+                loadBatches.erase(plugin);
+            }
+        }
+        reserveEvicted(evicted);
+    }
+    destroyEvicted(evicted);
+    if(destroyedPlugins.empty())
+        return;
+    std::vector<library_handle> handles(destroyedPlugins.size(), nullptr);
+    for(size_t i = 0; i < destroyedPlugins.size(); i++) {
+        if(retainLibraries[i])
+            handles[i] = LibraryLoader::load(destroyedPlugins[i].plugin->getPath());
+        delete destroyedPlugins[i].plugin;
+    }
+    {
+        std::lock_guard<std::mutex> lockGuard(staticMutex);
+        for(size_t i = 0; i < destroyedPlugins.size(); i++) {
+            const ReapedPlugin& destroyedPlugin = destroyedPlugins[i];
+            if(handles[i] != nullptr && retentionCache.retainLibrary(handles[i], destroyedPlugin.absolutePath,
+                                                                     destroyedPlugin.loadBatch, evicted))
+                handles[i] = nullptr;
+            pendingPlugins.erase(destroyedPlugin.absolutePath);
+        }
+        reserveEvicted(evicted);
+    }
+    pendingCondition.notify_all();
+    for(library_handle handle : handles)
+        LibraryLoader::unload(handle);
+    destroyEvicted(evicted);
+}
+/*
+ * Releases one reference of every plugin in plugins like releasePlugins, but the plugins without references are
+ * destroyed by the PluginReaper. They are removed from the registry immediately, loading them again waits until they
+ * are destroyed. If the retentionCache defers the finalization of released plugins, they are retained instead and the
+ * plugins evicted from it are destroyed by the PluginReaper too.
+ *
+ * Returns a future which gets ready after all plugins released by this call are destroyed.
+ */
+std::future<void> apl::detail::PluginManagerPrivate::releasePluginsAsync(const std::vector<Plugin*> &plugins)
+{
+    std::vector<ReapedPlugin> reapedPlugins;
+    std::vector<RetentionCache::Entry> evicted;
+    {
+        std::lock_guard<std::mutex> lockGuard(staticMutex);
+        for(Plugin* plugin : plugins) {
+            auto pathIterator = pluginPaths.find(plugin);
+            if(pathIterator == pluginPaths.end())
+                continue;
+            auto iterator = allPlugins.find(pathIterator->second);
+            if(iterator != allPlugins.end() && (iterator->second.first -= 1) == 0) {
+                if(!retentionCache.retain(plugin, pathIterator->second, loadBatches[plugin], evicted)) {
+                    reapedPlugins.push_back({plugin, pathIterator->second, loadBatches[plugin]});
+                    pendingPlugins.insert(pathIterator->second);
+                }
+                allPlugins.erase(iterator);
+                pluginPaths.erase(pathIterator);
+                loadBatches.erase(plugin);
+            }
+        }
+        reserveEvicted(evicted);
+        for(RetentionCache::Entry& entry : evicted) {
+            if(entry.reserved && entry.plugin != nullptr) { // the PluginReaper erases the pending path
+                reapedPlugins.push_back({entry.plugin, entry.absolutePath, entry.loadBatch});
+                entry.plugin = nullptr;
+                entry.reserved = false;
+            }
+        }
+        reapingCount += reapedPlugins.size();
+    }
+    destroyEvicted(evicted);
+    return PluginReaper::instance().push(std::move(reapedPlugins));
 }
 
 void apl::detail::PluginManagerPrivate::unloadPlugin(apl::Plugin* plugin)
 {
-    if(plugin == nullptr)
+    if(plugin != nullptr)
+        releasePlugins({plugin});
+}
+/*
+ * Drops the plugin at path from the retentionCache, so loading it again reads its (changed) shared library. Returns
+ * false if the plugin is still loaded (by another PluginManager or until queued observer events are delivered), as its
+ * shared library stays mapped then and loading it again would return the old plugin.
+ */
+bool apl::detail::PluginManagerPrivate::forgetRetainedPlugin(const std::string &path)
+{
+    std::string absolutePath = getPluginAbsolutePath(path);
+    std::vector<RetentionCache::Entry> evicted;
+    bool released;
+    {
+        std::lock_guard<std::mutex> lockGuard(staticMutex);
+        released = allPlugins.find(absolutePath) == allPlugins.end();
+        if(released)
+            retentionCache.erase(absolutePath, evicted);
+        reserveEvicted(evicted);
+    }
+    destroyEvicted(evicted);
+    return released;
+}
+
+/*
+ * Adds observer or replaces its filter if it is already added. Subscriptions with equal filters share one prepared
+ * query, so every distinct filter is only evaluated once per event.
+ */
+void apl::detail::PluginManagerPrivate::addObserver(PluginManagerObserver *observer, const PluginQuery *filter)
+{
+    std::shared_ptr<const PluginQuery> sharedFilter;
+    if(filter != nullptr) {
+        PluginQuery preparedFilter(*filter);
+        preparedFilter.prepare();
+        for(const ObserverSubscription& subscription : observers) {
+            if(subscription.filter != nullptr
+               && PluginQueryPrivate::get(*subscription.filter)->equals(*PluginQueryPrivate::get(preparedFilter)))
+            {
+                sharedFilter = subscription.filter;
+                break;
+            }
+        }
+        if(sharedFilter == nullptr)
+            sharedFilter = std::make_shared<const PluginQuery>(std::move(preparedFilter));
+    }
+    auto iterator = std::find_if(observers.begin(), observers.end(), [&](const ObserverSubscription &subscription) {
+        return subscription.observer == observer;
+    });
+    if(iterator != observers.end())
+        iterator->filter = std::move(sharedFilter);
+    else
+        observers.push_back({observer, std::move(sharedFilter)});
+}
+/*
+ * Returns the plugins of changedPlugins every observer has to be notified about (observers without matching plugins are
+ * omitted).
+ */
+std::vector<apl::detail::ObserverNotification> apl::detail::PluginManagerPrivate::notificationsFor(const std::vector<const Plugin*> &changedPlugins) const
+{
+    std::vector<ObserverNotification> notifications;
+    std::unordered_map<const PluginQuery*, std::vector<const Plugin*>> matchingPlugins;
+    for(const ObserverSubscription& subscription : observers) {
+        const std::vector<const Plugin*>* plugins = &changedPlugins;
+        if(subscription.filter != nullptr) {
+            auto iterator = matchingPlugins.find(subscription.filter.get());
+            if(iterator == matchingPlugins.end()) {
+                iterator = matchingPlugins.emplace(subscription.filter.get(), std::vector<const Plugin*>()).first;
+                const PluginQueryPrivate* filter = PluginQueryPrivate::get(*subscription.filter);
+                for(const Plugin* plugin : changedPlugins) {
+                    if(filter->matchesPluginContents(plugin))
+                        iterator->second.push_back(plugin);
+                }
+            }
+            plugins = &iterator->second;
+        }
+        if(!plugins->empty())
+            notifications.push_back({subscription.observer, *plugins});
+    }
+    return notifications;
+}
+
+/*
+ * Notifies the observers about loadedPlugins, synchronously or by queuing an event for the dispatcher thread.
+ */
+void apl::detail::PluginManagerPrivate::notifyLoaded(PluginManager *manager, const std::vector<const Plugin*> &loadedPlugins)
+{
+    if(loadedPlugins.empty() || observers.empty())
+        return;
+    std::vector<ObserverNotification> notifications = notificationsFor(loadedPlugins);
+    if(dispatcher == nullptr) {
+        for(const ObserverNotification& notification : notifications)
+            ObserverDispatcher::deliver(notification.observer, true, manager, notification.plugins);
+    } else if(!notifications.empty()) {
+        dispatcher->push(new ObserverEvent{nullptr, true, manager, std::vector<Plugin*>(), std::move(notifications)});
+    }
+}
+/*
+ * Notifies the observers about unloadedPlugins (which were already removed) and releases their references afterwards.
+ * If the observers are notified asynchronously, the references are released by the dispatcher thread after the
+ * delivery, so the plugins stay valid inside the callbacks.
+ */
+void apl::detail::PluginManagerPrivate::releaseUnloaded(PluginManager *manager, std::vector<Plugin*> unloadedPlugins)
+{
+    if(dispatcher == nullptr || observers.empty()) {
+        for(Plugin* plugin : unloadedPlugins) {
+            for(const ObserverNotification& notification : notificationsFor({plugin}))
+                notification.observer->pluginUnloaded(manager, plugin);
+            unloadPlugin(plugin);
+        }
+    } else if(!unloadedPlugins.empty()) {
+        std::vector<ObserverNotification> notifications = notificationsFor(std::vector<const Plugin*>(unloadedPlugins.begin(), unloadedPlugins.end()));
+        dispatcher->push(new ObserverEvent{nullptr, false, manager, std::move(unloadedPlugins), std::move(notifications)});
+    }
+}
+/*
+ * Waits until all queued observer events are delivered. Must not be called while localMutex is locked, as observers may
+ * use the PluginManager.
+ */
+void apl::detail::PluginManagerPrivate::flushObserverEvents()
+{
+    std::shared_ptr<ObserverDispatcher> currentDispatcher;
+    {
+        std::lock_guard<std::recursive_mutex> lockGuard(localMutex);
+        currentDispatcher = dispatcher;
+    }
+    if(currentDispatcher != nullptr)
+        currentDispatcher->flush();
+}
+
+
+/*
+ * Adds the plugins of manifest which aren't loaded or indexed yet to indexedPlugins and returns their count.
+ */
+size_t apl::detail::PluginManagerPrivate::index(const PluginManifestPrivate &manifest)
+{
+    std::unordered_set<std::string> paths;
+    for(const Plugin* plugin : set->plugins)
+        paths.insert(getPluginAbsolutePath(plugin->getPath()));
+    for(const IndexedPlugin& indexedPlugin : indexedPlugins)
+        paths.insert(getPluginAbsolutePath(indexedPlugin.entry->path));
+    size_t count = 0;
+    for(const auto& entry : manifest.entries) {
+        if(!paths.insert(getPluginAbsolutePath(entry.first)).second)
+            continue;
+        IndexedPlugin indexedPlugin = {entry.second, BloomFilter()};
+        const ManifestEntry &manifestEntry = *entry.second;
+        for(size_t i = 0; i < manifestEntry.featureCount; i++) {
+            indexedPlugin.filter.add(bloomTag(PluginFeatureFilter::FeatureGroup), manifestEntry.featureGroup(i));
+            indexedPlugin.filter.add(bloomTag(PluginFeatureFilter::FeatureName), manifestEntry.featureName(i));
+        }
+        for(size_t i = 0; i < manifestEntry.classCount; i++) {
+            indexedPlugin.filter.add(bloomTag(PluginClassFilter::InterfaceName), manifestEntry.interfaceName(i));
+            indexedPlugin.filter.add(bloomTag(PluginClassFilter::ClassName), manifestEntry.className(i));
+        }
+        indexedPlugins.push_back(std::move(indexedPlugin));
+        count += 1;
+    }
+    return count;
+}
+/*
+ * Waits for the manifests built in the background by loadDirectory and indexes their plugins. localMutex must be
+ * locked (the background tasks don't need it).
+ */
+void apl::detail::PluginManagerPrivate::collectPendingIndexes()
+{
+    std::vector<std::future<PluginManifest>> indexes;
+    indexes.swap(pendingIndexes);
+    for(std::future<PluginManifest>& pendingIndex : indexes) {
+        PluginManifest manifest = pendingIndex.get();
+        index(*PluginManifestPrivate::get(manifest));
+    }
+}
+/*
+ * Returns if there are indexed plugins which aren't loaded yet, after collecting the pending indexes. localMutex must
+ * be locked.
+ */
+bool apl::detail::PluginManagerPrivate::hasIndexedPlugins()
+{
+    collectPendingIndexes();
+    return !indexedPlugins.empty();
+}
+/*
+ * Loads (once) all indexed plugins which fulfill query into manager and removes them from indexedPlugins. The Bloom
+ * filters reject most plugins before their metadata is checked. localMutex must be locked.
+ */
+void apl::detail::PluginManagerPrivate::loadIndexed(PluginManager *manager, const PluginQueryPrivate &query)
+{
+    std::vector<std::string> paths;
+    auto end = std::remove_if(indexedPlugins.begin(), indexedPlugins.end(), [&](const IndexedPlugin &indexedPlugin) {
+        if(!mightMatch(indexedPlugin.filter, query.featureCriteria) || !mightMatch(indexedPlugin.filter, query.classCriteria))
+            return false;
+        const ManifestEntry &entry = *indexedPlugin.entry;
+        const std::vector<const PluginFeatureInfo*> &features = entry.getFeatureInfos();
+        const std::vector<const PluginClassInfo*> &classes = entry.getClassInfos();
+        if(!query.matchesPluginContents(&entry.info, features.data(), features.size(), classes.data(), classes.size()))
+            return false;
+        paths.push_back(entry.path);
+        return true;
+    });
+    indexedPlugins.erase(end, indexedPlugins.end());
+    if(!paths.empty())
+        manager->load(paths);
+}
+void apl::detail::PluginManagerPrivate::loadIndexed(PluginManager *manager, PluginFeatureFilter filter, const std::string &string)
+{
+    if(hasIndexedPlugins())
+        loadIndexed(manager, *PluginQueryPrivate::get(PluginQuery().where(filter, string).prepare()));
+}
+void apl::detail::PluginManagerPrivate::loadIndexed(PluginManager *manager, PluginClassFilter filter, const std::string &string)
+{
+    if(hasIndexedPlugins())
+        loadIndexed(manager, *PluginQueryPrivate::get(PluginQuery().where(filter, string).prepare()));
+}
+
+/*
+ * Records the first use of features (and of their plugins) in usageProfile, features which were recorded before are
+ * skipped cheaply. localMutex must be locked.
+ */
+void apl::detail::PluginManagerPrivate::recordUsage(const std::vector<const PluginFeatureInfo*> &features)
+{
+    if(usageProfile == nullptr)
+        return;
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - usageStart);
+    for(const PluginFeatureInfo* feature : features) {
+        if(!recordedInfos.insert(feature).second)
+            continue;
+        const std::string& path = usagePath(set->featurePlugins[set->featureIdLookup.at(feature).getIndex()]);
+        usageProfile->record(path, std::string(feature->featureGroup).append("::").append(feature->featureName), time);
+    }
+}
+void apl::detail::PluginManagerPrivate::recordUsage(const std::vector<const PluginClassInfo*> &classes)
+{
+    if(usageProfile == nullptr)
+        return;
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - usageStart);
+    for(const PluginClassInfo* classInfo : classes) {
+        if(recordedInfos.insert(classInfo).second)
+            usageProfile->record(usagePath(set->classPlugins[set->classIdLookup.at(classInfo).getIndex()]), time);
+    }
+}
+/*
+ * Returns the absolute path without the file extension of the plugin with the given PluginId index.
+ */
+const std::string& apl::detail::PluginManagerPrivate::usagePath(uint32_t pluginIndex)
+{
+    const Plugin *plugin = set->pluginIds.get(set->pluginIds.idAt(pluginIndex));
+    auto iterator = usagePaths.find(plugin);
+    if(iterator == usagePaths.end()) {
+        std::string path = getPluginAbsolutePath(plugin->getPath());
+        if(!path.empty())
+            path.erase(path.size() - 1 - strlen(LibraryLoader::libExtension()));
+        iterator = usagePaths.emplace(plugin, std::move(path)).first;
+    }
+    return iterator->second;
+}
+
+/*
+ * Waits until all plugins which are loaded in the background are loaded. localMutex must not be locked, as the
+ * background loaders need it.
+ */
+void apl::detail::PluginManagerPrivate::joinBackgroundLoaders()
+{
+    std::vector<std::thread> loaders;
+    {
+        std::lock_guard<std::recursive_mutex> lockGuard(localMutex);
+        loaders.swap(backgroundLoaders);
+    }
+    for(std::thread& loader : loaders)
+        loader.join();
+}
+/*
+ * Applies the changes reported by the watcher: unloads the plugins at paths which are loaded and loads the plugins
+ * whose shared libraries exist (so changed plugins are swapped). Plugins whose old shared library is still loaded
+ * elsewhere aren't loaded again yet, their paths are returned so the watcher delivers them again later.
+ */
+std::vector<std::string> apl::detail::PluginManagerPrivate::applyDirectoryChanges(PluginManager *manager,
+                                                                                  const std::vector<std::string> &paths)
+{
+    std::vector<std::string> loadPaths, retryPaths;
+    FileStamp stamp;
+    std::lock_guard<std::recursive_mutex> lockGuard(localMutex);
+    for(const std::string& path : paths) {
+        const Plugin *plugin = manager->getLoadedPlugin(path);
+        if(plugin != nullptr)
+            manager->unload(plugin);
+        bool released = forgetRetainedPlugin(path);
+        if(!stampFile(std::string(path).append(".").append(LibraryLoader::libExtension()), stamp))
+            continue;
+        (released ? loadPaths : retryPaths).push_back(path);
+    }
+    if(!loadPaths.empty())
+        manager->load(loadPaths);
+    return retryPaths;
+}
+void apl::detail::PluginManagerPrivate::invalidate()
+{
+    ++generation;
+    featureQueryCache.clear();
+    classQueryCache.clear();
+    recordedInfos.clear();
+    usagePaths.clear();
+}
+
+bool apl::detail::PluginManagerPrivate::containsPlugin(const Plugin *plugin) const
+{
+    return set->contains(plugin);
+}
+
+/*
+ * Returns the set of this PluginManager for modification, which is copied first if it is shared with other copies.
+ */
+apl::detail::PluginSet& apl::detail::PluginManagerPrivate::mutableSet()
+{
+    if(set.use_count() > 1)
+        set = std::make_shared<PluginSet>(*set);
+    return *set;
+}
+bool apl::detail::PluginManagerPrivate::addPlugin(apl::Plugin *plugin)
+{
+    if(plugin == nullptr || containsPlugin(plugin) || !mutableSet().add(plugin))
+        return false;
+    invalidate();
+    return true;
+}
+bool apl::detail::PluginManagerPrivate::removePlugin(const apl::Plugin *plugin)
+{
+    if(!containsPlugin(plugin) || !mutableSet().remove(plugin))
+        return false;
+    invalidate();
+    return true;
+}
+
+apl::detail::IdList apl::detail::PluginManagerPrivate::queryPlugins(const PluginQueryPrivate &query) const
+{
+    if(!query.satisfiable)
+        return IdList();
+    IdList plugins;
+    if(!lookupPlugins(*set, query, true, true, plugins))
+        return allIds(set->pluginIds);
+    return plugins;
+}
+apl::detail::IdList apl::detail::PluginManagerPrivate::queryFeatures(const PluginQueryPrivate &query) const
+{
+    if(!query.satisfiable)
+        return IdList();
+    IdList features = query.featureCriteria.empty() ? allIds(set->featureIds) : lookup(set->featureIndices, query.featureCriteria);
+    IdList plugins;
+    if(!features.empty() && lookupPlugins(*set, query, false, true, plugins))
+        features = filterByPlugins(features, set->featurePlugins, plugins);
+    return features;
+}
+apl::detail::IdList apl::detail::PluginManagerPrivate::queryClasses(const PluginQueryPrivate &query) const
+{
+    if(!query.satisfiable)
+        return IdList();
+    IdList classes = query.classCriteria.empty() ? allIds(set->classIds) : lookup(set->classIndices, query.classCriteria);
+    IdList plugins;
+    if(!classes.empty() && lookupPlugins(*set, query, true, false, plugins))
+        classes = filterByPlugins(classes, set->classPlugins, plugins);
+    return classes;
+}
+
+/*
+ * Returns the absolute path (with the file extension) of the shared library of the plugin at path, or path with the
+ * file extension if the file doesn't exist.
+ */
+std::string apl::detail::getPluginAbsolutePath(std::string path)
+{
+    if(path.empty())
+        return path;
+    char buf[PATH_MAX];
+    char *res = realpath(path.append(".").append(apl::LibraryLoader::libExtension()).c_str(), buf);
+    if(res != nullptr)
+        return buf;
+    return path;
+}
+/*
+ * Appends the paths (without the file extension) of all shared libraries in the directory at path to paths.
+ */
+void apl::detail::collectPluginPaths(const std::string &path, bool recursive, std::vector<std::string> &paths)
+{
+    tinydir_dir dir;
+    tinydir_file file;
+    std::string filePath;
+
+    tinydir_open(&dir, path.c_str());
+    while (dir.has_next) {
+        tinydir_readfile(&dir, &file);
+        filePath = file.path;
+        if(strcmp(file.name, ".") != 0 && strcmp(file.name, "..") != 0) {
+            if (file.is_dir && recursive)
+                collectPluginPaths(filePath, recursive, paths);
+            else if (!file.is_dir && strcmp(file.extension, apl::LibraryLoader::libExtension()) == 0)
+                paths.push_back(filePath.erase(filePath.size() - 1 - strlen(file.extension)));
+        }
+        tinydir_next(&dir);
+    }
+    tinydir_close(&dir);
+}
+
+/*
+ * Calls function(i) for every i in [0, count) on up to std::thread::hardware_concurrency() threads (including the
+ * calling one).
+ */
+void apl::detail::parallelFor(size_t count, const std::function<void(size_t)> &function)
+{
+    size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count);
+    if(threadCount <= 1) {
+        for(size_t i = 0; i < count; i++)
+            function(i);
         return;
-    std::string absolutePath;
-    if(!plugin->getPath().empty())
-        absolutePath = getPluginAbsolutePath(plugin->getPath());
-    staticMutex.lock();
-    auto iterator = allPlugins.find(absolutePath);
-    if(iterator != allPlugins.end() && (iterator->second.first -= 1) == 0) {
-        delete iterator->second.second;
-        allPlugins.erase(iterator);
     }
-    staticMutex.unlock();
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for(size_t i = next++; i < count; i = next++)
+            function(i);
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for(size_t i = 1; i < threadCount; i++)
+        threads.emplace_back(worker);
+    worker();
+    for(std::thread& thread : threads)
+        thread.join();
 }
 
 std::string apl::detail::filterPluginInfo(const PluginInfo *info, PluginInfoFilter filter)
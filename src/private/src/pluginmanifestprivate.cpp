@@ -0,0 +1,450 @@
+#include "../pluginmanifestprivate.h"
+
+#include <fstream>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <cstddef>
+
+#include <sys/stat.h>
+#if defined(__unix__) || defined(__APPLE__)
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#include "APluginSDK/private/namehash.h"
+
+/*
+ * A manifest file consists of a header, the entry, feature and class records and a string table at the end. All
+ * records have a size which is a multiple of 8 and strings are referenced by their offset in the string table, so the
+ * file can be mapped and used without parsing: the entries reference the mapped records and strings and only create
+ * PluginFeatureInfo's and PluginClassInfo's from them when these are requested.
+ */
+struct apl::detail::ManifestFeatureRecord
+{
+    uint32_t featureGroup, featureName, returnType, parameterList;
+    uint64_t signatureHash;
+};
+struct apl::detail::ManifestClassRecord
+{
+    uint32_t interfaceName, className;
+};
+
+namespace
+{
+    typedef apl::detail::ManifestFeatureRecord FeatureRecord;
+    typedef apl::detail::ManifestClassRecord ClassRecord;
+
+    const char manifestMagic[8] = {'A', 'P', 'L', 'M', 'N', 'F', 'S', 'T'};
+    const uint32_t manifestFormatVersion = 2;
+    const uint32_t nullString = UINT32_MAX;
+
+    struct ManifestHeader
+    {
+        char magic[8];
+        uint32_t formatVersion;
+        uint32_t entryCount;
+        uint32_t featureCount;
+        uint32_t classCount;
+        uint64_t stringsSize;
+    };
+    struct EntryRecord
+    {
+        uint64_t device, inode, size;
+        int64_t modified;
+        uint64_t apiVersion[3], pluginVersion[3];
+        uint32_t path, pluginName, language;
+        uint32_t firstFeature, featureCount, firstClass, classCount;
+        uint32_t padding;
+    };
+
+    class StringTable
+    {
+    public:
+        uint32_t add(const char *string)
+        {
+            if(string == nullptr)
+                return nullString;
+            auto iterator = offsets.emplace(string, static_cast<uint32_t>(strings.size()));
+            if(iterator.second)
+                strings.append(string).push_back('\0');
+            return iterator.first->second;
+        }
+
+        std::string strings;
+
+    private:
+        std::unordered_map<std::string, uint32_t> offsets;
+    };
+
+    const char* stringAt(const char *strings, uint32_t offset)
+    {
+        return offset == nullString ? nullptr : strings + offset;
+    }
+    bool validString(uint32_t offset, uint64_t stringsSize)
+    {
+        return offset == nullString || offset < stringsSize;
+    }
+
+    apl::APluginNameHash hashName(const char *name)
+    {
+        return name == nullptr ? 0 : apl::sdk::detail::private_APluginSDK_hashName(name);
+    }
+    void setNameHashes(apl::PluginFeatureInfo &info)
+    {
+        info.structSize = sizeof(apl::PluginFeatureInfo);
+        info.featureGroupHash = hashName(info.featureGroup);
+        info.featureNameHash = hashName(info.featureName);
+    }
+    apl::APluginNameHash signatureHash(const apl::PluginFeatureInfo *info)
+    {
+        const size_t signatureEnd = offsetof(apl::PluginFeatureInfo, signatureHash) + sizeof(apl::APluginNameHash);
+        bool hasSignature = info->pluginInfo != nullptr && info->pluginInfo->apiVersionMajor >= 5 && info->structSize >= signatureEnd;
+        return hasSignature ? info->signatureHash : 0;
+    }
+    void setNameHashes(apl::PluginClassInfo &info)
+    {
+        info.structSize = sizeof(apl::PluginClassInfo);
+        info.interfaceNameHash = hashName(info.interfaceName);
+        info.classNameHash = hashName(info.className);
+    }
+
+    std::shared_ptr<const apl::detail::ManifestEntry> makeEntry(const EntryRecord &record, const FeatureRecord *features,
+                                                                const ClassRecord *classes, const char *strings,
+                                                                std::shared_ptr<const void> storage)
+    {
+        auto entry = std::make_shared<apl::detail::ManifestEntry>();
+        entry->path = strings + record.path;
+        entry->stamp = {record.device, record.inode, record.size, record.modified};
+        entry->storage = std::move(storage);
+        entry->info = apl::PluginInfo();
+        entry->info.apiVersionMajor = record.apiVersion[0];
+        entry->info.apiVersionMinor = record.apiVersion[1];
+        entry->info.apiVersionPatch = record.apiVersion[2];
+        entry->info.pluginLanguage = static_cast<apl::APluginLanguage>(record.language);
+        entry->info.pluginName = const_cast<char*>(stringAt(strings, record.pluginName));
+        entry->info.pluginVersionMajor = record.pluginVersion[0];
+        entry->info.pluginVersionMinor = record.pluginVersion[1];
+        entry->info.pluginVersionPatch = record.pluginVersion[2];
+        entry->info.structSize = sizeof(apl::PluginInfo);
+        entry->featureRecords = features + record.firstFeature;
+        entry->classRecords = classes + record.firstClass;
+        entry->featureCount = record.featureCount;
+        entry->classCount = record.classCount;
+        entry->strings = strings;
+        return entry;
+    }
+
+    EntryRecord makeRecord(const apl::detail::FileStamp &stamp, const std::string &path, const apl::PluginInfo *info,
+                           StringTable &strings)
+    {
+        EntryRecord record = EntryRecord();
+        record.device = stamp.device;
+        record.inode = stamp.inode;
+        record.size = stamp.size;
+        record.modified = stamp.modified;
+        record.apiVersion[0] = info->apiVersionMajor;
+        record.apiVersion[1] = info->apiVersionMinor;
+        record.apiVersion[2] = info->apiVersionPatch;
+        record.pluginVersion[0] = info->pluginVersionMajor;
+        record.pluginVersion[1] = info->pluginVersionMinor;
+        record.pluginVersion[2] = info->pluginVersionPatch;
+        record.path = strings.add(path.c_str());
+        record.pluginName = strings.add(info->pluginName);
+        record.language = static_cast<uint32_t>(info->pluginLanguage);
+        return record;
+    }
+    /*
+     * Creates the record of a plugin and appends its features, classes and strings to the given tables.
+     */
+    EntryRecord makeRecord(const apl::detail::FileStamp &stamp, const std::string &path, const apl::PluginInfo *info,
+                           const apl::PluginFeatureInfo* const* features, size_t featureCount,
+                           const apl::PluginClassInfo* const* classes, size_t classCount, StringTable &strings,
+                           std::vector<FeatureRecord> &featureRecords, std::vector<ClassRecord> &classRecords)
+    {
+        EntryRecord record = makeRecord(stamp, path, info, strings);
+        record.firstFeature = static_cast<uint32_t>(featureRecords.size());
+        record.featureCount = static_cast<uint32_t>(featureCount);
+        for(size_t i = 0; i < featureCount; i++) {
+            featureRecords.push_back({strings.add(features[i]->featureGroup), strings.add(features[i]->featureName),
+                                      strings.add(features[i]->returnType), strings.add(features[i]->parameterList),
+                                      signatureHash(features[i])});
+        }
+        record.firstClass = static_cast<uint32_t>(classRecords.size());
+        record.classCount = static_cast<uint32_t>(classCount);
+        for(size_t i = 0; i < classCount; i++)
+            classRecords.push_back({strings.add(classes[i]->interfaceName), strings.add(classes[i]->className)});
+        return record;
+    }
+    /*
+     * Creates the record of an entry (from its records, without creating its infos) and appends its features, classes
+     * and strings to the given tables.
+     */
+    EntryRecord makeRecord(const apl::detail::ManifestEntry &entry, StringTable &strings,
+                           std::vector<FeatureRecord> &featureRecords, std::vector<ClassRecord> &classRecords)
+    {
+        EntryRecord record = makeRecord(entry.stamp, entry.path, &entry.info, strings);
+        record.firstFeature = static_cast<uint32_t>(featureRecords.size());
+        record.featureCount = entry.featureCount;
+        for(uint32_t i = 0; i < entry.featureCount; i++) {
+            const FeatureRecord &feature = entry.featureRecords[i];
+            featureRecords.push_back({strings.add(stringAt(entry.strings, feature.featureGroup)),
+                                      strings.add(stringAt(entry.strings, feature.featureName)),
+                                      strings.add(stringAt(entry.strings, feature.returnType)),
+                                      strings.add(stringAt(entry.strings, feature.parameterList)), feature.signatureHash});
+        }
+        record.firstClass = static_cast<uint32_t>(classRecords.size());
+        record.classCount = entry.classCount;
+        for(uint32_t i = 0; i < entry.classCount; i++) {
+            const ClassRecord &classRecord = entry.classRecords[i];
+            classRecords.push_back({strings.add(stringAt(entry.strings, classRecord.interfaceName)),
+                                    strings.add(stringAt(entry.strings, classRecord.className))});
+        }
+        return record;
+    }
+
+    /*
+     * Maps file read only (or reads it on platforms without mmap). The mapping is released with the returned pointer.
+     */
+    std::shared_ptr<const void> mapFile(const std::string &file, size_t &size)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if(fd < 0)
+            return nullptr;
+        struct stat status;
+        void *address = MAP_FAILED;
+        if(fstat(fd, &status) == 0 && status.st_size > 0) {
+            size = static_cast<size_t>(status.st_size);
+            address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if(address == MAP_FAILED)
+            return nullptr;
+        size_t mappedSize = size;
+        return std::shared_ptr<const void>(address, [mappedSize](const void *mapped) { munmap(const_cast<void*>(mapped), mappedSize); });
+#else
+        std::ifstream stream(file, std::ios::binary | std::ios::ate);
+        if(!stream)
+            return nullptr;
+        size = static_cast<size_t>(stream.tellg());
+        auto buffer = std::make_shared<std::vector<uint64_t>>(size / sizeof(uint64_t) + 1); // 8 byte aligned
+        stream.seekg(0);
+        if(size == 0 || !stream.read(reinterpret_cast<char*>(buffer->data()), size))
+            return nullptr;
+        return std::shared_ptr<const void>(buffer, buffer->data());
+#endif
+    }
+}
+
+bool apl::detail::FileStamp::operator==(const FileStamp &other) const
+{
+    return device == other.device && inode == other.inode && size == other.size && modified == other.modified;
+}
+bool apl::detail::FileStamp::operator!=(const FileStamp &other) const
+{
+    return !(*this == other);
+}
+
+const apl::detail::PluginManifestPrivate* apl::detail::PluginManifestPrivate::get(const PluginManifest &manifest)
+{
+    return manifest.d_ptr.get();
+}
+
+/*
+ * Maps the manifest file and creates the entries referencing the mapped strings. Returns false and leaves the entries
+ * empty if the file doesn't exist or isn't a valid manifest.
+ */
+bool apl::detail::PluginManifestPrivate::read(const std::string &file)
+{
+    entries.clear();
+    size_t size = 0;
+    std::shared_ptr<const void> mapping = mapFile(file, size);
+    if(mapping == nullptr || size < sizeof(ManifestHeader))
+        return false;
+    const char *data = static_cast<const char*>(mapping.get());
+    const ManifestHeader *header = reinterpret_cast<const ManifestHeader*>(data);
+    if(memcmp(header->magic, manifestMagic, sizeof(manifestMagic)) != 0 || header->formatVersion != manifestFormatVersion)
+        return false;
+    uint64_t recordsSize = sizeof(ManifestHeader) + uint64_t(header->entryCount) * sizeof(EntryRecord)
+                           + uint64_t(header->featureCount) * sizeof(FeatureRecord) + uint64_t(header->classCount) * sizeof(ClassRecord);
+    if(header->stringsSize == 0 || recordsSize + header->stringsSize != size || data[size - 1] != '\0')
+        return false;
+    const EntryRecord *records = reinterpret_cast<const EntryRecord*>(data + sizeof(ManifestHeader));
+    const FeatureRecord *features = reinterpret_cast<const FeatureRecord*>(records + header->entryCount);
+    const ClassRecord *classes = reinterpret_cast<const ClassRecord*>(features + header->featureCount);
+    const char *strings = reinterpret_cast<const char*>(classes + header->classCount);
+    for(uint32_t i = 0; i < header->entryCount; i++) {
+        const EntryRecord &record = records[i];
+        bool valid = record.path != nullString && record.path < header->stringsSize
+                     && validString(record.pluginName, header->stringsSize)
+                     && uint64_t(record.firstFeature) + record.featureCount <= header->featureCount
+                     && uint64_t(record.firstClass) + record.classCount <= header->classCount;
+        for(uint32_t j = 0; valid && j < record.featureCount; j++) {
+            const FeatureRecord &feature = features[record.firstFeature + j];
+            valid = validString(feature.featureGroup, header->stringsSize) && validString(feature.featureName, header->stringsSize)
+                    && validString(feature.returnType, header->stringsSize) && validString(feature.parameterList, header->stringsSize);
+        }
+        for(uint32_t j = 0; valid && j < record.classCount; j++) {
+            const ClassRecord &classRecord = classes[record.firstClass + j];
+            valid = validString(classRecord.interfaceName, header->stringsSize) && validString(classRecord.className, header->stringsSize);
+        }
+        if(!valid) {
+            entries.clear();
+            return false;
+        }
+        std::shared_ptr<const ManifestEntry> entry = makeEntry(record, features, classes, strings, mapping);
+        entries.emplace(entry->path, std::move(entry));
+    }
+    return true;
+}
+/*
+ * Writes all entries to a temporary file which replaces file afterwards, so readers never see a partial manifest.
+ */
+bool apl::detail::PluginManifestPrivate::write(const std::string &file) const
+{
+    ManifestHeader header = ManifestHeader();
+    memcpy(header.magic, manifestMagic, sizeof(manifestMagic));
+    header.formatVersion = manifestFormatVersion;
+    std::vector<EntryRecord> records;
+    std::vector<FeatureRecord> featureRecords;
+    std::vector<ClassRecord> classRecords;
+    StringTable strings;
+    records.reserve(entries.size());
+    for(const auto& pair : entries) {
+        records.push_back(makeRecord(*pair.second, strings, featureRecords, classRecords));
+    }
+    strings.strings.push_back('\0'); // the string table is never empty and always terminated
+    header.entryCount = static_cast<uint32_t>(records.size());
+    header.featureCount = static_cast<uint32_t>(featureRecords.size());
+    header.classCount = static_cast<uint32_t>(classRecords.size());
+    header.stringsSize = strings.strings.size();
+
+    std::string temporaryFile = file + ".tmp";
+    {
+        std::ofstream stream(temporaryFile, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(EntryRecord));
+        stream.write(reinterpret_cast<const char*>(featureRecords.data()), featureRecords.size() * sizeof(FeatureRecord));
+        stream.write(reinterpret_cast<const char*>(classRecords.data()), classRecords.size() * sizeof(ClassRecord));
+        stream.write(strings.strings.data(), strings.strings.size());
+        if(!stream.flush()) {
+            stream.close();
+            std::remove(temporaryFile.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(file.c_str());
+#endif
+    return std::rename(temporaryFile.c_str(), file.c_str()) == 0;
+}
+/*
+ * Creates an entry with copies of the metadata of plugin (records and strings like in a manifest file), so it stays
+ * valid after the plugin is unloaded.
+ */
+std::shared_ptr<const apl::detail::ManifestEntry> apl::detail::PluginManifestPrivate::index(const Plugin *plugin, const std::string &path,
+                                                                                            const FileStamp &stamp)
+{
+    struct Storage
+    {
+        std::string strings;
+        std::vector<FeatureRecord> featureRecords;
+        std::vector<ClassRecord> classRecords;
+    };
+    auto storage = std::make_shared<Storage>();
+    StringTable strings;
+    const PluginClassInfo* const* classes = plugin->getClassInfos();
+    EntryRecord record = makeRecord(stamp, path, plugin->getPluginInfo(), plugin->getFeatureInfos(), plugin->getFeatureCount(),
+                                    classes, classes == nullptr ? 0 : plugin->getClassCount(), strings,
+                                    storage->featureRecords, storage->classRecords);
+    storage->strings = std::move(strings.strings);
+    return makeEntry(record, storage->featureRecords.data(), storage->classRecords.data(), storage->strings.c_str(), storage);
+}
+
+const char* apl::detail::ManifestEntry::featureGroup(size_t index) const
+{
+    return stringAt(strings, featureRecords[index].featureGroup);
+}
+const char* apl::detail::ManifestEntry::featureName(size_t index) const
+{
+    return stringAt(strings, featureRecords[index].featureName);
+}
+const char* apl::detail::ManifestEntry::interfaceName(size_t index) const
+{
+    return stringAt(strings, classRecords[index].interfaceName);
+}
+const char* apl::detail::ManifestEntry::className(size_t index) const
+{
+    return stringAt(strings, classRecords[index].className);
+}
+/*
+ * Returns the PluginFeatureInfo's of the plugin, which are created from the records on the first call.
+ */
+const std::vector<const apl::PluginFeatureInfo*>& apl::detail::ManifestEntry::getFeatureInfos() const
+{
+    std::call_once(infosCreated, &ManifestEntry::createInfos, this);
+    return featurePointers;
+}
+/*
+ * Returns the PluginClassInfo's of the plugin, which are created from the records on the first call.
+ */
+const std::vector<const apl::PluginClassInfo*>& apl::detail::ManifestEntry::getClassInfos() const
+{
+    std::call_once(infosCreated, &ManifestEntry::createInfos, this);
+    return classPointers;
+}
+void apl::detail::ManifestEntry::createInfos() const
+{
+    features.reserve(featureCount);
+    for(uint32_t i = 0; i < featureCount; i++) {
+        const FeatureRecord &feature = featureRecords[i];
+        PluginFeatureInfo featureInfo = PluginFeatureInfo();
+        featureInfo.pluginInfo = &info;
+        featureInfo.featureGroup = stringAt(strings, feature.featureGroup);
+        featureInfo.featureName = stringAt(strings, feature.featureName);
+        featureInfo.returnType = stringAt(strings, feature.returnType);
+        featureInfo.parameterList = stringAt(strings, feature.parameterList);
+        setNameHashes(featureInfo);
+        featureInfo.signatureHash = feature.signatureHash;
+        features.push_back(featureInfo);
+    }
+    classes.reserve(classCount);
+    for(uint32_t i = 0; i < classCount; i++) {
+        const ClassRecord &classRecord = classRecords[i];
+        PluginClassInfo classInfo = PluginClassInfo();
+        classInfo.pluginInfo = &info;
+        classInfo.interfaceName = stringAt(strings, classRecord.interfaceName);
+        classInfo.className = stringAt(strings, classRecord.className);
+        setNameHashes(classInfo);
+        classes.push_back(classInfo);
+    }
+    for(const PluginFeatureInfo& feature : features)
+        featurePointers.push_back(&feature);
+    for(const PluginClassInfo& classInfo : classes)
+        classPointers.push_back(&classInfo);
+}
+
+/*
+ * Sets stamp to the identity (device and inode), size and modification time of the file at path. Returns false if the
+ * file doesn't exist.
+ */
+bool apl::detail::stampFile(const std::string &path, FileStamp &stamp)
+{
+    struct stat status;
+    if(stat(path.c_str(), &status) != 0)
+        return false;
+    stamp.device = static_cast<uint64_t>(status.st_dev);
+    stamp.inode = static_cast<uint64_t>(status.st_ino);
+    stamp.size = static_cast<uint64_t>(status.st_size);
+#if defined(__APPLE__)
+    stamp.modified = int64_t(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#elif defined(__unix__)
+    stamp.modified = int64_t(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#else
+    stamp.modified = int64_t(status.st_mtime) * 1000000000;
+#endif
+    return true;
+}
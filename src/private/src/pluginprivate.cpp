@@ -1,9 +1,21 @@
 #include "../pluginprivate.h"
 
+/*
+ * Returns the copy of info with the selected variant or info if none is selected for it.
+ */
+const apl::PluginFeatureInfo* apl::detail::PluginPrivate::selectedFeature(const PluginFeatureInfo *info) const
+{
+    auto iterator = selectedFeatureMap.find(info);
+    return iterator == selectedFeatureMap.end() ? info : iterator->second;
+}
+
 void apl::detail::PluginPrivate::reset()
 {
     libraryHandle = nullptr;
     pluginInfo = nullptr;
     initPlugin = nullptr;
     finiPlugin = nullptr;
+    selectedFeatures.clear();
+    featureInfos.clear();
+    selectedFeatureMap.clear();
 }
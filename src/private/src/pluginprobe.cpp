@@ -0,0 +1,114 @@
+#include "../pluginprobe.h"
+
+#include <cstring>
+#include <cstdint>
+
+#if defined(__linux__) || defined(__FreeBSD__)
+# include <elf.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# define APLUGINLIBRARY_PROBE_ELF
+#endif
+
+#ifdef APLUGINLIBRARY_PROBE_ELF
+namespace
+{
+    const char pluginInfoSymbol[] = "APluginSDK_getPluginInfo";
+
+    bool isNativeByteOrder(unsigned char data)
+    {
+        const uint16_t one = 1;
+        unsigned char first;
+        std::memcpy(&first, &one, 1);
+        return data == (first == 1 ? ELFDATA2LSB : ELFDATA2MSB);
+    }
+
+    /*
+     * Searches the dynamic symbol table of the ELF image for a defined pluginInfoSymbol. Returns true if the image can't
+     * be parsed (e.g. the section headers were stripped), so only libraries which certainly lack the symbol are rejected.
+     */
+    template<typename Ehdr, typename Shdr, typename Sym>
+    bool exportsPluginInfo(const unsigned char *image, size_t size)
+    {
+        if(size < sizeof(Ehdr))
+            return false;
+        Ehdr header;
+        std::memcpy(&header, image, sizeof(Ehdr));
+        if(header.e_shoff == 0 || header.e_shentsize != sizeof(Shdr) || header.e_shoff > size
+           || header.e_shnum > (size - header.e_shoff) / sizeof(Shdr))
+            return true;
+        const unsigned char *sections = image + header.e_shoff;
+        for(size_t i = 0; i < header.e_shnum; i++) {
+            Shdr symbols;
+            std::memcpy(&symbols, sections + i * sizeof(Shdr), sizeof(Shdr));
+            if(symbols.sh_type != SHT_DYNSYM)
+                continue;
+            if(symbols.sh_link >= header.e_shnum || symbols.sh_entsize != sizeof(Sym) || symbols.sh_offset > size
+               || symbols.sh_size > size - symbols.sh_offset)
+                return true;
+            Shdr strings;
+            std::memcpy(&strings, sections + symbols.sh_link * sizeof(Shdr), sizeof(Shdr));
+            if(strings.sh_offset > size || strings.sh_size > size - strings.sh_offset)
+                return true;
+            const char *names = reinterpret_cast<const char*>(image + strings.sh_offset);
+            for(size_t offset = 0; offset < symbols.sh_size; offset += sizeof(Sym)) {
+                Sym symbol;
+                std::memcpy(&symbol, image + symbols.sh_offset + offset, sizeof(Sym));
+                if(symbol.st_shndx == SHN_UNDEF || symbol.st_name >= strings.sh_size
+                   || strings.sh_size - symbol.st_name < sizeof(pluginInfoSymbol))
+                    continue;
+                if(std::memcmp(names + symbol.st_name, pluginInfoSymbol, sizeof(pluginInfoSymbol)) == 0)
+                    return true;
+            }
+            return false;
+        }
+        return false; // no dynamic symbols at all
+    }
+}
+#endif
+
+/*
+ * Cheap check if the shared library at libraryPath can contain a plugin, without loading it (which relocates the
+ * library and runs its constructors). Returns false if the library certainly doesn't export APluginSDK_getPluginInfo
+ * (or isn't a shared library at all), true if it does or if this can't be determined on this platform.
+ */
+bool apl::detail::mayContainPlugin(const std::string &libraryPath)
+{
+#ifdef APLUGINLIBRARY_PROBE_ELF
+    int fd = open(libraryPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return true; // let the loader report the error
+    struct stat status = {};
+    if(fstat(fd, &status) != 0) {
+        close(fd);
+        return true;
+    } else if(status.st_size < EI_NIDENT) {
+        close(fd);
+        return false; // too small for a shared library
+    }
+    auto size = static_cast<size_t>(status.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return true;
+    auto image = static_cast<const unsigned char*>(mapping);
+    bool result;
+    if(std::memcmp(image, ELFMAG, SELFMAG) != 0)
+        result = false; // the dynamic loader only opens ELF files
+    else if(!isNativeByteOrder(image[EI_DATA]))
+        result = true;
+    else if(image[EI_CLASS] == ELFCLASS64)
+        result = exportsPluginInfo<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(image, size);
+    else if(image[EI_CLASS] == ELFCLASS32)
+        result = exportsPluginInfo<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(image, size);
+    else
+        result = true;
+    munmap(mapping, size);
+    return result;
+#else
+    (void) libraryPath;
+    return true;
+#endif
+}
@@ -0,0 +1,83 @@
+#include "../pluginreaper.h"
+#include "../pluginmanagerprivate.h"
+
+#include <algorithm>
+
+/*
+ * The PluginReaper destroys released plugins (runs their fini functions and closes their shared libraries) on a
+ * background thread. Plugins loaded in the same batch are destroyed in parallel, the batches are destroyed in reverse
+ * loading order, so plugins loaded later are always destroyed before the plugins they could depend on.
+ */
+
+apl::detail::PluginReaper& apl::detail::PluginReaper::instance()
+{
+    static PluginReaper reaper;
+    return reaper;
+}
+
+apl::detail::PluginReaper::PluginReaper()
+    : thread(&PluginReaper::run, this)
+{}
+/*
+ * Destroys all pending plugins and stops the reaper thread.
+ */
+apl::detail::PluginReaper::~PluginReaper()
+{
+    {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+        stopped = true;
+    }
+    condition.notify_one();
+    thread.join();
+}
+
+/*
+ * Queues plugins (whose references were all released) for destruction. The returned future gets ready after all of
+ * them are destroyed.
+ */
+std::future<void> apl::detail::PluginReaper::push(std::vector<ReapedPlugin> plugins)
+{
+    Job job;
+    job.plugins = std::move(plugins);
+    std::future<void> future = job.done.get_future();
+    {
+        std::lock_guard<std::mutex> lockGuard(mutex);
+        jobs.push_back(std::move(job));
+    }
+    condition.notify_one();
+    return future;
+}
+
+void apl::detail::PluginReaper::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+        condition.wait(lock, [&]() { return stopped || !jobs.empty(); });
+        if(jobs.empty())
+            return;
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        reap(job);
+        lock.lock();
+    }
+}
+void apl::detail::PluginReaper::reap(Job &job)
+{
+    std::vector<ReapedPlugin>& plugins = job.plugins;
+    std::stable_sort(plugins.begin(), plugins.end(), [](const ReapedPlugin &p1, const ReapedPlugin &p2) {
+        return p1.loadBatch > p2.loadBatch;
+    });
+    for(size_t begin = 0, end; begin < plugins.size(); begin = end) {
+        for(end = begin; end < plugins.size() && plugins[end].loadBatch == plugins[begin].loadBatch; end++);
+        parallelFor(end - begin, [&](size_t i) { delete plugins[begin + i].plugin; });
+    }
+    job.done.set_value(); // before reapingCount is decreased, so waitForPendingUnloads implies ready futures
+    {
+        std::lock_guard<std::mutex> lockGuard(PluginManagerPrivate::staticMutex);
+        for(const ReapedPlugin& plugin : plugins)
+            PluginManagerPrivate::pendingPlugins.erase(plugin.absolutePath);
+        PluginManagerPrivate::reapingCount -= plugins.size();
+    }
+    PluginManagerPrivate::pendingCondition.notify_all();
+}
@@ -0,0 +1,109 @@
+#include "../pluginset.h"
+#include "../pluginmanagerprivate.h"
+
+#include <algorithm>
+
+/*
+ * A PluginSet holds the plugins of one or more PluginManager's together with their ids and indices. PluginManager
+ * copies share the same set and only copy it on their first modification (copy on write). The set holds one reference
+ * of every contained plugin in the global registry, so a shared set needs one reference per plugin, no matter by how
+ * many PluginManager's it is shared.
+ */
+
+/*
+ * Copies other and acquires one reference of every contained plugin at once.
+ */
+apl::detail::PluginSet::PluginSet(const PluginSet &other)
+    : plugins(other.plugins), pluginEntries(other.pluginEntries), featureIdLookup(other.featureIdLookup),
+      classIdLookup(other.classIdLookup), pluginIds(other.pluginIds), featureIds(other.featureIds),
+      classIds(other.classIds), pluginIndices(other.pluginIndices), featureIndices(other.featureIndices),
+      classIndices(other.classIndices), featurePlugins(other.featurePlugins), classPlugins(other.classPlugins)
+{
+    PluginManagerPrivate::acquirePlugins(plugins);
+}
+/*
+ * Releases the references of all contained plugins in reverse loading order.
+ */
+apl::detail::PluginSet::~PluginSet()
+{
+    std::reverse(plugins.begin(), plugins.end());
+    PluginManagerPrivate::releasePlugins(plugins);
+}
+
+bool apl::detail::PluginSet::contains(const Plugin *plugin) const
+{
+    return pluginEntries.find(plugin) != pluginEntries.end();
+}
+
+/*
+ * Adds plugin and takes over one reference of it. Returns false (and doesn't take the reference) if plugin is already
+ * contained.
+ */
+bool apl::detail::PluginSet::add(apl::Plugin *plugin)
+{
+    if(plugin == nullptr || contains(plugin))
+        return false;
+    PluginEntry entry;
+    entry.id = pluginIds.insert(plugin);
+    uint32_t pluginIndex = entry.id.getIndex();
+    for(size_t filter = 0; filter < pluginIndices.size(); filter++)
+        pluginIndices[filter].insert(filterPluginInfo(plugin->getPluginInfo(), static_cast<PluginInfoFilter>(filter)), pluginIndex);
+    const PluginFeatureInfo* const* featureInfos = plugin->getFeatureInfos();
+    entry.featureIds.reserve(plugin->getFeatureCount());
+    for(size_t i = 0; i < plugin->getFeatureCount(); i++) {
+        FeatureId id = featureIds.insert(featureInfos[i]);
+        entry.featureIds.push_back(id);
+        featureIdLookup.emplace(featureInfos[i], id);
+        for(size_t filter = 0; filter < featureIndices.size(); filter++)
+            featureIndices[filter].insert(filterFeatureInfo(featureInfos[i], static_cast<PluginFeatureFilter>(filter)), id.getIndex());
+        featurePlugins.resize(featureIds.capacity());
+        featurePlugins[id.getIndex()] = pluginIndex;
+    }
+    const PluginClassInfo* const* classInfos = plugin->getClassInfos();
+    entry.classIds.reserve(plugin->getClassCount());
+    for(size_t i = 0; i < plugin->getClassCount(); i++) {
+        ClassId id = classIds.insert(classInfos[i]);
+        entry.classIds.push_back(id);
+        classIdLookup.emplace(classInfos[i], id);
+        for(size_t filter = 0; filter < classIndices.size(); filter++)
+            classIndices[filter].insert(filterClassInfo(classInfos[i], static_cast<PluginClassFilter>(filter)), id.getIndex());
+        classPlugins.resize(classIds.capacity());
+        classPlugins[id.getIndex()] = pluginIndex;
+    }
+    pluginEntries.emplace(plugin, std::move(entry));
+    plugins.push_back(plugin);
+    return true;
+}
+
+/*
+ * Removes plugin, the reference held by this set is passed to the caller.
+ */
+bool apl::detail::PluginSet::remove(const apl::Plugin *plugin)
+{
+    auto entryIterator = pluginEntries.find(plugin);
+    if(entryIterator == pluginEntries.end())
+        return false;
+    const PluginEntry& entry = entryIterator->second;
+    for(FeatureId id : entry.featureIds) {
+        const PluginFeatureInfo* info = featureIds.get(id);
+        for(size_t filter = 0; filter < featureIndices.size(); filter++)
+            featureIndices[filter].erase(filterFeatureInfo(info, static_cast<PluginFeatureFilter>(filter)), id.getIndex());
+        featureIdLookup.erase(info);
+        featureIds.erase(id);
+    }
+    for(ClassId id : entry.classIds) {
+        const PluginClassInfo* info = classIds.get(id);
+        for(size_t filter = 0; filter < classIndices.size(); filter++)
+            classIndices[filter].erase(filterClassInfo(info, static_cast<PluginClassFilter>(filter)), id.getIndex());
+        classIdLookup.erase(info);
+        classIds.erase(id);
+    }
+    for(size_t filter = 0; filter < pluginIndices.size(); filter++)
+        pluginIndices[filter].erase(filterPluginInfo(plugin->getPluginInfo(), static_cast<PluginInfoFilter>(filter)), entry.id.getIndex());
+    pluginIds.erase(entry.id);
+    pluginEntries.erase(entryIterator);
+    // plugins are mostly removed in reverse loading order (unloadAll), so search from the back
+    auto iterator = std::find(plugins.rbegin(), plugins.rend(), plugin);
+    plugins.erase(std::next(iterator).base());
+    return true;
+}
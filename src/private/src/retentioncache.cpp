@@ -0,0 +1,142 @@
+#include "../retentioncache.h"
+
+/*
+ * The RetentionCache keeps recently released plugins, so loading them again soon after doesn't need to open, relocate
+ * and initialize their shared libraries again. Depending on the PluginRetentionPolicy, either the whole plugin is kept
+ * (its fini function isn't called until it is evicted) or the plugin is finalized and only an additional handle of its
+ * shared library is kept, so it stays mapped.
+ *
+ * The cache is bounded by size and by age, entries are evicted in LRU order. Expired entries are evicted lazily when
+ * the cache is used. It is guarded by PluginManagerPrivate::staticMutex, but never finalizes plugins or opens and
+ * closes libraries itself: evicted entries are handed to the caller, which destroys them after unlocking.
+ */
+
+apl::detail::RetentionCache::~RetentionCache()
+{
+    std::vector<Entry> evicted;
+    flush(evicted);
+    destroy(evicted);
+}
+
+/*
+ * A maxSize of 0 disables the cache, a maxAge of 0 means no age limit. Entries exceeding the new limits are evicted.
+ */
+void apl::detail::RetentionCache::configure(size_t maxSize, std::chrono::milliseconds maxAge, PluginRetentionPolicy policy,
+                                            std::vector<Entry> &evicted)
+{
+    this->maxSize = maxSize;
+    this->maxAge = maxAge;
+    this->policy = policy;
+    while(entries.size() > maxSize)
+        evict(entries.begin(), evicted);
+    evictExpired(evicted);
+}
+
+/*
+ * Retains the released plugin if the cache defers finalization. Returns false otherwise, the caller has to destroy the
+ * plugin then (and may keep its library with retainLibrary if retainsLibraries).
+ */
+bool apl::detail::RetentionCache::retain(Plugin *plugin, const std::string &absolutePath, uint64_t loadBatch,
+                                         std::vector<Entry> &evicted)
+{
+    if(maxSize == 0 || policy != PluginRetentionPolicy::DeferFinalization)
+        return false;
+    insert({absolutePath, plugin, nullptr, loadBatch, Clock::now(), false}, evicted);
+    return true;
+}
+/*
+ * Retains the additional handle of the shared library of a finalized plugin. Returns false if the cache doesn't keep
+ * libraries (anymore), the caller has to unload the handle then.
+ */
+bool apl::detail::RetentionCache::retainLibrary(library_handle handle, const std::string &absolutePath,
+                                                uint64_t loadBatch, std::vector<Entry> &evicted)
+{
+    if(maxSize == 0 || policy != PluginRetentionPolicy::Finalize)
+        return false;
+    insert({absolutePath, nullptr, handle, loadBatch, Clock::now(), false}, evicted);
+    return true;
+}
+/*
+ * Removes the entry of absolutePath and returns the retained plugin (with its loadBatch) if its finalization was
+ * deferred. If only the shared library was kept mapped, nullptr is returned and handle is set to the additional handle,
+ * which the caller has to unload after loading the plugin again.
+ */
+apl::Plugin* apl::detail::RetentionCache::take(const std::string &absolutePath, uint64_t &loadBatch, library_handle &handle,
+                                               std::vector<Entry> &evicted)
+{
+    handle = nullptr;
+    evictExpired(evicted);
+    auto iterator = lookup.find(absolutePath);
+    if(iterator == lookup.end())
+        return nullptr;
+    Plugin* plugin = iterator->second->plugin;
+    loadBatch = iterator->second->loadBatch;
+    handle = iterator->second->handle;
+    entries.erase(iterator->second);
+    lookup.erase(iterator);
+    return plugin;
+}
+
+/*
+ * Evicts the entry of absolutePath, e.g. because its shared library changed.
+ */
+void apl::detail::RetentionCache::erase(const std::string &absolutePath, std::vector<Entry> &evicted)
+{
+    auto iterator = lookup.find(absolutePath);
+    if(iterator != lookup.end())
+        evict(iterator->second, evicted);
+}
+void apl::detail::RetentionCache::evictExpired(std::vector<Entry> &evicted)
+{
+    if(maxAge == std::chrono::milliseconds::zero())
+        return;
+    Clock::time_point oldest = Clock::now() - maxAge;
+    while(!entries.empty() && entries.front().retainedAt < oldest)
+        evict(entries.begin(), evicted);
+}
+void apl::detail::RetentionCache::flush(std::vector<Entry> &evicted)
+{
+    while(!entries.empty())
+        evict(entries.begin(), evicted);
+}
+size_t apl::detail::RetentionCache::size() const
+{
+    return entries.size();
+}
+/*
+ * Returns true if the shared library of plugin should be kept mapped with retainLibrary after it is finalized.
+ */
+bool apl::detail::RetentionCache::retainsLibraries(const Plugin *plugin) const
+{
+    return maxSize != 0 && policy == PluginRetentionPolicy::Finalize && !plugin->getPath().empty();
+}
+
+/*
+ * Destroys the evicted plugins and unloads the evicted handles (finalizes plugins and closes libraries).
+ */
+void apl::detail::RetentionCache::destroy(std::vector<Entry> &evicted)
+{
+    for(Entry& entry : evicted) {
+        delete entry.plugin;
+        LibraryLoader::unload(entry.handle);
+    }
+    evicted.clear();
+}
+
+void apl::detail::RetentionCache::insert(Entry entry, std::vector<Entry> &evicted)
+{
+    auto iterator = lookup.find(entry.absolutePath);
+    if(iterator != lookup.end())
+        evict(iterator->second, evicted);
+    entries.push_back(std::move(entry));
+    lookup.emplace(entries.back().absolutePath, std::prev(entries.end()));
+    while(entries.size() > maxSize)
+        evict(entries.begin(), evicted);
+    evictExpired(evicted);
+}
+void apl::detail::RetentionCache::evict(std::list<Entry>::iterator iterator, std::vector<Entry> &evicted)
+{
+    lookup.erase(iterator->absolutePath);
+    evicted.push_back(std::move(*iterator));
+    entries.erase(iterator);
+}
@@ -0,0 +1,99 @@
+#include "../stringindex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+void apl::detail::StringIndex::insert(const std::string &key, uint32_t id)
+{
+    IdList& ids = entries[key];
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+}
+void apl::detail::StringIndex::erase(const std::string &key, uint32_t id)
+{
+    auto iterator = entries.find(key);
+    if(iterator == entries.end())
+        return;
+    IdList& ids = iterator->second;
+    auto idIterator = std::lower_bound(ids.begin(), ids.end(), id);
+    if(idIterator != ids.end() && *idIterator == id)
+        ids.erase(idIterator);
+    if(ids.empty())
+        entries.erase(iterator);
+}
+
+apl::detail::IdList apl::detail::StringIndex::find(const std::string &pattern, PluginStringMatch match) const
+{
+    if(match == PluginStringMatch::Equal)
+        return findEqual(pattern);
+    else if(match == PluginStringMatch::Prefix)
+        return findPrefix(pattern);
+    else if(match == PluginStringMatch::Glob)
+        return findGlob(pattern);
+    else
+        throw std::runtime_error("Unsupported apl::PluginStringMatch");
+}
+
+apl::detail::IdList apl::detail::StringIndex::findEqual(const std::string &key) const
+{
+    auto iterator = entries.find(key);
+    return iterator == entries.end() ? IdList() : iterator->second;
+}
+apl::detail::IdList apl::detail::StringIndex::findPrefix(const std::string &prefix) const
+{
+    IdList ids;
+    // the keys are sorted, so all keys starting with prefix are in one consecutive range
+    for(auto iterator = entries.lower_bound(prefix);
+        iterator != entries.end() && iterator->first.compare(0, prefix.size(), prefix) == 0; ++iterator)
+    {
+        ids.insert(ids.end(), iterator->second.begin(), iterator->second.end());
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+apl::detail::IdList apl::detail::StringIndex::findGlob(const std::string &pattern) const
+{
+    IdList ids;
+    // only the keys starting with the literal prefix of the pattern can match, so only this range is checked
+    std::string prefix = globPrefix(pattern);
+    for(auto iterator = entries.lower_bound(prefix);
+        iterator != entries.end() && iterator->first.compare(0, prefix.size(), prefix) == 0; ++iterator)
+    {
+        if(matchesGlob(iterator->first.c_str(), pattern.c_str()))
+            ids.insert(ids.end(), iterator->second.begin(), iterator->second.end());
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+/*
+ * Intersects sorted id lists, starting with the smallest one. Much larger lists are probed with binary search instead
+ * of being merged, so the cost is bound by the size of the smallest list.
+ */
+apl::detail::IdList apl::detail::intersect(std::vector<IdList> lists)
+{
+    if(lists.empty())
+        return IdList();
+    std::sort(lists.begin(), lists.end(), [](const IdList &l1, const IdList &l2) { return l1.size() < l2.size(); });
+    IdList result = std::move(lists.front()), tmp;
+    for(size_t i = 1; i < lists.size() && !result.empty(); i++) {
+        const IdList& list = lists[i];
+        tmp.clear();
+        if(list.size() / 8 > result.size()) {
+            for(uint32_t id : result) {
+                if(containsId(list, id))
+                    tmp.push_back(id);
+            }
+        } else {
+            std::set_intersection(result.begin(), result.end(), list.begin(), list.end(), std::back_inserter(tmp));
+        }
+        result.swap(tmp);
+    }
+    return result;
+}
+bool apl::detail::containsId(const IdList &list, uint32_t id)
+{
+    return std::binary_search(list.begin(), list.end(), id);
+}
@@ -0,0 +1,38 @@
+#ifndef APLUGINLIBRARY_STRINGINDEX_H
+#define APLUGINLIBRARY_STRINGINDEX_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "pluginqueryprivate.h"
+
+namespace apl
+{
+    namespace detail
+    {
+        typedef std::vector<uint32_t> IdList;
+
+        class StringIndex
+        {
+        public:
+            void insert(const std::string &key, uint32_t id);
+            void erase(const std::string &key, uint32_t id);
+
+            IdList find(const std::string &pattern, PluginStringMatch match) const;
+
+        private:
+            IdList findEqual(const std::string &key) const;
+            IdList findPrefix(const std::string &prefix) const;
+            IdList findGlob(const std::string &pattern) const;
+
+            std::map<std::string, IdList> entries;
+        };
+
+        IdList intersect(std::vector<IdList> lists);
+        bool containsId(const IdList &list, uint32_t id);
+    }
+}
+
+#endif //APLUGINLIBRARY_STRINGINDEX_H
@@ -8,6 +8,15 @@ A_PLUGIN_REGISTER_FEATURE(int, first_group1, feature1, int x1, int x2)
     return x1 * x2;
 }
 
+A_PLUGIN_REGISTER_FEATURE_VARIANT(SSE2, int, first_group1, feature1, int x1, int x2)
+{
+    return x1 * x2;
+}
+A_PLUGIN_REGISTER_FEATURE_VARIANT(AVX2, int, first_group1, feature1, int x1, int x2)
+{
+    return x1 * x2;
+}
+
 A_PLUGIN_REGISTER_FEATURE(struct APluginLibrary_Test_PointStruct, first_group1, feature2, int y, int x)
 {
     struct APluginLibrary_Test_PointStruct tmp = {.x = x, .y = y};
@@ -20,6 +29,8 @@ A_PLUGIN_INIT
     A_PLUGIN_SET_VERSION(9, 87, 789);
     A_PLUGIN_RECORD_FEATURE(first_group1, feature1);
     A_PLUGIN_RECORD_FEATURE(first_group1, feature2);
+    A_PLUGIN_RECORD_FEATURE_VARIANT(SSE2, first_group1, feature1);
+    A_PLUGIN_RECORD_FEATURE_VARIANT(AVX2, first_group1, feature1);
     firstPluginInitStatusString = "first plugin -> initialized";
 }
 
@@ -13,6 +13,14 @@ A_PLUGIN_REGISTER_FEATURE(int, sixth_group_math, feature_mul, int x1, int x2)
 {
     return x1 * x2;
 }
+A_PLUGIN_REGISTER_FEATURE_VARIANT(SSE4_2, int, sixth_group_math, feature_mul, int x1, int x2)
+{
+    return x1 * x2;
+}
+A_PLUGIN_REGISTER_FEATURE_VARIANT(AVX512F, int, sixth_group_math, feature_mul, int x1, int x2)
+{
+    return x1 * x2;
+}
 A_PLUGIN_REGISTER_FEATURE(int, sixth_group_math, feature_div, int x1, int x2)
 {
     return x1 / x2;
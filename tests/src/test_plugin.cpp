@@ -1,12 +1,22 @@
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
 #include "APluginLibrary/plugin.h"
 
 #include "APluginSDK/pluginapi.h"
+#include "APluginSDK/private/privateplugininfos.h"
 
 #include "../plugins/interface.h"
 #include "../plugins/include.h"
 
+A_PLUGIN_SIGNATURE_TYPE(afl::APluginLibrary_Test_PointStruct, APluginLibrary_Test_PointStruct);
+
 extern const char* integratedPluginInitStatusString;
 
 GTEST_TEST(Test_Plugin, load_unload_extern)
@@ -333,6 +343,43 @@ GTEST_TEST(Test_Plugin, class_loading_multiple)
 
 
 
+GTEST_TEST(Test_Plugin, class_instance_functions)
+{
+    std::unique_ptr<apl::Plugin> plugin = apl::Plugin::load("plugins/third/third_plugin");
+    ASSERT_NE(plugin, nullptr);
+    const apl::PluginClassInfo* info = plugin->getClassInfo(0);
+    ASSERT_TRUE(apl::hasInstanceFunctions(info));
+    ASSERT_GE(info->instanceSize, sizeof(Interface));
+    ASSERT_GE(info->instanceAlignment, alignof(Interface));
+
+    // construct in storage of the host
+    alignas(std::max_align_t) unsigned char storage[256];
+    ASSERT_LE(info->instanceSize, sizeof(storage));
+    Interface* interface = apl::constructInstance<Interface>(info, storage);
+    ASSERT_EQ(static_cast<void*>(interface), static_cast<void*>(storage));
+    ASSERT_EQ(interface->function1(5, 7), 35);
+    ASSERT_EQ(interface->function2(5), 25);
+    apl::destroyInstance(info, interface);
+
+    // create many instances at once
+    std::vector<Interface*> instances(10000, nullptr);
+    ASSERT_EQ(apl::createInstances(info, instances.size(), instances.data()), instances.size());
+    for(size_t i = 0; i < instances.size(); i++) {
+        ASSERT_NE(instances[i], nullptr);
+        ASSERT_EQ(instances[i]->function2(static_cast<int>(i % 100)), static_cast<int>((i % 100) * (i % 100)));
+    }
+    ASSERT_EQ(reinterpret_cast<char*>(instances[1]) - reinterpret_cast<char*>(instances[0]), info->instanceSize);
+    apl::deleteInstances(info, instances.data(), instances.size());
+    ASSERT_EQ(apl::createInstances<Interface>(info, 0, instances.data()), 0);
+
+    // infos without instance functions (e.g. from older plugins)
+    apl::PluginClassInfo copy = *info;
+    copy.structSize = offsetof(apl::PluginClassInfo, instanceSize);
+    ASSERT_FALSE(apl::hasInstanceFunctions(&copy));
+    ASSERT_EQ(apl::constructInstance<Interface>(&copy, storage), nullptr);
+    ASSERT_EQ(apl::createInstances(&copy, instances.size(), instances.data()), 0);
+}
+
 GTEST_TEST(Test_Plugin, feature_and_class_loading_single)
 {
     apl::Plugin* plugin = apl::Plugin::load("plugins/fifth/fifth_plugin").release();
@@ -449,3 +496,177 @@ GTEST_TEST(Test_Plugin, feature_and_class_loading_multiple)
 
     delete plugin;
 }
+
+GTEST_TEST(Test_Plugin, findFeature_findClass)
+{
+    ASSERT_EQ(apl::sdk::detail::private_APluginSDK_hashName(""), 0xcbf29ce484222325ULL);
+    ASSERT_EQ(apl::sdk::detail::private_APluginSDK_hashName("a"), 0xaf63dc4c8601ec8cULL);
+
+    // C plugin (hashes computed on registration)
+    std::unique_ptr<apl::Plugin> plugin = apl::Plugin::load("plugins/first/first_plugin");
+    ASSERT_NE(plugin, nullptr);
+    const apl::PluginFeatureInfo *feature = plugin->findFeature("first_group1", "feature2");
+    ASSERT_NE(feature, nullptr);
+    ASSERT_STREQ(feature->featureName, "feature2");
+    ASSERT_EQ(feature->structSize, sizeof(apl::PluginFeatureInfo));
+    ASSERT_EQ(feature->featureGroupHash, apl::sdk::detail::private_APluginSDK_hashName("first_group1"));
+    ASSERT_EQ(plugin->getPluginInfo()->structSize, sizeof(apl::PluginInfo));
+    ASSERT_EQ(plugin->findFeature("first_group1", "feature3"), nullptr);
+    ASSERT_EQ(plugin->findFeature("first_group2", "feature1"), nullptr);
+    ASSERT_EQ(plugin->findFeature(nullptr, "feature1"), nullptr);
+
+    // C++ plugin (hashes computed at compile time)
+    plugin = apl::Plugin::load("plugins/sixth/sixth_plugin");
+    ASSERT_NE(plugin, nullptr);
+    feature = plugin->findFeature("sixth_group_pow", "feature_pow3");
+    ASSERT_NE(feature, nullptr);
+    ASSERT_EQ(feature->featureNameHash, apl::sdk::detail::private_APluginSDK_hashName("feature_pow3"));
+    ASSERT_EQ(reinterpret_cast<int(*)(int)>(feature->functionPointer)(3), 27);
+    const apl::PluginClassInfo *classInfo = plugin->findClass("Interface", "Implementation1");
+    ASSERT_NE(classInfo, nullptr);
+    ASSERT_STREQ(classInfo->className, "Implementation1");
+    ASSERT_EQ(classInfo->interfaceNameHash, apl::sdk::detail::private_APluginSDK_hashName("Interface"));
+    ASSERT_EQ(plugin->findClass("OtherInterface", "Implementation1"), nullptr);
+
+    // the plugin looks features and classes up itself
+    ASSERT_NE(plugin->getPluginInfo()->findFeature, nullptr);
+    for(size_t i = 0; i < plugin->getFeatureCount(); i++) {
+        const apl::PluginFeatureInfo *info = plugin->getPluginInfo()->getFeatureInfo(i);
+        ASSERT_EQ(plugin->getPluginInfo()->findFeature(info->featureGroup, info->featureName), info);
+    }
+    for(size_t i = 0; i < plugin->getClassCount(); i++) {
+        const apl::PluginClassInfo *info = plugin->getClassInfo(i);
+        ASSERT_EQ(plugin->getPluginInfo()->findClass(info->interfaceName, info->className), info);
+    }
+    ASSERT_EQ(plugin->getPluginInfo()->findFeature("sixth_group_pow", "feature_pow4"), nullptr);
+}
+
+GTEST_TEST(Test_Plugin, featureSignature)
+{
+    ASSERT_EQ(apl::featureSignature<int(int, int)>(), apl::sdk::detail::private_APluginSDK_hashName("i32(i32,i32)"));
+    ASSERT_EQ(apl::featureSignature<const char*(char* const*, const volatile void*)>(),
+              apl::sdk::detail::private_APluginSDK_hashName("char const*(char* const*,void const volatile*)"));
+    ASSERT_NE(apl::featureSignature<int(int, int)>(), apl::featureSignature<unsigned(int, int)>());
+    ASSERT_EQ(apl::featureSignature<int(int, ...)>(), 0);
+    ASSERT_EQ(apl::featureSignature<int(Interface*)>(), 0);
+    static_assert(apl::featureSignature<int(int)>() != 0, "signatures are computed at compile time");
+
+    // C plugin (normalized stringified types) and C++ plugin (function types) agree
+    std::unique_ptr<apl::Plugin> cPlugin = apl::Plugin::load("plugins/first/first_plugin");
+    std::unique_ptr<apl::Plugin> cppPlugin = apl::Plugin::load("plugins/sixth/sixth_plugin");
+    ASSERT_NE(cPlugin, nullptr);
+    ASSERT_NE(cppPlugin, nullptr);
+    const apl::PluginFeatureInfo *feature = cPlugin->findFeature("first_group1", "feature1");
+    ASSERT_EQ(feature->signatureHash, apl::featureSignature<int(int, int)>());
+    ASSERT_EQ(cppPlugin->findFeature("sixth_group_math", "feature_add")->signatureHash, feature->signatureHash);
+    ASSERT_EQ(cppPlugin->findFeature("sixth_group_pow", "feature_pow2")->signatureHash, apl::featureSignature<int(int)>());
+    ASSERT_EQ(cPlugin->findFeature("first_group1", "feature2")->signatureHash,
+              apl::featureSignature<afl::APluginLibrary_Test_PointStruct(int, int)>());
+
+    ASSERT_EQ(cPlugin->findFeature("first_group1", "feature1", apl::featureSignature<int(int, int)>()), feature);
+    ASSERT_EQ(cPlugin->findFeature("first_group1", "feature1", apl::featureSignature<int(int)>()), nullptr);
+    ASSERT_EQ(cPlugin->findFeature("first_group1", "feature1", 0), nullptr);
+    ASSERT_EQ(cPlugin->findFeature("first_group1", "feature3", apl::featureSignature<int(int, int)>()), nullptr);
+
+    // integrated plugin
+    std::unique_ptr<apl::Plugin> integratedPlugin = apl::Plugin::load("");
+    ASSERT_NE(integratedPlugin, nullptr);
+    ASSERT_NE(integratedPlugin->findFeature("integrated_feature_group", "integrated_feature_1",
+                                            apl::featureSignature<double(double, double)>()), nullptr);
+    ASSERT_NE(integratedPlugin->findFeature("integrated_feature_group", "integrated_feature_2",
+                                            apl::featureSignature<int()>()), nullptr);
+    integratedPlugin = nullptr;
+    integratedPluginInitStatusString = "";
+}
+
+GTEST_TEST(Test_Plugin, featureVariants)
+{
+    const std::pair<const char*, std::pair<const char*, const char*>> plugins[] = {
+            {"plugins/first/first_plugin", {"first_group1", "feature1"}},
+            {"plugins/sixth/sixth_plugin", {"sixth_group_math", "feature_mul"}}};
+    for(const auto &entry : plugins) {
+        std::unique_ptr<apl::Plugin> plugin = apl::Plugin::load(entry.first);
+        ASSERT_NE(plugin, nullptr);
+        const char *featureGroup = entry.second.first, *featureName = entry.second.second;
+        ASSERT_EQ(plugin->getFeatureVariantCount(), 2);
+        const apl::PluginFeatureVariant* const* variants = plugin->getFeatureVariants();
+        size_t index = 0;
+        for(; index < plugin->getFeatureCount(); index++) {
+            const apl::PluginFeatureInfo *info = plugin->getFeatureInfo(index);
+            if(std::strcmp(info->featureGroup, featureGroup) == 0 && std::strcmp(info->featureName, featureName) == 0)
+                break;
+        }
+        ASSERT_LT(index, plugin->getFeatureCount());
+        void *genericFunction = plugin->getPluginInfo()->findFeature(featureGroup, featureName)->functionPointer;
+
+        // selected at load with the instruction sets of the cpu
+        const apl::PluginFeatureVariant *best = nullptr;
+        for(size_t i = 0; i < plugin->getFeatureVariantCount(); i++) {
+            if((variants[i]->instructionSets & ~apl::supportedInstructionSets()) == 0
+               && (best == nullptr || variants[i]->instructionSets > best->instructionSets))
+                best = variants[i];
+        }
+        const apl::PluginFeatureInfo *feature = plugin->findFeature(featureGroup, featureName);
+        ASSERT_NE(feature, nullptr);
+        ASSERT_EQ(feature->functionPointer, best != nullptr ? best->functionPointer : genericFunction);
+        ASSERT_EQ(plugin->getFeatureInfo(index), feature);
+
+        // force every variant supported by this machine
+        for(size_t i = 0; i < plugin->getFeatureVariantCount(); i++) {
+            const apl::PluginFeatureVariant *variant = variants[i];
+            ASSERT_STREQ(variant->featureGroup, featureGroup);
+            ASSERT_STREQ(variant->featureName, featureName);
+            if((variant->instructionSets & ~apl::supportedInstructionSets()) != 0)
+                continue;
+            plugin->selectFeatureVariants(variant->instructionSets);
+            feature = plugin->findFeature(featureGroup, featureName);
+            ASSERT_NE(feature, nullptr);
+            ASSERT_EQ(feature->functionPointer, variant->functionPointer);
+            ASSERT_EQ(plugin->getFeatureInfos()[index], feature);
+            ASSERT_STREQ(feature->featureName, featureName);
+            ASSERT_EQ(reinterpret_cast<int(*)(int, int)>(feature->functionPointer)(6, 7), 42);
+        }
+        plugin->selectFeatureVariants(0);
+        ASSERT_EQ(plugin->findFeature(featureGroup, featureName)->functionPointer, genericFunction);
+        ASSERT_EQ(plugin->getFeatureInfo(index)->functionPointer, genericFunction);
+        ASSERT_EQ(reinterpret_cast<int(*)(int, int)>(genericFunction)(6, 7), 42);
+    }
+}
+
+GTEST_TEST(Test_Plugin, load_unload_concurrent)
+{
+    std::vector<std::string> paths = {"plugins/first/first_plugin", "plugins/sixth/sixth_plugin", ""};
+    std::vector<size_t> featureCounts;
+    for(const std::string& path : paths) {
+        std::unique_ptr<apl::Plugin> plugin = apl::Plugin::load(path);
+        ASSERT_NE(plugin, nullptr);
+        featureCounts.push_back(plugin->getFeatureCount());
+    }
+
+    // every thread loads and unloads its own instances, the plugins are initialized and finalized repeatedly
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < 8; i++) {
+        threads.emplace_back([&]() {
+            for(size_t j = 0; j < 200; j++) {
+                for(size_t k = 0; k < paths.size(); k++) {
+                    std::unique_ptr<apl::Plugin> plugin = apl::Plugin::load(paths[k]);
+                    if(plugin == nullptr || plugin->getFeatureCount() != featureCounts[k])
+                        failed = true;
+                    else if(plugin->findFeature(plugin->getFeatureInfo(0)->featureGroup, plugin->getFeatureInfo(0)->featureName) == nullptr)
+                        failed = true;
+                }
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+    ASSERT_FALSE(failed);
+
+    std::unique_ptr<apl::Plugin> plugin = apl::Plugin::load(paths[0]);
+    ASSERT_NE(plugin, nullptr);
+    ASSERT_EQ(plugin->getFeatureCount(), featureCounts[0]);
+    ASSERT_EQ(plugin->getPluginInfo()->privateInfo->constructPluginInternals(nullptr), 2);
+    ASSERT_EQ(plugin->getPluginInfo()->privateInfo->destructPluginInternals(nullptr), 1);
+    integratedPluginInitStatusString = "";
+}
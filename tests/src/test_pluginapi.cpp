@@ -4,6 +4,12 @@
 
 #include "APluginSDK/pluginapi.h"
 #include "APluginSDK/private/privateplugininfos.h"
+#include "APluginSDK/private/src/arena.c"
+#include "APluginSDK/private/src/signature.c"
+#include "APluginLibrary/plugin.h"
+
+#include <vector>
+#include <cstring>
 
 #include "../plugins/interface.h"
 #include "../plugins/include.h"
@@ -459,3 +465,140 @@ GTEST_TEST(Test_PluginAPI, feature_and_class_plugin_infos)
     pluginInfo->privateInfo->constructPluginInternals(nullptr);
     apl::LibraryLoader::unload(handle);
 }
+
+GTEST_TEST(Test_PluginAPI, feature_and_class_records)
+{
+    for(const char *path : {"plugins/sixth/sixth_plugin", "plugins/third/third_plugin", "plugins/seventh/seventh_plugin"}) {
+        void* handle = apl::LibraryLoader::load(path);
+        ASSERT_NE(handle, nullptr);
+        auto getAPluginInfo = apl::LibraryLoader::getSymbol<const apl::APluginInfo*(*)()>(handle, "APluginSDK_getPluginInfo");
+        ASSERT_NE(getAPluginInfo, nullptr);
+        const apl::APluginInfo* info = getAPluginInfo();
+        ASSERT_NE(info, nullptr);
+
+        // the infos of features and classes from all compilation units are one array referring to the plugin info
+        const apl::APluginFeatureInfo* const* featureInfos = info->getFeatureInfos();
+        for(size_t i = 0; i < info->getFeatureCount(); i++) {
+            ASSERT_EQ(featureInfos[i], info->getFeatureInfo(i));
+            ASSERT_EQ(featureInfos[i]->pluginInfo, info);
+        }
+        ASSERT_EQ(info->getFeatureInfo(info->getFeatureCount()), nullptr);
+        const apl::APluginClassInfo* const* classInfos = info->getClassInfos();
+        for(size_t i = 0; i < info->getClassCount(); i++) {
+            ASSERT_EQ(classInfos[i], info->getClassInfo(i));
+            ASSERT_EQ(classInfos[i]->pluginInfo, info);
+        }
+        ASSERT_EQ(info->getClassInfo(info->getClassCount()), nullptr);
+        apl::LibraryLoader::unload(handle);
+    }
+}
+
+GTEST_TEST(Test_PluginAPI, perfect_hash)
+{
+    const char *paths[] = {"plugins/first/first_plugin", "plugins/sixth/sixth_plugin", "plugins/third/third_plugin",
+                           "plugins/seventh/seventh_plugin"};
+    for(const char *path : paths) {
+        void* handle = apl::LibraryLoader::load(path);
+        ASSERT_NE(handle, nullptr);
+        auto getAPluginInfo = apl::LibraryLoader::getSymbol<const apl::APluginInfo*(*)()>(handle, "APluginSDK_getPluginInfo");
+        ASSERT_NE(getAPluginInfo, nullptr);
+        const apl::APluginInfo* info = getAPluginInfo();
+        ASSERT_NE(info, nullptr);
+        ASSERT_NE(info->findFeature, nullptr);
+        ASSERT_NE(info->findClass, nullptr);
+
+        // every feature and class is found in its own slot of the perfect hash
+        for(size_t i = 0; i < info->getFeatureCount(); i++) {
+            const apl::APluginFeatureInfo* feature = info->getFeatureInfo(i);
+            ASSERT_EQ(info->findFeature(feature->featureGroup, feature->featureName), feature);
+            ASSERT_EQ(info->findFeature(feature->featureGroup, "unknown_feature"), nullptr);
+        }
+        for(size_t i = 0; i < info->getClassCount(); i++) {
+            const apl::APluginClassInfo* classInfo = info->getClassInfo(i);
+            ASSERT_EQ(info->findClass(classInfo->interfaceName, classInfo->className), classInfo);
+            ASSERT_EQ(info->findClass(classInfo->interfaceName, "UnknownClass"), nullptr);
+        }
+
+        // names which hash to an occupied slot are still compared
+        ASSERT_EQ(info->findFeature("unknown_group", "unknown_feature"), nullptr);
+        ASSERT_EQ(info->findClass("UnknownInterface", "UnknownClass"), nullptr);
+        ASSERT_EQ(info->findFeature(nullptr, "unknown_feature"), nullptr);
+        ASSERT_EQ(info->findClass("UnknownInterface", nullptr), nullptr);
+        apl::LibraryLoader::unload(handle);
+    }
+}
+
+GTEST_TEST(Test_PluginAPI, arena)
+{
+    using namespace apl::sdk::detail;
+    const size_t alignment = sizeof(private_APluginSDK_ArenaAlignment);
+    private_APluginSDK_ArenaAlignment initialBlock[8];
+    private_APluginSDK_Arena arena;
+    private_APluginSDK_initArena(&arena, initialBlock, sizeof(initialBlock));
+    ASSERT_EQ(arena.blocks, arena.initialBlock);
+
+    // allocations are aligned and taken from the initial block one after another
+    char *first = static_cast<char*>(private_APluginSDK_arenaAllocate(&arena, 1));
+    char *second = static_cast<char*>(private_APluginSDK_arenaAllocate(&arena, alignment + 1));
+    ASSERT_EQ(first, reinterpret_cast<char*>(initialBlock + 1));
+    ASSERT_EQ(second, first + alignment);
+    ASSERT_EQ(arena.blocks, arena.initialBlock);
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+    // the last allocation grows in place, others are copied
+    std::memset(second, 7, alignment + 1);
+    ASSERT_EQ(private_APluginSDK_arenaGrow(&arena, second, alignment + 1, 3 * alignment), second);
+    char *copy = static_cast<char*>(private_APluginSDK_arenaGrow(&arena, first, 1, alignment * 2));
+    ASSERT_NE(copy, first);
+#else
+    ASSERT_NE(private_APluginSDK_arenaAllocate(&arena, 3 * alignment), nullptr);
+#endif
+
+    // a full block is followed by heap blocks
+    for(size_t i = 0; i < 100; ++i) {
+        void *pointer = private_APluginSDK_arenaAllocate(&arena, 3 * alignment);
+        ASSERT_NE(pointer, nullptr);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(pointer) % alignof(private_APluginSDK_ArenaAlignment), 0u);
+        std::memset(pointer, 0, 3 * alignment);
+    }
+    ASSERT_NE(arena.blocks, arena.initialBlock);
+#if !PRIVATE_APLUGINSDK_SECTION_REGISTRATION
+    ASSERT_EQ(second[alignment], 7);
+#endif
+
+    // releasing frees the heap blocks and reuses the initial block
+    private_APluginSDK_releaseArena(&arena);
+    ASSERT_EQ(arena.blocks, arena.initialBlock);
+    ASSERT_EQ(private_APluginSDK_arenaAllocate(&arena, 1), first);
+    private_APluginSDK_releaseArena(&arena);
+
+    // without an initial block everything is allocated on the heap
+    private_APluginSDK_initArena(&arena, nullptr, 0);
+    ASSERT_NE(private_APluginSDK_arenaAllocate(&arena, 1000), nullptr);
+    ASSERT_NE(arena.blocks, nullptr);
+    private_APluginSDK_releaseArena(&arena);
+    ASSERT_EQ(arena.blocks, nullptr);
+}
+
+GTEST_TEST(Test_PluginAPI, hashSignature)
+{
+    using apl::sdk::detail::private_APluginSDK_hashSignature;
+    ASSERT_EQ(private_APluginSDK_hashSignature("int", "int x1, int x2"), apl::featureSignature<int(int, int)>());
+    ASSERT_EQ(private_APluginSDK_hashSignature("signed int", " signed x1,int  "), apl::featureSignature<int(int, int)>());
+    ASSERT_EQ(private_APluginSDK_hashSignature("void", "void"), apl::featureSignature<void()>());
+    ASSERT_EQ(private_APluginSDK_hashSignature("void", ""), apl::featureSignature<void()>());
+    ASSERT_EQ(private_APluginSDK_hashSignature("const char *", "const char *const text, unsigned long length, int values[]"),
+              apl::featureSignature<const char*(const char*, unsigned long, int*)>());
+    ASSERT_EQ(private_APluginSDK_hashSignature("size_t", "uint8_t *data, _Bool flag, char const * volatile *names"),
+              apl::featureSignature<size_t(uint8_t*, bool, const char* volatile*)>());
+    ASSERT_EQ(private_APluginSDK_hashSignature("long double", "signed char c, unsigned short int s, long long l, float f"),
+              apl::featureSignature<long double(signed char, unsigned short, long long, float)>());
+    ASSERT_EQ(private_APluginSDK_hashSignature("struct Point", "struct Point *point"),
+              apl::sdk::detail::private_APluginSDK_hashName("Point(Point*)"));
+
+    // not understood
+    ASSERT_EQ(private_APluginSDK_hashSignature("int", "int x, ..."), 0);
+    ASSERT_EQ(private_APluginSDK_hashSignature("int", "int (*callback)(int)"), 0);
+    ASSERT_EQ(private_APluginSDK_hashSignature("int", "int x,"), 0);
+    ASSERT_EQ(private_APluginSDK_hashSignature("unsigned double", "int x"), 0);
+    ASSERT_EQ(private_APluginSDK_hashSignature("int", "int x y"), 0);
+}
@@ -2,9 +2,28 @@
 
 #include <string>
 #include <algorithm>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+# include <direct.h>
+# define mkdir(path, mode) _mkdir(path)
+# define rmdir(path) _rmdir(path)
+#else
+# include <unistd.h>
+# include <dlfcn.h>
+#endif
 
 #include "APluginLibrary/pluginmanager.h"
 #include "../../src/private/pluginmanagerprivate.h"
+#include "../../src/private/pluginprobe.h"
 #include "APluginSDK/pluginapi.h"
 
 #include "../plugins/interface.h"
@@ -13,6 +32,45 @@
 
 extern const char* integratedPluginInitStatusString;
 
+namespace
+{
+    std::string libraryPath(const std::string &path)
+    {
+        return std::string(path).append(".").append(apl::LibraryLoader::libExtension());
+    }
+    /*
+     * Copies the shared library at source to destination (both without the file extension). The copy is written beside
+     * destination and moved there, so a directory watcher never sees a partially written library.
+     */
+    void copyLibrary(const std::string &source, const std::string &destination)
+    {
+        std::string partialPath = libraryPath(destination).append(".partial");
+        {
+            std::ifstream input(libraryPath(source), std::ios::binary);
+            std::ofstream output(partialPath, std::ios::binary | std::ios::trunc);
+            output << input.rdbuf();
+        }
+        std::rename(partialPath.c_str(), libraryPath(destination).c_str());
+    }
+    /*
+     * Creates a unique directory in the temporary directory, so no other test has its libraries mapped. Returns an
+     * empty string if it can't be created.
+     */
+    std::string makeScratchDirectory()
+    {
+#ifdef _WIN32
+        char name[L_tmpnam];
+        std::string directory = std::tmpnam(name);
+        return mkdir(directory.c_str(), 0755) == 0 ? directory : std::string();
+#else
+        const char *temporaryDirectory = getenv("TMPDIR");
+        std::string directory = std::string(temporaryDirectory != nullptr ? temporaryDirectory : "/tmp");
+        directory.append("/APluginLibraryTest_XXXXXX");
+        return mkdtemp(&directory[0]) != nullptr ? directory : std::string();
+#endif
+    }
+}
+
 GTEST_TEST(Test_PluginManager, load_unload_single_extern)
 {
     apl::PluginManager manager = apl::PluginManager();
@@ -808,4 +866,612 @@ GTEST_TEST(Test_PluginManager, getClassProperties)
     manager.unloadAll();
     ASSERT_EQ(manager.getLoadedPluginCount(), 0);
     ASSERT_EQ(manager.getLoadedPlugins().size(), 0);
-}
\ No newline at end of file
+}
+GTEST_TEST(Test_PluginManager, plugin_feature_class_ids)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    const apl::Plugin* firstPlugin = manager.load("plugins/first/first_plugin");
+    const apl::Plugin* fifthPlugin = manager.load("plugins/fifth/fifth_plugin");
+    ASSERT_NE(firstPlugin, nullptr);
+    ASSERT_NE(fifthPlugin, nullptr);
+
+    // plugin ids
+    apl::PluginId firstId = manager.getPluginId(firstPlugin);
+    apl::PluginId fifthId = manager.getPluginId(fifthPlugin);
+    ASSERT_TRUE(firstId.isValid());
+    ASSERT_TRUE(fifthId.isValid());
+    ASSERT_NE(firstId, fifthId);
+    ASSERT_EQ(manager.plugin(firstId), firstPlugin);
+    ASSERT_EQ(manager.plugin(fifthId), fifthPlugin);
+    ASSERT_EQ(manager.getPluginIdCapacity(), 2);
+    ASSERT_FALSE(manager.getPluginId(nullptr).isValid());
+    ASSERT_EQ(manager.plugin(apl::PluginId()), nullptr);
+
+    // feature ids are dense and resolve in the same order as getFeatures
+    std::vector<apl::FeatureId> featureIds = manager.getFeatureIds("first_group1", apl::PluginFeatureFilter::FeatureGroup);
+    std::vector<const apl::PluginFeatureInfo*> features = manager.getFeatures("first_group1", apl::PluginFeatureFilter::FeatureGroup);
+    ASSERT_EQ(featureIds.size(), 2);
+    ASSERT_EQ(features.size(), 2);
+    for(size_t i = 0; i < featureIds.size(); i++) {
+        ASSERT_LT(featureIds[i].getIndex(), manager.getFeatureIdCapacity());
+        ASSERT_EQ(manager.feature(featureIds[i]), features[i]);
+        ASSERT_EQ(manager.getFeatureId(features[i]), featureIds[i]);
+    }
+    ASSERT_EQ(manager.getFeatureIdCapacity(), 3);
+
+    // class ids
+    std::vector<apl::ClassId> classIds = manager.getClassIds("Interface", apl::PluginClassFilter::InterfaceName);
+    ASSERT_EQ(classIds.size(), 1);
+    const apl::PluginClassInfo* classInfo = manager.pluginClass(classIds.front());
+    ASSERT_NE(classInfo, nullptr);
+    ASSERT_STREQ(classInfo->className, "Implementation");
+    ASSERT_EQ(manager.getClassId(classInfo), classIds.front());
+    ASSERT_EQ(manager.getClassIdCapacity(), 1);
+
+    // ids get stale after unloading and indices get reused with a new generation
+    manager.unload(firstPlugin);
+    ASSERT_EQ(manager.plugin(firstId), nullptr);
+    for(apl::FeatureId id : featureIds)
+        ASSERT_EQ(manager.feature(id), nullptr);
+    ASSERT_EQ(manager.plugin(fifthId), fifthPlugin);
+    ASSERT_EQ(manager.pluginClass(classIds.front()), classInfo);
+
+    firstPlugin = manager.load("plugins/first/first_plugin");
+    apl::PluginId newFirstId = manager.getPluginId(firstPlugin);
+    ASSERT_EQ(newFirstId.getIndex(), firstId.getIndex());
+    ASSERT_NE(newFirstId.getGeneration(), firstId.getGeneration());
+    ASSERT_EQ(manager.plugin(firstId), nullptr);
+    ASSERT_EQ(manager.plugin(newFirstId), firstPlugin);
+    ASSERT_EQ(manager.getPluginIdCapacity(), 2);
+    ASSERT_EQ(manager.getFeatureIdCapacity(), 3);
+    for(apl::FeatureId id : manager.getFeatureIds("first_group1", apl::PluginFeatureFilter::FeatureGroup)) {
+        ASSERT_NE(manager.feature(id), nullptr);
+        ASSERT_STREQ(manager.feature(id)->featureGroup, "first_group1");
+    }
+
+    // copies hand out their own ids for the same plugins
+    apl::PluginManager copy = manager;
+    ASSERT_EQ(copy.plugin(copy.getPluginId(firstPlugin)), firstPlugin);
+    ASSERT_EQ(copy.getFeatureIds("feature1", apl::PluginFeatureFilter::FeatureName).size(), 2);
+
+    manager.unloadAll();
+    ASSERT_EQ(manager.plugin(newFirstId), nullptr);
+    ASSERT_EQ(manager.plugin(fifthId), nullptr);
+    ASSERT_EQ(manager.pluginClass(classIds.front()), nullptr);
+    ASSERT_EQ(copy.getLoadedPluginCount(), 2);
+}
+
+GTEST_TEST(Test_PluginManager, generation_query_cache)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    uint64_t generation = manager.getGeneration();
+    ASSERT_NE(manager.load("plugins/second/second_plugin"), nullptr);
+    ASSERT_NE(manager.getGeneration(), generation);
+    generation = manager.getGeneration();
+
+    // repeated queries share one result as long as the generation doesn't change
+    auto features = manager.getSharedFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup);
+    ASSERT_EQ(features->size(), 4);
+    ASSERT_EQ(manager.getSharedFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup), features);
+    ASSERT_NE(manager.getSharedFeatures("second_group_math", apl::PluginFeatureFilter::FeatureName), features);
+    ASSERT_EQ(manager.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup), *features);
+    auto classes = manager.getSharedClasses("Interface", apl::PluginClassFilter::InterfaceName);
+    ASSERT_EQ(manager.getSharedClasses("Interface", apl::PluginClassFilter::InterfaceName), classes);
+    ASSERT_EQ(manager.getGeneration(), generation);
+
+    // loading invalidates the cache
+    ASSERT_NE(manager.load("plugins/fifth/fifth_plugin"), nullptr);
+    ASSERT_NE(manager.getGeneration(), generation);
+    generation = manager.getGeneration();
+    auto newClasses = manager.getSharedClasses("Interface", apl::PluginClassFilter::InterfaceName);
+    ASSERT_NE(newClasses, classes);
+    ASSERT_EQ(newClasses->size(), classes->size() + 1);
+
+    // loading an already loaded plugin changes nothing
+    ASSERT_NE(manager.load("plugins/fifth/fifth_plugin"), nullptr);
+    ASSERT_EQ(manager.getGeneration(), generation);
+    ASSERT_EQ(manager.getSharedClasses("Interface", apl::PluginClassFilter::InterfaceName), newClasses);
+
+    // unloading invalidates the cache too, old results stay valid for their holders
+    manager.unloadAll();
+    ASSERT_NE(manager.getGeneration(), generation);
+    ASSERT_EQ(features->size(), 4);
+    ASSERT_TRUE(manager.getSharedFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup)->empty());
+    ASSERT_TRUE(manager.getSharedClasses("Interface", apl::PluginClassFilter::InterfaceName)->empty());
+}
+
+GTEST_TEST(Test_PluginManager, getFeatures_getClasses_match)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    for(const char* path : {"plugins/first/first_plugin", "plugins/second/second_plugin", "plugins/sixth/sixth_plugin", "plugins/seventh/seventh_plugin"})
+        ASSERT_NE(manager.load(path), nullptr);
+
+    ASSERT_EQ(manager.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup, apl::PluginStringMatch::Equal),
+              manager.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup));
+    ASSERT_EQ(manager.getFeatures("second_", apl::PluginFeatureFilter::FeatureGroup, apl::PluginStringMatch::Prefix).size(), 6);
+    ASSERT_EQ(manager.getFeatures("s*_group_math", apl::PluginFeatureFilter::FeatureGroup, apl::PluginStringMatch::Glob).size(), 8);
+    ASSERT_EQ(manager.getFeatures("*_pow?", apl::PluginFeatureFilter::FeatureName, apl::PluginStringMatch::Glob).size(), 4);
+    ASSERT_EQ(manager.getFeatures("feature?", apl::PluginFeatureFilter::FeatureName, apl::PluginStringMatch::Glob).size(), 2);
+    ASSERT_TRUE(manager.getFeatures("other_*", apl::PluginFeatureFilter::FeatureGroup, apl::PluginStringMatch::Glob).empty());
+
+    ASSERT_EQ(manager.getClasses("Impl", apl::PluginClassFilter::ClassName, apl::PluginStringMatch::Prefix).size(), 4);
+    ASSERT_EQ(manager.getClasses("*Interface", apl::PluginClassFilter::InterfaceName, apl::PluginStringMatch::Glob).size(), 4);
+    ASSERT_EQ(manager.getClasses("Other*", apl::PluginClassFilter::InterfaceName, apl::PluginStringMatch::Glob).size(), 1);
+
+    manager.unload(manager.getLoadedPlugin("plugins/second/second_plugin"));
+    ASSERT_TRUE(manager.getFeatures("second_", apl::PluginFeatureFilter::FeatureGroup, apl::PluginStringMatch::Prefix).empty());
+}
+
+GTEST_TEST(Test_PluginManager, load_batch)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    const apl::Plugin* secondPlugin = manager.load("plugins/second/second_plugin");
+    ASSERT_NE(secondPlugin, nullptr);
+
+    std::vector<std::string> paths = {"plugins/first/first_plugin", "plugins/second/second_plugin", "not_existing",
+                                      "plugins/third/third_plugin", "plugins/first/../first/first_plugin", "plugins/fourth/fourth_plugin"};
+    std::vector<const apl::Plugin*> plugins = manager.load(paths);
+    ASSERT_EQ(plugins.size(), paths.size());
+    ASSERT_NE(plugins[0], nullptr);
+    ASSERT_EQ(plugins[1], secondPlugin);
+    ASSERT_EQ(plugins[2], nullptr);
+    ASSERT_NE(plugins[3], nullptr);
+    ASSERT_EQ(plugins[4], plugins[0]); // same shared library, different path
+    ASSERT_NE(plugins[5], nullptr);
+    ASSERT_EQ(manager.getLoadedPluginCount(), 4);
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 4);
+    for(const auto& entry : apl::detail::PluginManagerPrivate::allPlugins)
+        ASSERT_EQ(entry.second.first, 1);
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::pendingPlugins.empty());
+
+    // plugins of other managers are shared
+    apl::PluginManager manager2 = apl::PluginManager();
+    ASSERT_EQ(manager2.load(std::vector<std::string>({"plugins/third/third_plugin", "plugins/fifth/fifth_plugin"})).front(), plugins[3]);
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 5);
+
+    manager.unloadAll();
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 2);
+    manager2.unloadAll();
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 0);
+    ASSERT_TRUE(manager.load(std::vector<std::string>()).empty());
+}
+
+GTEST_TEST(Test_PluginManager, load_batch_concurrent)
+{
+    std::vector<std::string> paths = {"plugins/first/first_plugin", "plugins/second/second_plugin", "plugins/third/third_plugin",
+                                      "plugins/fourth/fourth_plugin", "plugins/fifth/fifth_plugin", "plugins/sixth/sixth_plugin"};
+    std::vector<apl::PluginManager> managers(4);
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < managers.size(); i++) {
+        threads.emplace_back([&, i]() {
+            std::vector<std::string> rotated = paths;
+            std::rotate(rotated.begin(), rotated.begin() + i, rotated.end());
+            managers[i].load(rotated);
+        });
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), paths.size());
+    for(const auto& entry : apl::detail::PluginManagerPrivate::allPlugins)
+        ASSERT_EQ(entry.second.first, managers.size());
+    for(apl::PluginManager& manager : managers) {
+        ASSERT_EQ(manager.getLoadedPluginCount(), paths.size());
+        manager.unloadAll();
+    }
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 0);
+}
+
+GTEST_TEST(Test_PluginManager, copy_on_write)
+{
+    auto referenceCounts = []() {
+        std::vector<size_t> counts;
+        for(const auto& entry : apl::detail::PluginManagerPrivate::allPlugins)
+            counts.push_back(entry.second.first);
+        std::sort(counts.begin(), counts.end());
+        return counts;
+    };
+    apl::PluginManager manager = apl::PluginManager();
+    manager.load(std::vector<std::string>({"plugins/first/first_plugin", "plugins/second/second_plugin", "plugins/third/third_plugin"}));
+    const apl::Plugin* secondPlugin = manager.getLoadedPlugin("plugins/second/second_plugin");
+    ASSERT_EQ(referenceCounts(), std::vector<size_t>({1, 1, 1}));
+
+    // copies share the plugins (and the references) until they are modified
+    apl::PluginManager copy = manager;
+    apl::PluginManager copy2 = apl::PluginManager();
+    copy2 = copy;
+    ASSERT_EQ(referenceCounts(), std::vector<size_t>({1, 1, 1}));
+    ASSERT_EQ(copy.getLoadedPlugins(), manager.getLoadedPlugins());
+    ASSERT_EQ(copy2.getPluginId(secondPlugin), manager.getPluginId(secondPlugin));
+    ASSERT_EQ(copy2.getFeatures(), manager.getFeatures());
+
+    // modifying a copy only changes the copy
+    copy.unload(secondPlugin);
+    ASSERT_EQ(referenceCounts(), std::vector<size_t>({1, 2, 2}));
+    ASSERT_EQ(copy.getLoadedPluginCount(), 2);
+    ASSERT_EQ(copy.getLoadedPlugin("plugins/second/second_plugin"), nullptr);
+    ASSERT_EQ(manager.getLoadedPluginCount(), 3);
+    ASSERT_EQ(copy2.getLoadedPluginCount(), 3);
+    ASSERT_EQ(copy2.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup).size(), 4);
+    ASSERT_TRUE(copy.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup).empty());
+
+    ASSERT_NE(copy2.load("plugins/fourth/fourth_plugin"), nullptr);
+    ASSERT_EQ(referenceCounts(), std::vector<size_t>({1, 2, 3, 3}));
+    ASSERT_EQ(manager.getLoadedPlugin("plugins/fourth/fourth_plugin"), nullptr);
+
+    manager.unloadAll();
+    ASSERT_EQ(referenceCounts(), std::vector<size_t>({1, 1, 2, 2}));
+    copy2.unloadAll();
+    ASSERT_EQ(referenceCounts(), std::vector<size_t>({1, 1}));
+    copy.unloadAll();
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::pluginPaths.empty());
+}
+
+GTEST_TEST(Test_PluginManager, unloadAllAsync)
+{
+    ASSERT_TRUE(apl::PluginManager::waitForPendingUnloads(std::chrono::seconds(10))); // unloads of other tests
+    std::vector<std::string> paths = {"plugins/first/first_plugin", "plugins/second/second_plugin", "plugins/third/third_plugin",
+                                      "plugins/fourth/fourth_plugin", "plugins/fifth/fifth_plugin"};
+    apl::PluginManager manager = apl::PluginManager();
+    manager.load(std::vector<std::string>(paths.begin(), paths.begin() + 3));
+    manager.load(std::vector<std::string>(paths.begin() + 3, paths.end()));
+    apl::PluginManager copy = manager;
+    copy.unload(copy.getLoadedPlugin("plugins/first/first_plugin"));
+
+    // the plugins are detached immediately, plugins used by other managers stay loaded
+    std::future<void> future = manager.unloadAllAsync();
+    ASSERT_EQ(manager.getLoadedPluginCount(), 0);
+    ASSERT_TRUE(manager.getFeatures().empty());
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 4);
+    future.wait(); // the reaper completes the future before it counts the plugins as reaped
+    ASSERT_TRUE(apl::PluginManager::waitForPendingUnloads(std::chrono::seconds(10)));
+    ASSERT_EQ(copy.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup).size(), 4);
+
+    future = copy.unloadAllAsync();
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+    ASSERT_TRUE(apl::PluginManager::waitForPendingUnloads(std::chrono::seconds(10)));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::pendingPlugins.empty());
+
+    // reloading waits for pending unloads of the same plugin
+    for(int i = 0; i < 10; i++) {
+        std::vector<const apl::Plugin*> plugins = manager.load(paths);
+        ASSERT_EQ(plugins, manager.getLoadedPlugins());
+        ASSERT_EQ(manager.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup).size(), 4);
+        manager.unloadAllAsync();
+    }
+    ASSERT_TRUE(apl::PluginManager::waitForPendingUnloads(std::chrono::seconds(10)));
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+    ASSERT_TRUE(manager.unloadAllAsync().valid());
+}
+
+GTEST_TEST(Test_PluginManager, retentionCache)
+{
+    apl::PluginManager::setRetentionCache(2);
+    apl::PluginManager manager = apl::PluginManager();
+    const apl::Plugin* plugin = manager.load("plugins/second/second_plugin");
+    ASSERT_NE(plugin, nullptr);
+
+    // released plugins are retained and revived when they are loaded again
+    manager.unloadAll();
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 1);
+    ASSERT_EQ(manager.load("plugins/second/second_plugin"), plugin);
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 0);
+    ASSERT_EQ(manager.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup).size(), 4);
+    manager.unloadAll();
+    ASSERT_EQ(manager.load(std::vector<std::string>({"plugins/first/first_plugin", "plugins/second/second_plugin"}))[1], plugin);
+    manager.unloadAllAsync().wait();
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 2);
+
+    // the least recently released plugins are evicted
+    manager.load("plugins/third/third_plugin");
+    manager.unloadAll();
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 2);
+    ASSERT_NE(manager.load("plugins/fourth/fourth_plugin"), nullptr);
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 1);
+    manager.unloadAll();
+    apl::PluginManager::flushRetentionCache();
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 0);
+
+    // expired plugins are evicted
+    apl::PluginManager::setRetentionCache(2, std::chrono::milliseconds(1));
+    manager.load("plugins/second/second_plugin");
+    manager.unloadAll();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 0);
+
+    // finalized plugins keep only their shared library mapped
+    apl::PluginManager::setRetentionCache(2, std::chrono::milliseconds::zero(), apl::PluginRetentionPolicy::Finalize);
+    manager.load("plugins/second/second_plugin");
+    manager.unloadAll();
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 1);
+    ASSERT_NE(manager.load("plugins/second/second_plugin"), nullptr);
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 0);
+    ASSERT_EQ(manager.getFeatures("second_group_math", apl::PluginFeatureFilter::FeatureGroup).size(), 4);
+    manager.unloadAll();
+
+    apl::PluginManager::setRetentionCache(0);
+    ASSERT_EQ(apl::PluginManager::getRetainedPluginCount(), 0);
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+    // evicted plugins are destroyed after the registry is unlocked, their paths are only pending meanwhile
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::pendingPlugins.empty());
+}
+
+GTEST_TEST(Test_PluginManager, retentionCache_concurrent)
+{
+    // evicted plugins are finalized and closed while other threads load, release and evict plugins
+    std::vector<std::string> paths = {"plugins/first/first_plugin", "plugins/second/second_plugin", "plugins/third/third_plugin"};
+    for(apl::PluginRetentionPolicy policy : {apl::PluginRetentionPolicy::DeferFinalization, apl::PluginRetentionPolicy::Finalize}) {
+        apl::PluginManager::setRetentionCache(1, std::chrono::milliseconds::zero(), policy);
+        std::atomic<bool> failed(false);
+        std::vector<std::thread> threads;
+        for(size_t i = 0; i < 6; i++) {
+            threads.emplace_back([&, i]() {
+                apl::PluginManager manager = apl::PluginManager();
+                for(size_t j = 0; j < 100; j++) {
+                    if(manager.load(paths[(i + j) % paths.size()]) == nullptr)
+                        failed = true;
+                    if(j % 2 == 0)
+                        manager.unloadAll();
+                    else
+                        manager.unloadAllAsync();
+                    if(i == 0 && j % 10 == 0)
+                        apl::PluginManager::flushRetentionCache();
+                }
+            });
+        }
+        for(std::thread& thread : threads)
+            thread.join();
+        ASSERT_FALSE(failed);
+        ASSERT_TRUE(apl::PluginManager::waitForPendingUnloads(std::chrono::seconds(10)));
+        apl::PluginManager::setRetentionCache(0);
+        ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+        ASSERT_TRUE(apl::detail::PluginManagerPrivate::pendingPlugins.empty());
+    }
+}
+
+GTEST_TEST(Test_PluginManager, index_loadOnDemand)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    ASSERT_EQ(manager.indexDirectory("plugins", true), 7);
+    ASSERT_EQ(manager.indexDirectory("plugins", true), 0);
+    ASSERT_EQ(manager.getIndexedPluginCount(), 7);
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+    ASSERT_EQ(manager.getLoadedPluginCount(), 0);
+
+    // only the plugins providing matching features or classes are loaded
+    ASSERT_EQ(manager.getFeatures("sixth_group_math", apl::PluginFeatureFilter::FeatureGroup).size(), 4);
+    ASSERT_EQ(manager.getLoadedPluginCount(), 1);
+    ASSERT_EQ(manager.getIndexedPluginCount(), 6);
+    ASSERT_TRUE(manager.getFeatures("other_group", apl::PluginFeatureFilter::FeatureGroup).empty());
+    ASSERT_EQ(manager.getLoadedPluginCount(), 1);
+    ASSERT_EQ(manager.getClasses("OtherInterface", apl::PluginClassFilter::InterfaceName).size(), 1);
+    ASSERT_EQ(manager.getLoadedPluginCount(), 2);
+    ASSERT_EQ(manager.getFeatures("feature_pow?", apl::PluginFeatureFilter::FeatureName, apl::PluginStringMatch::Glob).size(), 4);
+    ASSERT_EQ(manager.getLoadedPluginCount(), 3);
+
+    // concurrent requests load every plugin once
+    std::vector<size_t> counts(8);
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < counts.size(); i++)
+        threads.emplace_back([&, i]() { counts[i] = manager.getClasses("Interface", apl::PluginClassFilter::InterfaceName).size(); });
+    for(std::thread& thread : threads)
+        thread.join();
+    for(size_t count : counts)
+        ASSERT_EQ(count, counts.front());
+    for(const auto& entry : apl::detail::PluginManagerPrivate::allPlugins)
+        ASSERT_EQ(entry.second.first, 1);
+
+    // requests without a filter load all indexed plugins
+    ASSERT_EQ(manager.getFeatures().size(), manager.getFeatures(apl::PluginQuery()).size());
+    ASSERT_EQ(manager.getIndexedPluginCount(), 0);
+    ASSERT_EQ(manager.getLoadedPluginCount(), 7);
+    manager.unloadAll();
+
+    // indexing with a manifest file
+    ASSERT_EQ(manager.indexDirectory("plugins", true, "index.manifest"), 7);
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+    apl::PluginManager other = apl::PluginManager();
+    ASSERT_EQ(other.index(apl::PluginManifest::open("index.manifest")), 7);
+    ASSERT_EQ(other.getFeatures("first_group1", apl::PluginFeatureFilter::FeatureGroup).size(), 2);
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 1);
+    ASSERT_EQ(manager.getIndexedPluginCount(), 7);
+    other.unloadAll();
+    std::remove("index.manifest");
+}
+
+GTEST_TEST(Test_PluginManager, usageProfile)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    manager.setUsageRecording(true);
+    ASSERT_TRUE(manager.isUsageRecording());
+    manager.loadDirectory("plugins", true);
+    ASSERT_EQ(manager.getUsageProfile().size(), 0);
+    ASSERT_EQ(manager.getFeatures("sixth_group_math", apl::PluginFeatureFilter::FeatureGroup).size(), 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_EQ(manager.getClasses("OtherInterface", apl::PluginClassFilter::InterfaceName).size(), 1);
+    manager.getFeatures("sixth_group_math", apl::PluginFeatureFilter::FeatureGroup);
+
+    apl::PluginUsageProfile profile = manager.getUsageProfile();
+    std::vector<std::string> paths = profile.getPlugins();
+    ASSERT_EQ(paths.size(), 2);
+    ASSERT_NE(paths[0].find("sixth_plugin"), std::string::npos);
+    ASSERT_NE(paths[1].find("seventh_plugin"), std::string::npos);
+    ASSERT_EQ(profile.getFeatures(paths[0]).size(), 4);
+    ASSERT_LT(profile.getFirstUse(paths[0]), profile.getFirstUse(paths[1]));
+    manager.setUsageRecording(false);
+    ASSERT_EQ(manager.getUsageProfile().size(), 0);
+
+    // the used plugins are loaded first, the other ones are indexed
+    apl::PluginManager other = apl::PluginManager();
+    std::vector<const apl::Plugin*> plugins = other.loadDirectory("plugins", true, profile);
+    ASSERT_EQ(plugins.size(), 2);
+    ASSERT_EQ(plugins, other.getLoadedPlugins());
+    ASSERT_NE(plugins[0]->getPath().find("sixth_plugin"), std::string::npos);
+    ASSERT_EQ(other.getIndexedPluginCount(), 5);
+    ASSERT_EQ(other.getClasses().size(), manager.getClasses().size());
+    ASSERT_EQ(other.getLoadedPluginCount(), 7);
+
+    // without a manifest file the other plugins are indexed in the background, queries wait for the index
+    apl::PluginManager third = apl::PluginManager();
+    third.loadDirectory("plugins", true, profile);
+    ASSERT_EQ(third.getClasses().size(), manager.getClasses().size());
+    ASSERT_EQ(third.getIndexedPluginCount(), 0);
+    apl::PluginManager copied = apl::PluginManager();
+    copied.loadDirectory("plugins", true, profile);
+    apl::PluginManager copy = copied;
+    ASSERT_EQ(copy.getIndexedPluginCount(), 5);
+}
+
+GTEST_TEST(Test_PluginManager, loadDirectory_budget)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    std::future<std::vector<const apl::Plugin*>> remaining;
+
+    // everything fits into the budget
+    std::vector<const apl::Plugin*> plugins = manager.loadDirectory("plugins", true, std::chrono::seconds(10), remaining,
+                                                                    apl::PluginLoadOrder::Priority, {"seventh_plugin", "plugins/third/third_plugin"});
+    ASSERT_EQ(plugins.size(), 7);
+    ASSERT_EQ(plugins[0]->getPath(), "plugins/seventh/seventh_plugin");
+    ASSERT_EQ(plugins[1]->getPath(), "plugins/third/third_plugin");
+    ASSERT_TRUE(remaining.get().empty());
+    manager.unloadAll();
+
+    // the remaining plugins are loaded in the background
+    plugins = manager.loadDirectory("plugins", true, std::chrono::milliseconds(0), remaining, apl::PluginLoadOrder::SmallestFirst);
+    std::vector<const apl::Plugin*> remainingPlugins = remaining.get();
+    plugins.insert(plugins.end(), remainingPlugins.begin(), remainingPlugins.end());
+    ASSERT_EQ(plugins.size(), 7);
+    ASSERT_EQ(manager.getLoadedPluginCount(), 7);
+    for(size_t i = 1; i < plugins.size(); i++) {
+        std::ifstream previous(plugins[i - 1]->getPath() + "." + apl::LibraryLoader::libExtension(), std::ios::binary | std::ios::ate);
+        std::ifstream current(plugins[i]->getPath() + "." + apl::LibraryLoader::libExtension(), std::ios::binary | std::ios::ate);
+        ASSERT_LE(previous.tellg(), current.tellg());
+    }
+    manager.unloadAll();
+
+    // destroying the manager waits for the background loading
+    {
+        apl::PluginManager other = apl::PluginManager();
+        other.loadDirectory("plugins", true, std::chrono::milliseconds(0), remaining);
+    }
+    ASSERT_EQ(remaining.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+}
+
+GTEST_TEST(Test_PluginManager, watchDirectory)
+{
+    auto waitFor = [](const std::function<bool()> &condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while(!condition() && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return condition();
+    };
+
+    std::string directory = makeScratchDirectory();
+    ASSERT_FALSE(directory.empty());
+    std::string pluginPath = directory + "/plugin";
+
+    apl::PluginManager manager = apl::PluginManager();
+    ASSERT_FALSE(manager.watchDirectory("not_existing_directory", false));
+    ASSERT_TRUE(manager.watchDirectory(directory, false, std::chrono::milliseconds(20)));
+    ASSERT_EQ(manager.getLoadedPluginCount(), 0);
+
+    // new libraries are loaded
+    copyLibrary("plugins/first/first_plugin", pluginPath);
+    ASSERT_TRUE(waitFor([&] { return manager.getLoadedPluginCount() == 1; }));
+    ASSERT_STREQ(manager.getLoadedPlugin(pluginPath)->getPluginInfo()->pluginName, "first_plugin");
+
+    // changed libraries are swapped
+    copyLibrary("plugins/second/second_plugin", pluginPath);
+    ASSERT_TRUE(waitFor([&] {
+        const apl::Plugin *plugin = manager.getLoadedPlugin(pluginPath);
+        return plugin != nullptr && std::string(plugin->getPluginInfo()->pluginName) == "second_plugin";
+    }));
+    ASSERT_EQ(manager.getLoadedPluginCount(), 1);
+
+    // plugins still used elsewhere are swapped once the old plugin is released
+    {
+        apl::PluginManager user = apl::PluginManager();
+        ASSERT_NE(user.load(pluginPath), nullptr);
+        copyLibrary("plugins/first/first_plugin", pluginPath);
+        ASSERT_TRUE(waitFor([&] { return manager.getLoadedPluginCount() == 0; }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ASSERT_EQ(manager.getLoadedPluginCount(), 0); // loading now would return the old plugin
+    }
+    ASSERT_TRUE(waitFor([&] {
+        const apl::Plugin *plugin = manager.getLoadedPlugin(pluginPath);
+        return plugin != nullptr && std::string(plugin->getPluginInfo()->pluginName) == "first_plugin";
+    }));
+
+    // the watcher follows moved PluginManagers
+    apl::PluginManager other = std::move(manager);
+    std::remove(libraryPath(pluginPath).c_str());
+    ASSERT_TRUE(waitFor([&] { return other.getLoadedPluginCount() == 0; }));
+
+    // unwatched directories are not followed anymore
+    other.unwatchDirectories();
+    copyLibrary("plugins/first/first_plugin", pluginPath);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(other.getLoadedPluginCount(), 0);
+    std::remove(libraryPath(pluginPath).c_str());
+    rmdir(directory.c_str());
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+}
+
+GTEST_TEST(Test_PluginManager, rejectedLibraries)
+{
+    auto isRejected = [&](const std::string &path) {
+        std::string absolutePath = apl::detail::getPluginAbsolutePath(path);
+        apl::detail::FileStamp stamp;
+        std::lock_guard<std::mutex> lockGuard(apl::detail::PluginManagerPrivate::staticMutex);
+        return apl::detail::stampFile(absolutePath, stamp) && apl::detail::PluginManagerPrivate::isRejectedLibrary(absolutePath, stamp);
+    };
+
+    std::string directory = makeScratchDirectory();
+    ASSERT_FALSE(directory.empty());
+    std::string rejectedPath = directory + "/rejected";
+    std::string fakePath = directory + "/fake";
+    copyLibrary("libraries/first/first_lib", rejectedPath);
+
+    apl::PluginManager::clearRejectedLibraries();
+    apl::PluginManager manager = apl::PluginManager();
+
+    // libraries without plugin are rejected and remembered
+    ASSERT_FALSE(apl::detail::mayContainPlugin(libraryPath(rejectedPath)));
+    ASSERT_TRUE(apl::detail::mayContainPlugin(libraryPath("plugins/first/first_plugin")));
+    ASSERT_EQ(manager.load(rejectedPath), nullptr);
+    ASSERT_EQ(apl::PluginManager::getRejectedLibraryCount(), 1);
+    ASSERT_TRUE(isRejected(rejectedPath));
+#ifdef __linux__
+    void *handle = dlopen(libraryPath(rejectedPath).c_str(), RTLD_NOW | RTLD_NOLOAD);
+    if(handle != nullptr)
+        dlclose(handle);
+    ASSERT_EQ(handle, nullptr); // never opened
+#endif
+    std::vector<const apl::Plugin*> plugins = manager.load(std::vector<std::string>({rejectedPath, "plugins/first/first_plugin"}));
+    ASSERT_EQ(plugins[0], nullptr);
+    ASSERT_NE(plugins[1], nullptr);
+    ASSERT_EQ(apl::PluginManager::getRejectedLibraryCount(), 1);
+
+    // files which aren't shared libraries at all
+    std::ofstream(libraryPath(fakePath)) << "no shared library";
+    ASSERT_EQ(manager.load(fakePath), nullptr);
+    ASSERT_EQ(apl::PluginManager::getRejectedLibraryCount(), 2);
+    ASSERT_TRUE(isRejected(fakePath));
+
+    // changed libraries are tried again
+    std::remove(libraryPath(fakePath).c_str());
+    copyLibrary("plugins/second/second_plugin", fakePath);
+    ASSERT_FALSE(isRejected(fakePath));
+    ASSERT_NE(manager.load(fakePath), nullptr);
+    ASSERT_EQ(apl::PluginManager::getRejectedLibraryCount(), 1);
+    manager.unloadAll();
+    std::remove(libraryPath(fakePath).c_str());
+    std::remove(libraryPath(rejectedPath).c_str());
+    rmdir(directory.c_str());
+
+    apl::PluginManager::clearRejectedLibraries();
+    ASSERT_EQ(apl::PluginManager::getRejectedLibraryCount(), 0);
+}
@@ -2,8 +2,12 @@
 
 #include <unordered_map>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <future>
 
 #include "APluginLibrary/pluginmanagerobserver.h"
+#include "../../src/private/pluginmanagerprivate.h"
 
 namespace
 {
@@ -108,3 +112,175 @@ GTEST_TEST(Test_PluginManagerObserver, unload_notification)
     ASSERT_EQ(observer->unloadCounter, 14);
     delete observer;
 }
+
+namespace
+{
+    class BatchObserver : public Observer
+    {
+    public:
+        void pluginsLoaded(apl::PluginManager *pluginManager, const std::vector<const apl::Plugin*> &plugins) override
+        {
+            batches.push_back(plugins);
+            Observer::pluginsLoaded(pluginManager, plugins);
+        }
+
+        std::vector<std::vector<const apl::Plugin*>> batches;
+    };
+}
+
+GTEST_TEST(Test_PluginManagerObserver, batch_load_notification)
+{
+    apl::PluginManager manager;
+    BatchObserver observer;
+    manager.addObserver(&observer);
+    const apl::Plugin* firstPlugin = manager.load("plugins/first/first_plugin");
+    ASSERT_EQ(observer.batches.size(), 0);
+    ASSERT_EQ(observer.loadCounter, 1);
+
+    // one notification with all new plugins, already loaded ones are skipped
+    auto plugins = manager.load({"plugins/first/first_plugin", "plugins/second/second_plugin", "plugins/third/third_plugin"});
+    ASSERT_EQ(plugins.front(), firstPlugin);
+    ASSERT_EQ(observer.batches, std::vector<std::vector<const apl::Plugin*>>({{plugins[1], plugins[2]}}));
+    ASSERT_EQ(observer.loadCounter, 3);
+
+    // no notification if nothing new was loaded
+    manager.load(std::vector<std::string>({"plugins/second/second_plugin", "not_existing"}));
+    ASSERT_EQ(observer.batches.size(), 1);
+    ASSERT_EQ(observer.loadCounter, 3);
+    manager.removeObserver(&observer);
+}
+
+namespace
+{
+    class RecordingObserver : public apl::PluginManagerObserver
+    {
+    public:
+        void pluginLoaded(apl::PluginManager *pluginManager, const apl::Plugin *plugin) override
+        {
+            pluginsLoaded(pluginManager, {plugin});
+        }
+        void pluginUnloaded(apl::PluginManager *pluginManager, const apl::Plugin *plugin) override
+        {
+            pluginsUnloaded(pluginManager, {plugin});
+        }
+        void pluginsLoaded(apl::PluginManager *, const std::vector<const apl::Plugin*> &plugins) override
+        {
+            record(true, plugins);
+        }
+        void pluginsUnloaded(apl::PluginManager *, const std::vector<const apl::Plugin*> &plugins) override
+        {
+            record(false, plugins);
+        }
+
+        void record(bool loaded, const std::vector<const apl::Plugin*> &plugins)
+        {
+            std::lock_guard<std::mutex> lockGuard(mutex);
+            threadIds.push_back(std::this_thread::get_id());
+            for(const apl::Plugin* plugin : plugins) {
+                ASSERT_TRUE(plugin->isLoaded()); // unloaded plugins are released after the delivery
+                events.emplace_back(loaded, plugin->getPluginInfo()->pluginName);
+            }
+            batchSizes.push_back(plugins.size());
+            if(blocked) {
+                // blocks the dispatcher thread until the test continues it
+                blocked = false;
+                entered.set_value();
+                continued.get_future().wait();
+            }
+        }
+
+        std::mutex mutex;
+        bool blocked = false;
+        std::promise<void> entered, continued;
+        std::vector<std::pair<bool, std::string>> events;
+        std::vector<size_t> batchSizes;
+        std::vector<std::thread::id> threadIds;
+    };
+}
+
+GTEST_TEST(Test_PluginManagerObserver, async_dispatch)
+{
+    apl::PluginManager manager;
+    RecordingObserver observer;
+    manager.addObserver(&observer);
+    ASSERT_FALSE(manager.isAsyncObserverDispatch());
+    manager.setAsyncObserverDispatch(true);
+    ASSERT_TRUE(manager.isAsyncObserverDispatch());
+
+    // events are delivered in order on another thread
+    observer.blocked = true;
+    manager.load("plugins/first/first_plugin");
+    observer.entered.get_future().wait();
+    manager.load("plugins/second/second_plugin");
+    manager.load("plugins/sixth/sixth_plugin");
+    manager.unload(manager.getLoadedPlugin("plugins/second/second_plugin"));
+    observer.continued.set_value();
+    manager.flushObserverEvents();
+    std::vector<std::pair<bool, std::string>> expectedEvents = {{true, "first_plugin"}, {true, "second_plugin"},
+                                                                {true, "sixth_plugin"}, {false, "second_plugin"}};
+    ASSERT_EQ(observer.events, expectedEvents);
+    for(std::thread::id id : observer.threadIds)
+        ASSERT_NE(id, std::this_thread::get_id());
+    // the loads queued while the first one was delivered are coalesced
+    ASSERT_EQ(observer.batchSizes, std::vector<size_t>({1, 2, 1}));
+
+    // unloading all plugins is delivered as one batch after the plugins were released by the manager
+    manager.unloadAll();
+    ASSERT_EQ(manager.getLoadedPluginCount(), 0);
+    manager.flushObserverEvents();
+    ASSERT_EQ(observer.batchSizes.back(), 2);
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 0);
+
+    // removing the observer delivers the pending events before
+    manager.load(std::vector<std::string>({"plugins/first/first_plugin", "plugins/second/second_plugin"}));
+    manager.removeObserver(&observer);
+    ASSERT_EQ(observer.events.size(), 8);
+    manager.unloadAll();
+    manager.flushObserverEvents();
+    ASSERT_EQ(observer.events.size(), 8);
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 0);
+
+    // synchronous again
+    manager.addObserver(&observer);
+    manager.setAsyncObserverDispatch(false);
+    manager.load("plugins/first/first_plugin");
+    ASSERT_EQ(observer.threadIds.back(), std::this_thread::get_id());
+    manager.removeObserver(&observer);
+}
+
+GTEST_TEST(Test_PluginManagerObserver, filtered_notification)
+{
+    apl::PluginManager manager;
+    Observer all, mathObserver, interfaceObserver, otherInterfaceObserver;
+    manager.addObserver(&all);
+    manager.addObserver(&mathObserver, apl::PluginQuery().wherePrefix(apl::PluginFeatureFilter::FeatureGroup, "second_group_m"));
+    manager.addObserver(&interfaceObserver, apl::PluginQuery().where(apl::PluginClassFilter::InterfaceName, "Interface"));
+    manager.addObserver(&otherInterfaceObserver, apl::PluginQuery().where(apl::PluginClassFilter::InterfaceName, "OtherInterface"));
+
+    auto plugins = manager.load(std::vector<std::string>({"plugins/first/first_plugin", "plugins/second/second_plugin",
+                                                          "plugins/third/third_plugin", "plugins/fourth/fourth_plugin"}));
+    ASSERT_EQ(all.loadCounter, 4);
+    ASSERT_EQ(mathObserver.loaded[&manager], std::vector<const apl::Plugin*>({plugins[1]}));
+    ASSERT_EQ(interfaceObserver.loadCounter, 2);
+    ASSERT_EQ(otherInterfaceObserver.loadCounter, 0);
+
+    manager.unload(plugins[0]);
+    manager.unload(plugins[2]);
+    ASSERT_EQ(all.unloadCounter, 2);
+    ASSERT_EQ(mathObserver.unloadCounter, 0);
+    ASSERT_EQ(interfaceObserver.unloaded[&manager], std::vector<const apl::Plugin*>({plugins[2]}));
+
+    // the filter of an added observer is replaced
+    manager.addObserver(&mathObserver, apl::PluginQuery().where(apl::PluginClassFilter::InterfaceName, "Interface"));
+    manager.setAsyncObserverDispatch(true);
+    manager.unloadAll();
+    manager.flushObserverEvents();
+    ASSERT_EQ(all.unloadCounter, 4);
+    ASSERT_EQ(mathObserver.unloaded[&manager], std::vector<const apl::Plugin*>({plugins[3]}));
+    ASSERT_EQ(interfaceObserver.unloadCounter, 2);
+    ASSERT_EQ(otherInterfaceObserver.unloadCounter, 0);
+    manager.removeObserver(&all);
+    manager.removeObserver(&mathObserver);
+    manager.removeObserver(&interfaceObserver);
+    manager.removeObserver(&otherInterfaceObserver);
+}
@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+# include <direct.h>
+# define mkdir(path, mode) _mkdir(path)
+#else
+# include <unistd.h>
+#endif
+
+#include "APluginLibrary/pluginmanifest.h"
+#include "APluginLibrary/pluginmanager.h"
+#include "../../src/private/pluginmanagerprivate.h"
+
+namespace
+{
+    std::string libraryPath(const std::string &path)
+    {
+        return std::string(path).append(".").append(apl::LibraryLoader::libExtension());
+    }
+    void copyFile(const std::string &source, const std::string &destination)
+    {
+        std::ifstream input(source, std::ios::binary);
+        std::ofstream output(destination, std::ios::binary | std::ios::trunc);
+        output << input.rdbuf();
+    }
+}
+
+GTEST_TEST(Test_PluginManifest, update_save_open)
+{
+    apl::PluginManifest manifest;
+    ASSERT_EQ(manifest.update("plugins", true), 7);
+    ASSERT_TRUE(apl::detail::PluginManagerPrivate::allPlugins.empty());
+    ASSERT_EQ(manifest.update("plugins", true), 0);
+    ASSERT_EQ(manifest.validate(), 0);
+    ASSERT_EQ(manifest.size(), 7);
+
+    apl::PluginQuery query;
+    query.where(apl::PluginInfoFilter::PluginName, "sixth_plugin");
+    std::vector<std::string> paths = manifest.getPaths(query);
+    ASSERT_EQ(paths.size(), 1);
+    ASSERT_TRUE(manifest.contains(paths.front()));
+    const apl::PluginInfo *info = manifest.getPluginInfo(paths.front());
+    ASSERT_NE(info, nullptr);
+    ASSERT_STREQ(info->pluginName, "sixth_plugin");
+    ASSERT_EQ(info->pluginVersionMajor, 1);
+    ASSERT_EQ(info->pluginVersionMinor, 2);
+    ASSERT_EQ(info->pluginVersionPatch, 3);
+    ASSERT_EQ(manifest.getClasses(paths.front()).size(), 3);
+    ASSERT_EQ(manifest.getClasses(paths.front()).front()->pluginInfo, info);
+
+    // the opened manifest equals the saved one
+    ASSERT_TRUE(manifest.save("plugins.manifest"));
+    apl::PluginManifest opened = apl::PluginManifest::open("plugins.manifest");
+    ASSERT_EQ(opened.getPaths(), manifest.getPaths());
+    ASSERT_EQ(opened.validate(), 0);
+    for(const std::string& path : opened.getPaths()) {
+        ASSERT_EQ(opened.getPluginInfo(path)->pluginName == nullptr, manifest.getPluginInfo(path)->pluginName == nullptr);
+        std::vector<const apl::PluginFeatureInfo*> features = opened.getFeatures(path), expected = manifest.getFeatures(path);
+        ASSERT_EQ(features.size(), expected.size());
+        ASSERT_EQ(opened.getFeatures(path), features); // created from the mapped records once
+        for(size_t i = 0; i < features.size(); i++) {
+            ASSERT_STREQ(features[i]->featureGroup, expected[i]->featureGroup);
+            ASSERT_STREQ(features[i]->featureName, expected[i]->featureName);
+            ASSERT_STREQ(features[i]->returnType, expected[i]->returnType);
+            ASSERT_STREQ(features[i]->parameterList, expected[i]->parameterList);
+            ASSERT_EQ(features[i]->functionPointer, nullptr);
+        }
+        ASSERT_EQ(opened.getClasses(path).size(), manifest.getClasses(path).size());
+    }
+    ASSERT_EQ(apl::PluginManifest::open("nonexistent.manifest").size(), 0);
+
+    // only the matching plugins are loaded
+    query = apl::PluginQuery();
+    query.whereGlob(apl::PluginFeatureFilter::FeatureGroup, "s*_group_pow");
+    apl::PluginManager manager;
+    ASSERT_EQ(manager.load(opened, query).size(), 2);
+    ASSERT_EQ(apl::detail::PluginManagerPrivate::allPlugins.size(), 2);
+    ASSERT_EQ(manager.getFeatures("feature_pow2", apl::PluginFeatureFilter::FeatureName).size(), 2);
+    manager.unloadAll();
+    std::remove("plugins.manifest");
+}
+
+GTEST_TEST(Test_PluginManifest, changed_files)
+{
+    mkdir("manifest_plugins", 0755);
+    copyFile(libraryPath("plugins/first/first_plugin"), libraryPath("manifest_plugins/copied_plugin"));
+
+    apl::PluginManifest manifest;
+    ASSERT_EQ(manifest.update("manifest_plugins", false), 1);
+    std::string path = manifest.getPaths().front();
+    ASSERT_STREQ(manifest.getPluginInfo(path)->pluginName, "first_plugin");
+
+    // changed files are indexed again
+    copyFile(libraryPath("plugins/second/second_plugin"), libraryPath("manifest_plugins/copied_plugin"));
+    ASSERT_EQ(manifest.validate(), 1);
+    ASSERT_EQ(manifest.size(), 0);
+    ASSERT_EQ(manifest.update("manifest_plugins", false), 1);
+    ASSERT_STREQ(manifest.getPluginInfo(path)->pluginName, "second_plugin");
+
+    // removed files are removed
+    std::remove(libraryPath("manifest_plugins/copied_plugin").c_str());
+    ASSERT_EQ(manifest.update("manifest_plugins", false), 0);
+    ASSERT_EQ(manifest.size(), 0);
+    rmdir("manifest_plugins");
+}
@@ -0,0 +1,187 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <algorithm>
+
+#include "APluginLibrary/pluginmanager.h"
+#include "APluginLibrary/pluginquery.h"
+#include "../../src/private/pluginqueryprivate.h"
+
+namespace
+{
+    std::vector<std::string> featureNames(const std::vector<const apl::PluginFeatureInfo*> &features)
+    {
+        std::vector<std::string> names;
+        for(auto feature : features)
+            names.push_back(std::string(feature->featureGroup).append("::").append(feature->featureName));
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+}
+
+GTEST_TEST(Test_PluginQuery, version_comparison)
+{
+    ASSERT_EQ(apl::PluginVersion(1, 2, 3), apl::PluginVersion(1, 2, 3));
+    ASSERT_NE(apl::PluginVersion(1, 2, 3), apl::PluginVersion(1, 2, 4));
+    ASSERT_LT(apl::PluginVersion(1, 2, 3), apl::PluginVersion(1, 3, 0));
+    ASSERT_LT(apl::PluginVersion(1, 9, 9), apl::PluginVersion(2, 0, 0));
+    ASSERT_GT(apl::PluginVersion(3, 5, 12), apl::PluginVersion(3, 5, 11));
+    ASSERT_LE(apl::PluginVersion(), apl::PluginVersion(0, 0, 0));
+    ASSERT_GE(apl::PluginVersion(0, 0, 1), apl::PluginVersion());
+}
+
+GTEST_TEST(Test_PluginQuery, prepare)
+{
+    apl::PluginQuery query;
+    ASSERT_FALSE(query.isPrepared());
+    ASSERT_TRUE(query.prepare().isPrepared());
+    ASSERT_TRUE(query.isSatisfiable());
+
+    query.where(apl::PluginFeatureFilter::FeatureName, "feature_add");
+    ASSERT_FALSE(query.isPrepared());
+    query.wherePrefix(apl::PluginFeatureFilter::FeatureName, "feature_");
+    ASSERT_TRUE(query.prepare().isSatisfiable());
+    query.wherePrefix(apl::PluginFeatureFilter::FeatureName, "other_");
+    ASSERT_FALSE(query.prepare().isSatisfiable());
+
+    apl::PluginQuery query2;
+    query2.where(apl::PluginFeatureFilter::FeatureName, "a").where(apl::PluginFeatureFilter::FeatureName, "b");
+    ASSERT_FALSE(query2.prepare().isSatisfiable());
+
+    apl::PluginQuery query3;
+    query3.whereVersion(apl::PluginInfoFilter::PluginVersion, apl::PluginVersion(2, 0, 0))
+          .whereVersion(apl::PluginInfoFilter::PluginVersion, apl::PluginVersion(0, 0, 0), apl::PluginVersion(1, 0, 0));
+    ASSERT_FALSE(query3.prepare().isSatisfiable());
+
+    ASSERT_THROW(apl::PluginQuery().whereVersion(apl::PluginInfoFilter::PluginName, apl::PluginVersion()), std::runtime_error);
+}
+
+GTEST_TEST(Test_PluginQuery, glob)
+{
+    ASSERT_TRUE(apl::detail::matchesGlob("feature_add", "feature_*"));
+    ASSERT_TRUE(apl::detail::matchesGlob("feature_add", "*_add"));
+    ASSERT_TRUE(apl::detail::matchesGlob("feature_add", "f?ature*d"));
+    ASSERT_TRUE(apl::detail::matchesGlob("feature_add", "**"));
+    ASSERT_TRUE(apl::detail::matchesGlob("", "*"));
+    ASSERT_FALSE(apl::detail::matchesGlob("feature_add", "feature_"));
+    ASSERT_FALSE(apl::detail::matchesGlob("feature_add", "*_sub"));
+    ASSERT_FALSE(apl::detail::matchesGlob("feature", "feature?"));
+    ASSERT_EQ(apl::detail::globPrefix("feature_*_x"), "feature_");
+    ASSERT_EQ(apl::detail::globPrefix("?x"), "");
+
+    apl::PluginQuery query;
+    query.where(apl::PluginFeatureFilter::FeatureName, "feature_add").whereGlob(apl::PluginFeatureFilter::FeatureName, "*_add");
+    ASSERT_TRUE(query.prepare().isSatisfiable());
+    query.whereGlob(apl::PluginFeatureFilter::FeatureName, "*_sub");
+    ASSERT_FALSE(query.prepare().isSatisfiable());
+}
+
+GTEST_TEST(Test_PluginQuery, getFeatures)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    for(const char* path : {"plugins/first/first_plugin", "plugins/second/second_plugin", "plugins/fifth/fifth_plugin", "plugins/sixth/sixth_plugin"})
+        ASSERT_NE(manager.load(path), nullptr);
+
+    // single criterion equals the string filter api
+    apl::PluginQuery query;
+    query.where(apl::PluginFeatureFilter::FeatureGroup, "sixth_group_math").prepare();
+    ASSERT_EQ(featureNames(manager.getFeatures(query)), featureNames(manager.getFeatures("sixth_group_math", apl::PluginFeatureFilter::FeatureGroup)));
+
+    // prefix and equality
+    query = apl::PluginQuery();
+    query.wherePrefix(apl::PluginFeatureFilter::FeatureGroup, "s").where(apl::PluginFeatureFilter::FeatureName, "feature_add").prepare();
+    ASSERT_EQ(featureNames(manager.getFeatures(query)), std::vector<std::string>({"second_group_math::feature_add", "sixth_group_math::feature_add"}));
+
+    // plugin version range
+    query.whereVersion(apl::PluginInfoFilter::PluginVersion, apl::PluginVersion(2, 0, 0)).prepare();
+    ASSERT_EQ(featureNames(manager.getFeatures(query)), std::vector<std::string>({"second_group_math::feature_add"}));
+    query = apl::PluginQuery();
+    query.whereVersion(apl::PluginInfoFilter::PluginVersion, apl::PluginVersion(1, 0, 0), apl::PluginVersion(9, 0, 0))
+         .where(apl::PluginFeatureFilter::ParameterList, "int x");
+    ASSERT_EQ(featureNames(manager.getFeatures(query)), std::vector<std::string>({"second_group_pow::feature_pow2", "second_group_pow::feature_pow3",
+                                                                                  "sixth_group_pow::feature_pow2", "sixth_group_pow::feature_pow3"}));
+
+    // plugin name
+    query = apl::PluginQuery();
+    query.where(apl::PluginInfoFilter::PluginName, "first_plugin").where(apl::PluginFeatureFilter::ReturnType, "int");
+    ASSERT_EQ(featureNames(manager.getFeatures(query)), std::vector<std::string>({"first_group1::feature1"}));
+
+    // class criteria restrict the features to plugins providing a matching class
+    query = apl::PluginQuery();
+    query.where(apl::PluginClassFilter::InterfaceName, "Interface").where(apl::PluginFeatureFilter::FeatureName, "feature1");
+    ASSERT_EQ(featureNames(manager.getFeatures(query)), std::vector<std::string>({"fifth_group1::feature1"}));
+
+    // glob
+    query = apl::PluginQuery();
+    query.whereGlob(apl::PluginFeatureFilter::FeatureGroup, "s*_group_pow").whereGlob(apl::PluginFeatureFilter::FeatureName, "feature_pow?");
+    ASSERT_EQ(featureNames(manager.getFeatures(query)), std::vector<std::string>({"second_group_pow::feature_pow2", "second_group_pow::feature_pow3",
+                                                                                  "sixth_group_pow::feature_pow2", "sixth_group_pow::feature_pow3"}));
+
+    // no criteria returns all features
+    ASSERT_EQ(featureNames(manager.getFeatures(apl::PluginQuery())), featureNames(manager.getFeatures()));
+
+    // the ids resolve to the same features
+    query = apl::PluginQuery();
+    query.wherePrefix(apl::PluginFeatureFilter::FeatureName, "feature_").prepare();
+    std::vector<apl::FeatureId> ids = manager.getFeatureIds(query);
+    std::vector<const apl::PluginFeatureInfo*> features = manager.getFeatures(query);
+    ASSERT_EQ(ids.size(), 12);
+    ASSERT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+    for(size_t i = 0; i < ids.size(); i++)
+        ASSERT_EQ(manager.feature(ids[i]), features[i]);
+
+    // unsatisfiable queries return nothing
+    query.wherePrefix(apl::PluginFeatureFilter::FeatureName, "other_");
+    ASSERT_TRUE(manager.getFeatures(query).empty());
+
+    // prepared queries can be executed again after the plugins changed
+    query = apl::PluginQuery();
+    query.where(apl::PluginFeatureFilter::FeatureName, "feature_add").prepare();
+    ASSERT_EQ(manager.getFeatures(query).size(), 2);
+    manager.unload(manager.getLoadedPlugin("plugins/second/second_plugin"));
+    ASSERT_EQ(featureNames(manager.getFeatures(query)), std::vector<std::string>({"sixth_group_math::feature_add"}));
+    manager.unloadAll();
+    ASSERT_TRUE(manager.getFeatures(query).empty());
+}
+
+GTEST_TEST(Test_PluginQuery, getClasses_getPluginInfos)
+{
+    apl::PluginManager manager = apl::PluginManager();
+    for(const char* path : {"plugins/second/second_plugin", "plugins/fifth/fifth_plugin", "plugins/sixth/sixth_plugin", "plugins/seventh/seventh_plugin"})
+        ASSERT_NE(manager.load(path), nullptr);
+
+    apl::PluginQuery query;
+    query.where(apl::PluginClassFilter::InterfaceName, "Interface").wherePrefix(apl::PluginClassFilter::ClassName, "Implementation");
+    ASSERT_EQ(manager.getClasses(query).size(), 4);
+    ASSERT_EQ(manager.getClassIds(query).size(), 4);
+
+    // feature criteria restrict the classes to plugins providing a matching feature
+    query.where(apl::PluginFeatureFilter::FeatureGroup, "fifth_group1");
+    std::vector<const apl::PluginClassInfo*> classes = manager.getClasses(query);
+    ASSERT_EQ(classes.size(), 1);
+    ASSERT_STREQ(classes.front()->className, "Implementation");
+
+    query = apl::PluginQuery();
+    query.where(apl::PluginClassFilter::InterfaceName, "OtherInterface");
+    classes = manager.getClasses(query);
+    ASSERT_EQ(classes.size(), 1);
+    ASSERT_STREQ(classes.front()->className, "Implementation1");
+
+    // plugins
+    query = apl::PluginQuery();
+    query.wherePrefix(apl::PluginFeatureFilter::FeatureGroup, "second_");
+    std::vector<const apl::PluginInfo*> infos = manager.getPluginInfos(query);
+    ASSERT_EQ(infos.size(), 1);
+    ASSERT_STREQ(infos.front()->pluginName, "second_plugin");
+
+    query = apl::PluginQuery();
+    query.where(apl::PluginClassFilter::InterfaceName, "Interface").whereVersion(apl::PluginInfoFilter::PluginVersion, apl::PluginVersion(1, 2, 3), apl::PluginVersion(1, 2, 3));
+    infos = manager.getPluginInfos(query);
+    ASSERT_EQ(infos.size(), 1);
+    ASSERT_STREQ(infos.front()->pluginName, "sixth_plugin");
+
+    query = apl::PluginQuery();
+    query.wherePrefix(apl::PluginInfoFilter::PluginName, "s");
+    ASSERT_EQ(manager.getPluginInfos(query).size(), 2);
+    ASSERT_EQ(manager.getPluginInfos(apl::PluginQuery()).size(), 4);
+}
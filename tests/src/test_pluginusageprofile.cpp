@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <cstdio>
+
+#include "APluginLibrary/pluginusageprofile.h"
+
+GTEST_TEST(Test_PluginUsageProfile, record_merge)
+{
+    apl::PluginUsageProfile profile;
+    profile.record("/plugins/b", "group::feature2", std::chrono::milliseconds(20));
+    profile.record("/plugins/a", std::chrono::milliseconds(30));
+    profile.record("/plugins/b", "group::feature1", std::chrono::milliseconds(10));
+    profile.record("/plugins/b", "group::feature2", std::chrono::milliseconds(40));
+    ASSERT_EQ(profile.size(), 2);
+    ASSERT_TRUE(profile.contains("/plugins/a"));
+    ASSERT_FALSE(profile.contains("/plugins/c"));
+    ASSERT_EQ(profile.getFirstUse("/plugins/b"), std::chrono::milliseconds(10));
+    ASSERT_EQ(profile.getFirstUse("/plugins/c"), std::chrono::milliseconds(-1));
+    ASSERT_EQ(profile.getPlugins(), std::vector<std::string>({"/plugins/b", "/plugins/a"}));
+    ASSERT_EQ(profile.getFeatures("/plugins/b"), std::vector<std::string>({"group::feature1", "group::feature2"}));
+    ASSERT_TRUE(profile.getFeatures("/plugins/a").empty());
+
+    // the earliest uses are kept
+    apl::PluginUsageProfile other;
+    other.record("/plugins/a", std::chrono::milliseconds(5));
+    other.record("/plugins/c", "group::feature3", std::chrono::milliseconds(50));
+    profile.merge(other);
+    ASSERT_EQ(profile.getPlugins(), std::vector<std::string>({"/plugins/a", "/plugins/b", "/plugins/c"}));
+    profile.clear();
+    ASSERT_EQ(profile.size(), 0);
+}
+
+GTEST_TEST(Test_PluginUsageProfile, save_open)
+{
+    apl::PluginUsageProfile profile;
+    profile.record("/plugins/a b", "group::feature(int x)", std::chrono::milliseconds(7));
+    profile.record("/plugins/c", std::chrono::milliseconds(3));
+    ASSERT_TRUE(profile.save("usage.profile"));
+
+    apl::PluginUsageProfile opened = apl::PluginUsageProfile::open("usage.profile");
+    ASSERT_EQ(opened.getPlugins(), profile.getPlugins());
+    ASSERT_EQ(opened.getFeatures("/plugins/a b"), std::vector<std::string>({"group::feature(int x)"}));
+    ASSERT_EQ(opened.getFirstUse("/plugins/a b"), std::chrono::milliseconds(7));
+    ASSERT_EQ(apl::PluginUsageProfile::open("nonexistent.profile").size(), 0);
+    std::remove("usage.profile");
+}